@@ -0,0 +1,124 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/actionTimeline.h"
+#include <algorithm>
+#include <cassert>
+
+namespace giada::m
+{
+ActionTimeline::Span ActionTimeline::Entry::getActions(ID channelId) const
+{
+	const Bucket* b = std::lower_bound(firstBucket, lastBucket, channelId,
+	    [](const Bucket& bucket, ID id) { return bucket.channelId < id; });
+
+	if (b == lastBucket || b->channelId != channelId)
+		return {};
+	return b->actions;
+}
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void ActionTimeline::build(const recorder::ActionMap& map)
+{
+	std::size_t count = 0;
+	for (const auto& [frame, actions] : map)
+		count += actions.size();
+
+	m_entries.clear();
+	m_buckets.clear();
+	m_actions.clear();
+
+	/* Reserve everything up front: entries and buckets hold pointers to the 
+	other two vectors, which must not reallocate while being filled. */
+
+	m_entries.reserve(map.size());
+	m_buckets.reserve(count);
+	m_actions.reserve(count);
+
+	/* std::map is already sorted by key (i.e. by frame), and its nodes never
+	move around: pointers to the action vectors stay valid until the next 
+	change in the map, which triggers a rebuild anyway. */
+
+	for (const auto& [frame, actions] : map)
+	{
+		const std::size_t offset = m_actions.size();
+		m_actions.insert(m_actions.end(), actions.begin(), actions.end());
+
+		const auto first = m_actions.begin() + offset;
+
+		/* Stable sort: actions of the same channel keep their recording order. */
+
+		std::stable_sort(first, m_actions.end(),
+		    [](const Action& a, const Action& b) { return a.channelId < b.channelId; });
+
+		const Bucket* firstBucket = m_buckets.data() + m_buckets.size();
+		for (auto it = first; it != m_actions.end();)
+		{
+			auto last = std::find_if(it, m_actions.end(),
+			    [id = it->channelId](const Action& a) { return a.channelId != id; });
+			m_buckets.push_back({it->channelId, {&*it, &*it + (last - it)}});
+			it = last;
+		}
+
+		m_entries.push_back({frame, &actions, firstBucket, m_buckets.data() + m_buckets.size()});
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::size_t ActionTimeline::find(Frame f, std::size_t hint) const
+{
+	const std::size_t size = m_entries.size();
+
+	if (hint <= size &&
+	    (hint == size || m_entries[hint].frame >= f) &&
+	    (hint == 0 || m_entries[hint - 1].frame < f))
+		return hint;
+
+	auto it = std::lower_bound(m_entries.begin(), m_entries.end(), f,
+	    [](const Entry& e, Frame f) { return e.frame < f; });
+
+	return std::distance(m_entries.begin(), it);
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::size_t ActionTimeline::size() const
+{
+	return m_entries.size();
+}
+
+/* -------------------------------------------------------------------------- */
+
+const ActionTimeline::Entry& ActionTimeline::operator[](std::size_t i) const
+{
+	assert(i < m_entries.size());
+	return m_entries[i];
+}
+} // namespace giada::m
@@ -0,0 +1,112 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_ACTION_TIMELINE_H
+#define G_ACTION_TIMELINE_H
+
+#include "core/action.h"
+#include "core/recorder.h"
+#include "core/types.h"
+#include <vector>
+
+namespace giada::m
+{
+/* ActionTimeline
+A flat, frame-sorted index of the ActionMap, made for the realtime thread. Each
+entry points to the vector of actions recorded on a specific frame. Lookups are
+performed with a cursor that moves forward as frames go by, so that scanning a
+block costs O(1) per action instead of a tree search per frame. Actions on each
+frame are also bucketed by channel: a channel picks its own ones with a binary 
+search, rather than filtering out those of every other channel. The timeline 
+must be rebuilt (non-realtime) whenever the ActionMap changes. */
+
+class ActionTimeline
+{
+public:
+	/* Span
+	A contiguous range of actions, owned by the timeline. */
+
+	struct Span
+	{
+		const Action* begin() const { return first; }
+		const Action* end() const { return last; }
+		bool          empty() const { return first == last; }
+		std::size_t   size() const { return last - first; }
+
+		const Action* first = nullptr;
+		const Action* last  = nullptr;
+	};
+
+	struct Bucket
+	{
+		ID   channelId;
+		Span actions;
+	};
+
+	struct Entry
+	{
+		/* getActions
+		Returns actions recorded on this frame for channel 'channelId'. */
+
+		Span getActions(ID channelId) const;
+
+		Frame                      frame;
+		const std::vector<Action>* actions;     // All channels
+		const Bucket*              firstBucket; // Sorted by channel ID
+		const Bucket*              lastBucket;
+	};
+
+	ActionTimeline() = default;
+
+	/* Entries point to the timeline's own storage: copies would share it. */
+
+	ActionTimeline(const ActionTimeline&) = delete;
+	ActionTimeline& operator=(const ActionTimeline&) = delete;
+
+	/* build
+	Rebuilds the timeline from the ActionMap 'map'. It allocates memory: never
+	call this from the realtime thread. */
+
+	void build(const recorder::ActionMap& map);
+
+	/* find
+	Returns the index of the first entry with frame >= 'f', or size() if there
+	are no such entries. 'hint' is an index returned by a previous call: if it's
+	still valid the lookup is O(1), otherwise it falls back to a binary search. */
+
+	std::size_t find(Frame f, std::size_t hint = 0) const;
+
+	std::size_t  size() const;
+	const Entry& operator[](std::size_t i) const;
+
+private:
+	std::vector<Entry>  m_entries;
+	std::vector<Bucket> m_buckets;
+	std::vector<Action> m_actions; // Grouped by frame, then by channel
+};
+} // namespace giada::m
+
+#endif
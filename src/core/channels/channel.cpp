@@ -25,25 +25,27 @@
  * -------------------------------------------------------------------------- */
 
 #include "channel.h"
+#include "core/dsp.h"
 #include "core/mixerHandler.h"
 #include "core/plugins/pluginHost.h"
 #include "core/plugins/pluginManager.h"
+#include <algorithm>
 #include <cassert>
 
 namespace giada::m::channel
 {
 namespace
 {
-mcl::AudioBuffer::Pan calcPanning_(float pan)
-{
-	/* TODO - precompute the AudioBuffer::Pan when pan value changes instead of
-	building it on the fly. */
+/* calcGains_
+Returns left and right gains for volume 'volume' and panning 'pan'. */
 
+mcl::AudioBuffer::Pan calcGains_(float volume, float pan)
+{
 	/* Center pan (0.5f)? Pass-through. */
 
 	if (pan == 0.5f)
-		return {1.0f, 1.0f};
-	return {1.0f - pan, pan};
+		return {volume, volume};
+	return {volume * (1.0f - pan), volume * pan};
 }
 
 /* -------------------------------------------------------------------------- */
@@ -54,10 +56,12 @@ void react_(Data& d, const eventDispatcher::Event& e)
 	{
 	case eventDispatcher::EventType::CHANNEL_VOLUME:
 		d.volume = std::get<float>(e.data);
+		d.state->volume.setTarget(d.volume);
 		break;
 
 	case eventDispatcher::EventType::CHANNEL_PAN:
 		d.pan = std::get<float>(e.data);
+		d.state->pan.setTarget(d.pan);
 		break;
 
 	case eventDispatcher::EventType::CHANNEL_MUTE:
@@ -80,6 +84,27 @@ void react_(Data& d, const eventDispatcher::Event& e)
 
 /* -------------------------------------------------------------------------- */
 
+/* advanceActions_
+Hands recorded actions of this channel over to the components that play them.
+Channels with no actions on the current frame get an empty span and leave 
+early. */
+
+void advanceActions_(const Data& d, ActionTimeline::Span actions, Frame localFrame)
+{
+	if (actions.empty())
+		return;
+	if (d.samplePlayer)
+		samplePlayer::advanceActions(d, actions, localFrame);
+	if (d.midiSender)
+		midiSender::advanceActions(d, actions, localFrame);
+#ifdef WITH_VST
+	if (d.midiReceiver)
+		midiReceiver::advanceActions(d, actions, localFrame);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
 void renderMasterOut_(const Data& d, mcl::AudioBuffer& out)
 {
 	d.buffer->audio.set(out, /*gain=*/1.0f);
@@ -87,7 +112,11 @@ void renderMasterOut_(const Data& d, mcl::AudioBuffer& out)
 	if (d.plugins.size() > 0)
 		pluginHost::processStack(d.buffer->audio, d.plugins, nullptr);
 #endif
-	out.set(d.buffer->audio, d.volume);
+	const Ramp::Block volume = d.state->volume.advance(out.countFrames());
+
+	out.clear();
+	dsp::sumRamp(out, d.buffer->audio, volume.frames, {volume.start, volume.start},
+	    {volume.end, volume.end});
 }
 
 /* -------------------------------------------------------------------------- */
@@ -104,26 +133,8 @@ void renderMasterIn_(const Data& d, mcl::AudioBuffer& in)
 
 void renderChannel_(const Data& d, mcl::AudioBuffer& out, mcl::AudioBuffer& in, bool audible)
 {
-	d.buffer->audio.clear();
-
-	if (d.samplePlayer)
-		samplePlayer::render(d);
-	if (d.audioReceiver)
-		audioReceiver::render(d, in);
-
-		/* If MidiReceiver exists, let it process the plug-in stack, as it can 
-	contain plug-ins that take MIDI events (i.e. synths). Otherwise process the
-	plug-in stack internally with no MIDI events. */
-
-#ifdef WITH_VST
-	if (d.midiReceiver)
-		midiReceiver::render(d);
-	else if (d.plugins.size() > 0)
-		pluginHost::processStack(d.buffer->audio, d.plugins, nullptr);
-#endif
-
-	if (audible)
-		out.sum(d.buffer->audio, d.volume * d.volume_i, calcPanning_(d.pan));
+	renderBuffer(d, in);
+	mixBuffer(d, out, audible);
 }
 } // namespace
 
@@ -134,6 +145,9 @@ void renderChannel_(const Data& d, mcl::AudioBuffer& out, mcl::AudioBuffer& in,
 Buffer::Buffer(Frame bufferSize)
 : audio(bufferSize, G_MAX_IO_CHANS)
 {
+#ifdef WITH_VST
+	midi.ensureSize(G_MAX_MIDI_BUFFER_BYTES);
+#endif
 }
 
 /* -------------------------------------------------------------------------- */
@@ -207,6 +221,9 @@ Data::Data(const patch::Channel& p, State& state, Buffer& buffer, float samplera
 {
 	state.readActions.store(p.readActions);
 	state.recStatus.store(p.readActions ? ChannelStatus::PLAY : ChannelStatus::OFF);
+	state.volume.jump(p.volume);
+	state.pan.jump(p.pan);
+	state.pitch.jump(p.pitch);
 
 	switch (type)
 	{
@@ -296,17 +313,28 @@ void advance(const Data& d, const sequencer::EventBuffer& events)
 {
 	for (const sequencer::Event& e : events)
 	{
+		if (e.type == sequencer::EventType::ACTIONS)
+		{
+			advanceActions_(d, e.entry->getActions(d.id), e.delta);
+			continue;
+		}
 		if (d.midiController)
 			midiController::advance(d, e);
 		if (d.samplePlayer)
 			samplePlayer::advance(d, e);
-		if (d.midiSender)
-			midiSender::advance(d, e);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void advanceLive(const Data& d, const MidiEvent& e, Frame localFrame)
+{
+	if (d.samplePlayer)
+		samplePlayer::advanceLive(d, e, localFrame);
 #ifdef WITH_VST
-		if (d.midiReceiver)
-			midiReceiver::advance(d, e);
+	if (d.midiReceiver)
+		midiReceiver::advanceLive(d, e, localFrame);
 #endif
-	}
 }
 
 /* -------------------------------------------------------------------------- */
@@ -342,6 +370,50 @@ void react(Data& d, const eventDispatcher::EventBuffer& events, bool audible)
 
 /* -------------------------------------------------------------------------- */
 
+bool reactRamps(const Data& d, const eventDispatcher::EventBuffer& events)
+{
+	bool found = false;
+	for (const eventDispatcher::Event& e : events)
+	{
+		if (e.channelId > 0 && e.channelId != d.id)
+			continue;
+
+		switch (e.type)
+		{
+		case eventDispatcher::EventType::CHANNEL_VOLUME:
+			d.state->volume.setTarget(std::get<float>(e.data));
+			found = true;
+			break;
+
+		case eventDispatcher::EventType::CHANNEL_PAN:
+			d.state->pan.setTarget(std::get<float>(e.data));
+			found = true;
+			break;
+
+		case eventDispatcher::EventType::CHANNEL_PITCH:
+			d.state->pitch.setTarget(std::get<float>(e.data));
+			found = true;
+			break;
+
+		default:
+			break;
+		}
+	}
+	return found;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void syncRamps(Data& d)
+{
+	d.volume = d.state->volume.getTarget();
+	d.pan    = d.state->pan.getTarget();
+	if (d.samplePlayer)
+		d.samplePlayer->pitch = d.state->pitch.getTarget();
+}
+
+/* -------------------------------------------------------------------------- */
+
 void render(const Data& d, mcl::AudioBuffer* out, mcl::AudioBuffer* in, bool audible)
 {
 	if (d.id == mixer::MASTER_OUT_CHANNEL_ID)
@@ -351,4 +423,45 @@ void render(const Data& d, mcl::AudioBuffer* out, mcl::AudioBuffer* in, bool aud
 	else
 		renderChannel_(d, *out, *in, audible);
 }
+
+/* -------------------------------------------------------------------------- */
+
+void renderBuffer(const Data& d, const mcl::AudioBuffer& in)
+{
+	d.buffer->audio.clear();
+
+	if (d.samplePlayer)
+		samplePlayer::render(d);
+	if (d.audioReceiver)
+		audioReceiver::render(d, in);
+
+		/* If MidiReceiver exists, let it process the plug-in stack, as it can 
+	contain plug-ins that take MIDI events (i.e. synths). Otherwise process the
+	plug-in stack internally with no MIDI events. */
+
+#ifdef WITH_VST
+	if (d.midiReceiver)
+		midiReceiver::render(d);
+	else if (d.plugins.size() > 0)
+		pluginHost::processStack(d.buffer->audio, d.plugins, nullptr);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+void mixBuffer(const Data& d, mcl::AudioBuffer& out, bool audible)
+{
+	/* Ramps move on even if the channel can't be heard, so that it comes back
+	with up-to-date values. */
+
+	const Ramp::Block volume = d.state->volume.advance(out.countFrames());
+	const Ramp::Block pan    = d.state->pan.advance(out.countFrames());
+
+	if (!audible)
+		return;
+
+	dsp::sumRamp(out, d.buffer->audio, std::max(volume.frames, pan.frames),
+	    calcGains_(volume.start * d.volume_i, pan.start),
+	    calcGains_(volume.end * d.volume_i, pan.end));
+}
 } // namespace giada::m::channel
\ No newline at end of file
@@ -44,6 +44,7 @@
 #include "core/midiEvent.h"
 #include "core/mixer.h"
 #include "core/queue.h"
+#include "core/ramp.h"
 #include "core/resampler.h"
 #include "core/sequencer.h"
 #include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
@@ -66,10 +67,19 @@ struct State
 	bool                      rewinding   = false;
 	Frame                     offset      = 0;
 
+	/* Volume, pan and pitch as heard by the audio thread, gliding towards the
+	values set by events. The ones in Data follow them with some delay and are
+	meant for the UI and for saving. */
+
+	Ramp volume = G_DEFAULT_VOL;
+	Ramp pan    = G_DEFAULT_PAN;
+	Ramp pitch  = G_DEFAULT_PITCH;
+
 	/* Optional resampler for sample-based channels. Unfortunately a Resampler
-	object (based on libsamplerate) doesn't like to get copied while rendering
+	object based on libsamplerate doesn't like to get copied while rendering
 	audio, so can't live inside WaveReader object (which is copied on model 
-	changes by the Swapper mechanism). Let's put it in the shared state here. */
+	changes by the Swapper mechanism). Let's put it in the shared state here. 
+	Built-in qualities don't suffer from this, but share the same home. */
 
 	std::optional<Resampler> resampler = {};
 };
@@ -144,16 +154,43 @@ actions or sequencer events) in the current block. */
 
 void advance(const Data& d, const sequencer::EventBuffer& e);
 
+/* advanceLive
+Advances internal state by processing a live event (key press, MIDI note) at 
+frame 'localFrame' in the current block. Called by the Mixer. */
+
+void advanceLive(const Data& d, const MidiEvent& e, Frame localFrame);
+
 /* react
 Reacts to live events coming from the EventDispatcher (human events) and
 updates itself accordingly. */
 
 void react(Data& d, const eventDispatcher::EventBuffer& e, bool audible);
 
+/* reactRamps
+Sets new targets for volume, pan and pitch from live events. Only the shared
+State is touched, so the channel doesn't need to be copied and swapped. Returns 
+true if any such event was found. */
+
+bool reactRamps(const Data& d, const eventDispatcher::EventBuffer& e);
+
+/* syncRamps
+Copies current targets of volume, pan and pitch back into 'd'. */
+
+void syncRamps(Data& d);
+
 /* render
 Renders audio data to I/O buffers. */
 
 void render(const Data& d, mcl::AudioBuffer* out, mcl::AudioBuffer* in, bool audible);
+
+/* renderBuffer, mixBuffer
+The two halves of render() for ordinary channels. renderBuffer() fills the 
+channel's own buffer and doesn't touch anything shared, so different channels
+can go through it in parallel. mixBuffer() sums the result into 'out': call it
+from one thread, in channel order, to get the same mix every time. */
+
+void renderBuffer(const Data& d, const mcl::AudioBuffer& in);
+void mixBuffer(const Data& d, mcl::AudioBuffer& out, bool audible);
 } // namespace giada::m::channel
 
 #endif
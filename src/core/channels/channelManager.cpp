@@ -104,6 +104,11 @@ channel::Data create(const channel::Data& o)
 	out.state  = &makeState_(o.type);
 	out.buffer = &makeBuffer_();
 
+	out.state->volume.jump(o.volume);
+	out.state->pan.jump(o.pan);
+	if (o.samplePlayer)
+		out.state->pitch.jump(o.samplePlayer->pitch);
+
 	return out;
 }
 
@@ -43,15 +43,21 @@ void sendToPlugins_(const channel::Data& ch, const MidiEvent& e, Frame localFram
 
 /* -------------------------------------------------------------------------- */
 
-void parseMidi_(const channel::Data& ch, const MidiEvent& e)
+void parseMidi_(const channel::Data& ch, const MidiEvent& e, Timestamp t)
 {
 	/* Now all messages are turned into Channel-0 messages. Giada doesn't care 
 	about holding MIDI channel information. Moreover, having all internal 
-	messages on channel 0 is way easier. Then send it to plug-ins. */
+	messages on channel 0 is way easier. */
 
 	MidiEvent flat(e);
 	flat.setChannel(0);
-	sendToPlugins_(ch, flat, /*delta=*/0);
+
+	/* Then hand it over to the Mixer, which will send it to plug-ins at the 
+	right frame (see advanceLive() below). Send it right away, at the 
+	beginning of the next block, if the live queue is full. */
+
+	if (!mixer::liveEvents.push({ch.id, flat, t}))
+		sendToPlugins_(ch, flat, /*delta=*/0);
 }
 } // namespace
 
@@ -64,7 +70,7 @@ void react(const channel::Data& ch, const eventDispatcher::Event& e)
 	switch (e.type)
 	{
 	case eventDispatcher::EventType::MIDI:
-		parseMidi_(ch, std::get<Action>(e.data).event);
+		parseMidi_(ch, std::get<Action>(e.data).event, e.timestamp);
 		break;
 
 	case eventDispatcher::EventType::KEY_KILL:
@@ -80,12 +86,19 @@ void react(const channel::Data& ch, const eventDispatcher::Event& e)
 
 /* -------------------------------------------------------------------------- */
 
-void advance(const channel::Data& ch, const sequencer::Event& e)
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame)
+{
+	if (!ch.isPlaying())
+		return;
+	for (const Action& a : actions)
+		sendToPlugins_(ch, a.event, localFrame);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void advanceLive(const channel::Data& ch, const MidiEvent& e, Frame localFrame)
 {
-	if (e.type == sequencer::EventType::ACTIONS && ch.isPlaying())
-		for (const Action& action : *e.actions)
-			if (action.channelId == ch.id)
-				sendToPlugins_(ch, action.event, e.delta);
+	sendToPlugins_(ch, e, localFrame);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -29,15 +29,18 @@
 
 #ifdef WITH_VST
 
+#include "core/actionTimeline.h"
+#include "core/types.h"
+
 namespace giada::m::channel
 {
 struct Data;
 }
-namespace giada::m::eventDispatcher
+namespace giada::m
 {
-struct Event;
+class MidiEvent;
 }
-namespace giada::m::sequencer
+namespace giada::m::eventDispatcher
 {
 struct Event;
 }
@@ -48,7 +51,8 @@ struct Data
 };
 
 void react(const channel::Data& ch, const eventDispatcher::Event& e);
-void advance(const channel::Data& ch, const sequencer::Event& e);
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame);
+void advanceLive(const channel::Data& ch, const MidiEvent& e, Frame localFrame);
 void render(const channel::Data& ch);
 } // namespace giada::m::midiReceiver
 
@@ -27,6 +27,7 @@
 #include "midiSender.h"
 #include "core/channels/channel.h"
 #include "core/kernelMidi.h"
+#include "core/midiScheduler.h"
 #include "core/mixer.h"
 
 namespace giada::m::midiSender
@@ -41,12 +42,16 @@ void send_(const channel::Data& ch, MidiEvent e)
 
 /* -------------------------------------------------------------------------- */
 
-void parseActions_(const channel::Data& ch, const std::vector<Action>& as)
+/* schedule_
+Like send_(), for messages generated by the audio thread on frame 'localFrame'
+of the current block. */
+
+void schedule_(const channel::Data& ch, MidiEvent e, Frame localFrame)
 {
-	for (const Action& a : as)
-		if (a.channelId == ch.id)
-			send_(ch, a.event);
+	e.setChannel(ch.midiSender->filter);
+	midiScheduler::schedule(e.getRaw(), localFrame);
 }
+
 } // namespace
 
 /* -------------------------------------------------------------------------- */
@@ -73,11 +78,11 @@ void react(const channel::Data& ch, const eventDispatcher::Event& e)
 
 /* -------------------------------------------------------------------------- */
 
-void advance(const channel::Data& ch, const sequencer::Event& e)
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame)
 {
 	if (!ch.midiSender->enabled)
 		return;
-	if (e.type == sequencer::EventType::ACTIONS)
-		parseActions_(ch, *e.actions);
+	for (const Action& a : actions)
+		schedule_(ch, a.event, localFrame);
 }
 } // namespace giada::m::midiSender
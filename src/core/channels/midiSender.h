@@ -27,6 +27,8 @@
 #ifndef G_CHANNEL_MIDI_SENDER_H
 #define G_CHANNEL_MIDI_SENDER_H
 
+#include "core/actionTimeline.h"
+
 namespace giada::m::channel
 {
 struct Data;
@@ -39,10 +41,6 @@ namespace giada::m::eventDispatcher
 {
 struct Event;
 }
-namespace giada::m::sequencer
-{
-struct Event;
-}
 namespace giada::m::midiSender
 {
 struct Data
@@ -63,7 +61,12 @@ struct Data
 };
 
 void react(const channel::Data& ch, const eventDispatcher::Event& e);
-void advance(const channel::Data& ch, const sequencer::Event& e);
+
+/* advanceActions
+Sends out recorded actions of channel 'ch', found on frame 'localFrame' of the
+current block. */
+
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame);
 } // namespace giada::m::midiSender
 
 #endif
@@ -27,6 +27,7 @@
 #include "sampleAdvancer.h"
 #include "core/channels/channel.h"
 #include "core/clock.h"
+#include "utils/log.h"
 #include <cassert>
 
 namespace giada::m::sampleAdvancer
@@ -65,7 +66,7 @@ void play_(const channel::Data& ch, Frame localFrame)
 
 void onFirstBeat_(const channel::Data& ch, Frame localFrame)
 {
-	G_DEBUG("onFirstBeat ch=" << ch.id << ", localFrame=" << localFrame);
+	u::log::printAsync(u::log::Subsystem::AUDIO, u::log::Level::VERBOSE, "[sampleAdvancer] onFirstBeat ch=%d, localFrame=%d\n", ch.id, localFrame);
 
 	ChannelStatus playStatus = ch.state->playStatus.load();
 	ChannelStatus recStatus  = ch.state->recStatus.load();
@@ -112,7 +113,7 @@ void onFirstBeat_(const channel::Data& ch, Frame localFrame)
 
 void onBar_(const channel::Data& ch, Frame localFrame)
 {
-	G_DEBUG("onBar ch=" << ch.id << ", localFrame=" << localFrame);
+	u::log::printAsync(u::log::Subsystem::AUDIO, u::log::Level::VERBOSE, "[sampleAdvancer] onBar ch=%d, localFrame=%d\n", ch.id, localFrame);
 
 	ChannelStatus    playStatus = ch.state->playStatus.load();
 	SamplePlayerMode mode       = ch.samplePlayer->mode;
@@ -162,16 +163,13 @@ void onNoteOff_(const channel::Data& ch, Frame localFrame)
 
 /* -------------------------------------------------------------------------- */
 
-void parseActions_(const channel::Data& ch, const std::vector<Action>& as, Frame localFrame)
+void parseActions_(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame)
 {
 	if (ch.samplePlayer->isAnyLoopMode() || !ch.isReadingActions())
 		return;
 
-	for (const Action& a : as)
+	for (const Action& a : actions)
 	{
-		if (a.channelId != ch.id)
-			continue;
-
 		switch (a.event.getStatus())
 		{
 		case MidiEvent::NOTE_ON:
@@ -241,13 +239,36 @@ void advance(const channel::Data& ch, const sequencer::Event& e)
 		rewind_(ch, e.delta);
 		break;
 
-	case sequencer::EventType::ACTIONS:
-		if (ch.state->readActions.load() == true)
-			parseActions_(ch, *e.actions, e.delta);
+	default:
+		break;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame)
+{
+	if (ch.state->readActions.load() == true)
+		parseActions_(ch, actions, localFrame);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void advanceLive(const channel::Data& ch, const MidiEvent& e, Frame localFrame)
+{
+	switch (e.getStatus())
+	{
+	case MidiEvent::NOTE_ON:
+		onNoteOn_(ch, localFrame);
+		break;
+
+	case MidiEvent::NOTE_OFF:
+	case MidiEvent::NOTE_KILL:
+		onNoteOff_(ch, localFrame);
 		break;
 
 	default:
 		break;
 	}
 }
-} // namespace giada::m::sampleAdvancer
\ No newline at end of file
+} // namespace giada::m::sampleAdvancer
@@ -37,6 +37,18 @@ namespace giada::m::sampleAdvancer
 {
 void onLastFrame(const channel::Data& ch);
 void advance(const channel::Data& ch, const sequencer::Event& e);
+
+/* advanceActions
+Plays or stops the channel at 'localFrame' according to its recorded actions
+'actions', unless it's a loop or it's not reading actions. */
+
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame);
+
+/* advanceLive
+Plays (NOTE_ON) or stops (NOTE_OFF, NOTE_KILL) the channel at 'localFrame', on
+behalf of the live events deferred by sampleReactor. */
+
+void advanceLive(const channel::Data& ch, const MidiEvent& e, Frame localFrame);
 } // namespace giada::m::sampleAdvancer
 
 #endif
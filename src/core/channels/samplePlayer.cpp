@@ -50,12 +50,12 @@ bool shouldLoop_(const channel::Data& ch)
 
 /* -------------------------------------------------------------------------- */
 
-WaveReader::Result fillBuffer_(const channel::Data& ch, Frame start, Frame offset)
+WaveReader::Result fillBuffer_(const channel::Data& ch, Frame start, Frame offset, float pitch)
 {
 	mcl::AudioBuffer& buffer     = ch.buffer->audio;
 	const WaveReader& waveReader = ch.samplePlayer->waveReader;
 
-	return waveReader.fill(buffer, start, ch.samplePlayer->end, offset, ch.samplePlayer->pitch);
+	return waveReader.fill(buffer, start, ch.samplePlayer->end, offset, pitch);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -146,7 +146,7 @@ ID Data::getWaveId() const
 
 Frame Data::getWaveSize() const
 {
-	return hasWave() ? waveReader.wave->getBuffer().countFrames() : 0;
+	return hasWave() ? waveReader.wave->countFrames() : 0;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -156,7 +156,10 @@ Frame Data::getWaveSize() const
 void react(channel::Data& ch, const eventDispatcher::Event& e)
 {
 	if (e.type == eventDispatcher::EventType::CHANNEL_PITCH)
+	{
 		ch.samplePlayer->pitch = std::get<float>(e.data);
+		ch.state->pitch.setTarget(ch.samplePlayer->pitch);
+	}
 }
 
 /* -------------------------------------------------------------------------- */
@@ -166,10 +169,25 @@ void advance(const channel::Data& ch, const sequencer::Event& e)
 	sampleAdvancer::advance(ch, e);
 }
 
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame)
+{
+	sampleAdvancer::advanceActions(ch, actions, localFrame);
+}
+
+void advanceLive(const channel::Data& ch, const MidiEvent& e, Frame localFrame)
+{
+	sampleAdvancer::advanceLive(ch, e, localFrame);
+}
+
 /* -------------------------------------------------------------------------- */
 
 void render(const channel::Data& ch)
 {
+	/* Pitch glides block by block: the resampler smooths ratio changes within 
+	each block. */
+
+	const float pitch = ch.state->pitch.advance(ch.buffer->audio.countFrames()).end;
+
 	if (!isPlaying_(ch))
 		return;
 
@@ -187,14 +205,14 @@ void render(const channel::Data& ch)
 	{
 		if (tracker < end)
 		{
-			fillBuffer_(ch, tracker, 0);
+			fillBuffer_(ch, tracker, 0, pitch);
 			ch.samplePlayer->waveReader.last();
 		}
 		ch.state->rewinding = false;
 		tracker             = begin;
 	}
 
-	WaveReader::Result res = fillBuffer_(ch, tracker, ch.state->offset);
+	WaveReader::Result res = fillBuffer_(ch, tracker, ch.state->offset, pitch);
 	tracker += res.used;
 
 	/* If tracker has looped, special care is needed for the rendering. If the
@@ -207,7 +225,7 @@ void render(const channel::Data& ch)
 		tracker = begin;
 		sampleAdvancer::onLastFrame(ch); // TODO - better moving this to samplerAdvancer::advance
 		if (shouldLoop_(ch) && res.generated < ch.buffer->audio.countFrames())
-			tracker += fillBuffer_(ch, tracker, res.generated).used;
+			tracker += fillBuffer_(ch, tracker, res.generated, pitch).used;
 	}
 
 	ch.state->offset = 0;
@@ -228,7 +246,7 @@ void loadWave(channel::Data& ch, Wave* w)
 	{
 		ch.state->playStatus.store(ChannelStatus::OFF);
 		ch.name              = w->getBasename(/*ext=*/false);
-		ch.samplePlayer->end = w->getBuffer().countFrames() - 1;
+		ch.samplePlayer->end = w->countFrames() - 1;
 	}
 	else
 	{
@@ -71,6 +71,8 @@ struct Data
 
 void react(channel::Data& ch, const eventDispatcher::Event& e);
 void advance(const channel::Data& ch, const sequencer::Event& e);
+void advanceActions(const channel::Data& ch, ActionTimeline::Span actions, Frame localFrame);
+void advanceLive(const channel::Data& ch, const MidiEvent& e, Frame localFrame);
 void render(const channel::Data& ch);
 
 /* loadWave
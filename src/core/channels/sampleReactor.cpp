@@ -28,7 +28,9 @@
 #include "core/channels/channel.h"
 #include "core/clock.h"
 #include "core/conf.h"
+#include "core/mixer.h"
 #include "src/core/model/model.h"
+#include "utils/log.h"
 #include "utils/math.h"
 #include <cassert>
 
@@ -39,18 +41,33 @@ namespace
 constexpr int Q_ACTION_PLAY   = 0;
 constexpr int Q_ACTION_REWIND = 1;
 
-void          press_(channel::Data& ch, int velocity);
-void          release_(channel::Data& ch);
+void          press_(channel::Data& ch, int velocity, Timestamp t);
+void          release_(channel::Data& ch, Timestamp t);
 void          kill_(channel::Data& ch);
 void          onStopBySeq_(channel::Data& ch);
 void          toggleReadActions_(channel::Data& ch);
 ChannelStatus pressWhileOff_(channel::Data& ch, int velocity, bool isLoop);
 ChannelStatus pressWhilePlay_(channel::Data& ch, SamplePlayerMode mode, bool isLoop);
+bool          pressWhilePlayLive_(const channel::Data& ch, SamplePlayerMode mode, Timestamp t);
+bool          pushLive_(const channel::Data& ch, int status, Timestamp t);
 void          rewind_(channel::Data& ch, Frame localFrame = 0);
 
 /* -------------------------------------------------------------------------- */
 
-void press_(channel::Data& ch, int velocity)
+/* pushLive_
+Defers a play/stop to the realtime thread, which will apply it at the frame 
+corresponding to the event timestamp (see sampleAdvancer::advanceLive()). The 
+channel status is then changed there, not here. Returns false if the live queue
+is full: the caller must change the status right away. */
+
+bool pushLive_(const channel::Data& ch, int status, Timestamp t)
+{
+	return mixer::liveEvents.push({ch.id, MidiEvent(status, 0, 0), t});
+}
+
+/* -------------------------------------------------------------------------- */
+
+void press_(channel::Data& ch, int velocity, Timestamp t)
 {
 	ChannelStatus    playStatus = ch.state->playStatus.load();
 	SamplePlayerMode mode       = ch.samplePlayer->mode;
@@ -60,9 +77,13 @@ void press_(channel::Data& ch, int velocity)
 	{
 	case ChannelStatus::OFF:
 		playStatus = pressWhileOff_(ch, velocity, isLoop);
+		if (playStatus == ChannelStatus::PLAY && pushLive_(ch, MidiEvent::NOTE_ON, t))
+			return;
 		break;
 
 	case ChannelStatus::PLAY:
+		if (pressWhilePlayLive_(ch, mode, t))
+			return;
 		playStatus = pressWhilePlay_(ch, mode, isLoop);
 		break;
 
@@ -83,21 +104,22 @@ void press_(channel::Data& ch, int velocity)
 
 /* -------------------------------------------------------------------------- */
 
-void release_(channel::Data& ch)
+void release_(channel::Data& ch, Timestamp t)
 {
 	/* Key release is meaningful only for SINGLE_PRESS modes. */
 
 	if (ch.samplePlayer->mode != SamplePlayerMode::SINGLE_PRESS)
 		return;
 
-	/* Kill it if it's SINGLE_PRESS is playing. Otherwise there might be a 
-	quantization step in progress that would play the channel later on: 
-	disable it. */
+	/* If it's not playing, there might be a quantization step in progress that
+	would play the channel later on: disable it. Otherwise kill it. Do this 
+	also if the status is still OFF: the press might be a live event not yet
+	applied by the realtime thread. */
 
-	if (ch.state->playStatus.load() == ChannelStatus::PLAY)
-		kill_(ch);
-	else if (sequencer::quantizer.hasBeenTriggered())
+	if (ch.state->playStatus.load() != ChannelStatus::PLAY && sequencer::quantizer.hasBeenTriggered())
 		sequencer::quantizer.clear();
+	else if (!pushLive_(ch, MidiEvent::NOTE_OFF, t))
+		kill_(ch);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -112,7 +134,7 @@ void kill_(channel::Data& ch)
 
 void onStopBySeq_(channel::Data& ch)
 {
-	G_DEBUG("onStopBySeq ch=" << ch.id);
+	u::log::printAsync(u::log::Subsystem::EVENTS, u::log::Level::VERBOSE, "[sampleReactor] onStopBySeq ch=%d\n", ch.id);
 
 	ChannelStatus playStatus       = ch.state->playStatus.load();
 	bool          isReadingActions = ch.state->readActions.load();
@@ -183,6 +205,22 @@ ChannelStatus pressWhilePlay_(channel::Data& ch, SamplePlayerMode mode, bool isL
 
 /* -------------------------------------------------------------------------- */
 
+/* pressWhilePlayLive_
+Defers to the realtime thread the cases of pressWhilePlay_() that take effect 
+right away, i.e. non-quantized retrigger and stop. Returns false if nothing has
+been deferred. */
+
+bool pressWhilePlayLive_(const channel::Data& ch, SamplePlayerMode mode, Timestamp t)
+{
+	if (mode == SamplePlayerMode::SINGLE_RETRIG && !clock::canQuantize())
+		return pushLive_(ch, MidiEvent::NOTE_ON, t);
+	if (mode == SamplePlayerMode::SINGLE_BASIC)
+		return pushLive_(ch, MidiEvent::NOTE_KILL, t);
+	return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
 void toggleReadActions_(channel::Data& ch)
 {
 	if (clock::isRunning() && ch.state->recStatus.load() == ChannelStatus::PLAY && !conf::conf.treatRecsAsLoops)
@@ -234,15 +272,16 @@ void react(channel::Data& ch, const eventDispatcher::Event& e)
 	{
 
 	case eventDispatcher::EventType::KEY_PRESS:
-		press_(ch, std::get<int>(e.data));
+		press_(ch, std::get<int>(e.data), e.timestamp);
 		break;
 
 	case eventDispatcher::EventType::KEY_RELEASE:
-		release_(ch);
+		release_(ch, e.timestamp);
 		break;
 
 	case eventDispatcher::EventType::KEY_KILL:
-		kill_(ch);
+		if (!pushLive_(ch, MidiEvent::NOTE_KILL, e.timestamp))
+			kill_(ch);
 		break;
 
 	case eventDispatcher::EventType::SEQUENCER_STOP:
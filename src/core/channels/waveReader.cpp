@@ -28,6 +28,7 @@
 #include "core/const.h"
 #include "core/model/model.h"
 #include "core/wave.h"
+#include "core/waveStream.h"
 #include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
 #include "utils/log.h"
 #include <algorithm>
@@ -49,9 +50,11 @@ WaveReader::Result WaveReader::fill(mcl::AudioBuffer& out, Frame start, Frame ma
 {
 	assert(wave != nullptr);
 	assert(start >= 0);
-	assert(max <= wave->getBuffer().countFrames());
+	assert(max <= wave->countFrames());
 	assert(offset < out.countFrames());
 
+	if (wave->isStreamed())
+		return fillStreamed(out, start, max, offset, pitch);
 	if (pitch == 1.0f)
 		return fillCopy(out, start, max, offset);
 	else
@@ -63,13 +66,13 @@ WaveReader::Result WaveReader::fill(mcl::AudioBuffer& out, Frame start, Frame ma
 WaveReader::Result WaveReader::fillResampled(mcl::AudioBuffer& dest, Frame start,
     Frame max, Frame offset, float pitch) const
 {
-	Resampler::Result res = m_resampler->process(
-	    /*input=*/wave->getBuffer()[0],
-	    /*inputPos=*/start,
-	    /*inputLen=*/max,
-	    /*output=*/dest[offset],
-	    /*outputLen=*/dest.countFrames() - offset,
-	    /*pitch=*/pitch);
+	const Frame outLength = dest.countFrames() - offset;
+
+	/* Packed data is decoded by the resampler itself, one chunk at a time. */
+
+	Resampler::Result res = wave->isPacked()
+	    ? m_resampler->process(wave->getPacked(), wave->getFormat(), start, max, dest[offset], outLength, pitch)
+	    : m_resampler->process(wave->getBuffer()[0], start, max, dest[offset], outLength, pitch);
 
 	return {
 	    static_cast<int>(res.used),
@@ -85,11 +88,64 @@ WaveReader::Result WaveReader::fillCopy(mcl::AudioBuffer& dest, Frame start,
 	if (used > max - start)
 		used = max - start;
 
-	dest.set(wave->getBuffer(), used, start, offset);
+	if (wave->isPacked())
+	{
+		assert(wave->countChannels() == dest.countChannels());
+		wave->read(start, dest[offset], used);
+	}
+	else
+		dest.set(wave->getBuffer(), used, start, offset);
 
 	return {used, used};
 }
 
+/* -------------------------------------------------------------------------- */
+
+WaveReader::Result WaveReader::fillStreamed(mcl::AudioBuffer& dest, Frame start,
+    Frame max, Frame offset, float pitch) const
+{
+	WaveStream& stream = *wave->getStream();
+
+	if (pitch == 1.0f)
+	{
+		Frame used = dest.countFrames() - offset;
+		if (used > max - start)
+			used = max - start;
+
+		stream.read(start, dest[offset], used);
+		stream.consume(start, used);
+
+		return {used, used};
+	}
+
+	/* The resampler needs contiguous input: peek a generous amount of frames
+	into the stream's scratch buffer, then release only those actually used.
+	The extra room covers the resampler's internal buffering. */
+
+	const Frame outLength = dest.countFrames() - offset;
+	const Frame inLength  = std::min({max - start,
+	    static_cast<Frame>(outLength * pitch) + G_MAX_BUF_SIZE,
+	    stream.getScratchSize()});
+
+	stream.read(start, stream.getScratch(), inLength);
+
+	Resampler::Result res = m_resampler->process(
+	    /*input=*/stream.getScratch(),
+	    /*inputPos=*/0,
+	    /*inputLen=*/inLength,
+	    /*output=*/dest[offset],
+	    /*outputLen=*/outLength,
+	    /*pitch=*/pitch);
+
+	stream.consume(start, static_cast<Frame>(res.used));
+
+	return {
+	    static_cast<int>(res.used),
+	    static_cast<int>(res.generated)};
+}
+
+/* -------------------------------------------------------------------------- */
+
 void WaveReader::last() const
 {
 	if (m_resampler != nullptr)
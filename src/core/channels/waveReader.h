@@ -57,7 +57,8 @@ public:
 
 	/* fill
 	Fills audio buffer 'out' with data coming from Wave, copying it from 'start'
-	frame up to 'max'. The buffer is filled starting at 'offset'. */
+	frame up to 'max'. The buffer is filled starting at 'offset'. Packed Waves
+	are decoded on the fly. */
 
 	Result fill(mcl::AudioBuffer& out, Frame start, Frame max, Frame offset,
 	    float pitch) const;
@@ -78,6 +79,13 @@ private:
 	    float pitch) const;
 	Result fillCopy(mcl::AudioBuffer& out, Frame start, Frame max, Frame offset) const;
 
+	/* fillStreamed
+	Same as above, for streamed Waves. Audio data is pulled from the Wave's 
+	stream instead of its buffer. */
+
+	Result fillStreamed(mcl::AudioBuffer& out, Frame start, Frame max, Frame offset,
+	    float pitch) const;
+
 	Resampler* m_resampler;
 };
 } // namespace giada::m
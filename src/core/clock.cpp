@@ -95,6 +95,18 @@ void init()
 
 	model::swap(model::SwapType::NONE);
 
+	/* An external MIDI clock drives the sequencer, tempo included, through the
+	same events sent by MIDI-learnt controls: they are processed by the event 
+	dispatcher, not on the MIDI thread. */
+
+	sync::onMidiClockStart = []() {
+		c::events::rewindSequencer(Thread::MIDI);
+		c::events::startSequencer(Thread::MIDI);
+	};
+	sync::onMidiClockContinue  = []() { c::events::startSequencer(Thread::MIDI); };
+	sync::onMidiClockStop      = []() { c::events::stopSequencer(Thread::MIDI); };
+	sync::onMidiClockChangeBpm = [](float bpm) { c::events::setSequencerBpm(bpm, Thread::MIDI); };
+
 #ifdef WITH_AUDIO_JACK
 
 	if (kernelAudio::getAPI() == G_SYS_API_JACK)
@@ -0,0 +1,118 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/clockPll.h"
+#include "core/const.h"
+#include <chrono>
+#include <cmath>
+
+namespace giada::m
+{
+namespace
+{
+constexpr double PI_ = 3.14159265358979323846;
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+ClockPll::ClockPll()
+{
+	reset();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ClockPll::reset()
+{
+	m_origin = {};
+	m_ticks  = 0;
+	m_next   = 0.0;
+	m_period = 0.0;
+	m_b      = 0.0;
+	m_c      = 0.0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ClockPll::tick(Timestamp t)
+{
+	const double now = std::chrono::duration<double>(t - m_origin).count();
+
+	/* A long silence means the sender has been stopped or replaced: restart
+	from scratch rather than treating the gap as a very slow tick. */
+
+	if (m_ticks > 0 && now - (m_next - m_period) > G_MIDI_CLOCK_PLL_TIMEOUT_MS / 1000.0)
+		reset();
+
+	/* The first tick sets the origin, the second one gives a rough period to 
+	start with. Loop gains are derived from that period and the bandwidth, for
+	a second-order loop with a damping factor of 1/sqrt(2). */
+
+	if (m_ticks == 0)
+	{
+		m_origin = t;
+		m_next   = 0.0;
+		m_ticks  = 1;
+		return;
+	}
+
+	if (m_ticks == 1)
+	{
+		const double omega = 2.0 * PI_ * G_MIDI_CLOCK_PLL_BANDWIDTH * now;
+
+		m_period = now;
+		m_next   = now + now;
+		m_b      = std::sqrt(2.0) * omega;
+		m_c      = omega * omega;
+		m_ticks  = 2;
+		return;
+	}
+
+	const double error = now - m_next;
+
+	m_next += m_b * error + m_period;
+	m_period += m_c * error;
+	m_ticks++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ClockPll::isLocked() const
+{
+	return m_ticks >= G_MIDI_CLOCK_PLL_LOCK_TICKS && m_period > 0.0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+float ClockPll::getBpm() const
+{
+	if (m_period <= 0.0)
+		return 0.0f;
+	return static_cast<float>(60.0 / (m_period * G_MIDI_CLOCK_PPQN));
+}
+} // namespace giada::m
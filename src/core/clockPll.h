@@ -0,0 +1,76 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_CLOCK_PLL_H
+#define G_CLOCK_PLL_H
+
+#include "core/types.h"
+
+namespace giada::m
+{
+/* ClockPll
+Recovers the tempo of an external MIDI clock. Ticks arrive with the jitter of
+the sender, the cable and the MIDI driver: a second-order phase-locked loop 
+predicts the time of the next tick and corrects both its phase and its period
+by a fraction of the prediction error, so that jitter is filtered out while
+real tempo changes are followed within a fraction of a second. */
+
+class ClockPll
+{
+public:
+	ClockPll();
+
+	/* reset
+	Forgets the current estimate. The next tick starts locking from scratch. */
+
+	void reset();
+
+	/* tick
+	Feeds a clock tick received at time 't'. */
+
+	void tick(Timestamp t);
+
+	/* isLocked
+	True when enough ticks have been received for getBpm() to be reliable. */
+
+	bool isLocked() const;
+
+	/* getBpm
+	Returns the estimated tempo, in beats per minute. */
+
+	float getBpm() const;
+
+private:
+	Timestamp m_origin;
+	int       m_ticks;
+	double    m_next;   // Predicted time of the next tick, seconds since m_origin
+	double    m_period; // Filtered tick period, in seconds
+	double    m_b;
+	double    m_c;
+};
+} // namespace giada::m
+
+#endif
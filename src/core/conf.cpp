@@ -26,11 +26,13 @@
 
 #include "conf.h"
 #include "core/const.h"
+#include "core/resampler.h"
 #include "core/types.h"
 #include "deps/json/single_include/nlohmann/json.hpp"
 #include "utils/fs.h"
 #include "utils/log.h"
 #include <FL/Fl.H>
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <string>
@@ -53,6 +55,9 @@ void sanitize_()
 	conf.channelsOutStart = std::max(0, conf.channelsOutStart);
 	conf.channelsInCount  = std::max(1, conf.channelsInCount);
 	conf.channelsInStart  = std::max(0, conf.channelsInStart);
+	conf.renderThreads    = std::clamp(conf.renderThreads, 1, G_MAX_RENDER_THREADS);
+	conf.waveCacheSize    = std::max(0, conf.waveCacheSize);
+	conf.rsmpQuality      = std::clamp(conf.rsmpQuality, 0, static_cast<int>(Resampler::Quality::POLYPHASE_BEST));
 }
 
 /* -------------------------------------------------------------------------- */
@@ -142,6 +147,10 @@ bool read()
 	conf.buffersize                 = j.value(CONF_KEY_BUFFER_SIZE, conf.buffersize);
 	conf.limitOutput                = j.value(CONF_KEY_LIMIT_OUTPUT, conf.limitOutput);
 	conf.rsmpQuality                = j.value(CONF_KEY_RESAMPLE_QUALITY, conf.rsmpQuality);
+	conf.renderThreads              = j.value(CONF_KEY_RENDER_THREADS, conf.renderThreads);
+	conf.waveCache                  = j.value(CONF_KEY_WAVE_CACHE, conf.waveCache);
+	conf.waveCacheSize              = j.value(CONF_KEY_WAVE_CACHE_SIZE, conf.waveCacheSize);
+	conf.projectAudio               = j.value(CONF_KEY_PROJECT_AUDIO, conf.projectAudio);
 	conf.midiSystem                 = j.value(CONF_KEY_MIDI_SYSTEM, conf.midiSystem);
 	conf.midiPortOut                = j.value(CONF_KEY_MIDI_PORT_OUT, conf.midiPortOut);
 	conf.midiPortIn                 = j.value(CONF_KEY_MIDI_PORT_IN, conf.midiPortIn);
@@ -238,6 +247,10 @@ bool write()
 	j[CONF_KEY_BUFFER_SIZE]                   = conf.buffersize;
 	j[CONF_KEY_LIMIT_OUTPUT]                  = conf.limitOutput;
 	j[CONF_KEY_RESAMPLE_QUALITY]              = conf.rsmpQuality;
+	j[CONF_KEY_RENDER_THREADS]                = conf.renderThreads;
+	j[CONF_KEY_WAVE_CACHE]                    = conf.waveCache;
+	j[CONF_KEY_WAVE_CACHE_SIZE]               = conf.waveCacheSize;
+	j[CONF_KEY_PROJECT_AUDIO]                 = static_cast<int>(conf.projectAudio);
 	j[CONF_KEY_MIDI_SYSTEM]                   = conf.midiSystem;
 	j[CONF_KEY_MIDI_PORT_OUT]                 = conf.midiPortOut;
 	j[CONF_KEY_MIDI_PORT_IN]                  = conf.midiPortIn;
@@ -49,6 +49,11 @@ struct Conf
 	int  buffersize       = G_DEFAULT_BUFSIZE;
 	bool limitOutput      = false;
 	int  rsmpQuality      = 0;
+	int  renderThreads    = 1; // 1 = render channels on the audio thread only
+	bool waveCache        = true;
+	int  waveCacheSize    = G_DEFAULT_WAVE_CACHE_SIZE; // Megabytes
+
+	ProjectAudio projectAudio = ProjectAudio::WAV; // Format of audio files in saved projects
 
 	int         midiSystem  = 0;
 	int         midiPortOut = G_DEFAULT_MIDI_PORT_OUT;
@@ -75,11 +75,15 @@ constexpr auto CONF_FILENAME = "giada.conf";
 #endif
 
 /* -- Engine ---------------------------------------------------------------- */
-/* G_EVENT_DISPATCHER_RATE_MS
-The amount of sleep between each Event Dispatcher cycle. It should be lower
-than the audio thread sleep time. Note: this value will obviously increase the 
-live input latency, keep it small! */
-constexpr int G_EVENT_DISPATCHER_RATE_MS = 5;
+/* G_EVENT_DISPATCHER_TIMEOUT_MS
+The Event Dispatcher wakes up as soon as an event is pushed. This is just the 
+maximum amount of sleep when no events come in, as a safety net. */
+constexpr int G_EVENT_DISPATCHER_TIMEOUT_MS = 100;
+
+/* G_EVENT_DISPATCHER_LATENCY_BUCKETS
+Number of log2 buckets (in microseconds) of the Event Dispatcher latency 
+histogram: 1 us to ~1 s. */
+constexpr int G_EVENT_DISPATCHER_LATENCY_BUCKETS = 21;
 
 /* -- GUI ------------------------------------------------------------------- */
 constexpr float G_GUI_REFRESH_RATE   = 1 / 30.0f; // 30 fps
@@ -126,8 +130,10 @@ constexpr int   G_MAX_VELOCITY          = 0x7F;
 constexpr int   G_MAX_MIDI_CHANS        = 16;
 constexpr int   G_MAX_POLYPHONY         = 32;
 constexpr int   G_MAX_DISPATCHER_EVENTS = 32;
+constexpr int   G_MAX_LIVE_EVENTS       = 64;
 constexpr int   G_MAX_SEQUENCER_EVENTS  = 128; // Per block
 constexpr int   G_MAX_QUANTIZER_SIZE    = 32;
+constexpr int   G_MAX_MIDI_BUFFER_BYTES = 4096; // Preallocated in JUCE MIDI buffers
 
 /* -- kernel audio ---------------------------------------------------------- */
 constexpr int G_SYS_API_NONE   = 0;
@@ -143,6 +149,18 @@ constexpr int G_SYS_API_WASAPI = 7;
 constexpr int G_MIDI_API_JACK = 0x01; // 0000 0001
 constexpr int G_MIDI_API_ALSA = 0x02; // 0000 0010
 
+/* Max distance between the reconstructed time of a MIDI message and the 
+system clock, before re-syncing the two. */
+constexpr int G_MIDI_IN_MAX_DRIFT_MS = 10;
+
+/* Outgoing MIDI messages in flight between the audio thread and the MIDI
+scheduler, how long the idle scheduler sleeps and how often it looks for new
+messages while waiting for the next one to be due. */
+constexpr int G_MAX_MIDI_OUT_EVENTS      = 1024;
+constexpr int G_MIDI_OUT_TIMEOUT_MS      = 100;
+constexpr int G_MIDI_OUT_POLL_US         = 500;
+constexpr int G_MIDI_OUT_THREAD_PRIORITY = 75; // SCHED_FIFO, if the OS allows it
+
 /* -- default system -------------------------------------------------------- */
 #if defined(G_OS_LINUX)
 #define G_DEFAULT_SOUNDSYS G_SYS_API_NONE
@@ -194,6 +212,48 @@ constexpr int LOG_MODE_STDOUT = 0x01;
 constexpr int LOG_MODE_FILE   = 0x02;
 constexpr int LOG_MODE_MUTE   = 0x04;
 
+/* -- async log ------------------------------------------------------------- */
+constexpr int G_LOG_QUEUE_SIZE    = 1024; // Must be a power of 2
+constexpr int G_LOG_MAX_ARGS      = 8;
+constexpr int G_LOG_LINE_SIZE     = 512;
+constexpr int G_LOG_DRAIN_RATE_MS = 20;
+
+/* -- wave streaming -------------------------------------------------------- */
+constexpr int G_WAVE_STREAM_HEAD_FRAMES  = 65536;  // Preloaded in memory
+constexpr int G_WAVE_STREAM_RING_FRAMES  = 262144; // Must be a power of 2
+constexpr int G_WAVE_STREAM_CHUNK_FRAMES = 4096;   // Read from disk at once
+constexpr int G_WAVE_STREAM_RATE_MS      = 10;
+
+/* -- wave cache ------------------------------------------------------------ */
+constexpr int G_WAVE_CACHE_VERSION      = 1;
+constexpr int G_DEFAULT_WAVE_CACHE_SIZE = 4096; // Megabytes
+
+/* -- wave peaks ------------------------------------------------------------ */
+constexpr int G_WAVE_PEAKS_BASE_FRAMES = 64;   // Frames per bucket at level 0, power of 2
+constexpr int G_WAVE_PEAKS_CHUNK       = 4096; // Buckets computed between cancel checks
+
+/* -- MIDI clock ------------------------------------------------------------ */
+constexpr int   G_MIDI_CLOCK_PPQN           = 24;
+constexpr float G_MIDI_CLOCK_PLL_BANDWIDTH  = 0.25f; // Hz: lower is smoother, but slower to follow tempo changes
+constexpr int   G_MIDI_CLOCK_PLL_LOCK_TICKS = 48;    // Ticks before the tempo estimate is trusted
+constexpr int   G_MIDI_CLOCK_PLL_TIMEOUT_MS = 1000;  // Gap between ticks that restarts the PLL
+constexpr float G_MIDI_CLOCK_BPM_THRESHOLD  = 0.05f; // Smallest tempo change applied to the clock
+
+/* -- parameter ramps ------------------------------------------------------- */
+constexpr int G_PARAM_RAMP_FRAMES = 1024; // Glide time of volume, pan and pitch changes
+
+/* -- patch loading --------------------------------------------------------- */
+constexpr int G_PATCH_LOAD_PROGRESS_RATE_MS = 50;
+
+/* -- render pool ----------------------------------------------------------- */
+constexpr int G_MAX_RENDER_THREADS       = 16;
+constexpr int G_RENDER_THREAD_PRIORITY   = 70; // SCHED_FIFO, if the OS allows it
+constexpr int G_RENDER_THREAD_TIMEOUT_MS = 1000;
+
+/* -- offline rendering ----------------------------------------------------- */
+constexpr int G_OFFLINE_CHUNK_FRAMES = 65536; // Frames handed to the writer thread at once
+constexpr int G_OFFLINE_MAX_CHUNKS   = 64;    // Chunks in flight before the renderer waits
+
 /* -- unique IDs of mainWin's subwindows ------------------------------------ */
 /* -- wid > 0 are reserved by gg_keyboard ----------------------------------- */
 constexpr int WID_BEATS         = -1;
@@ -264,6 +324,7 @@ constexpr uint32_t G_MIDI_ALL_NOTES_OFF = (G_MIDI_CONTROLLER) | (0x7B << 16);
 constexpr int MIDI_SYSEX        = 0xF0;
 constexpr int MIDI_MTC_QUARTER  = 0xF1;
 constexpr int MIDI_POSITION_PTR = 0xF2;
+constexpr int MIDI_SONG_SELECT  = 0xF3;
 constexpr int MIDI_CLOCK        = 0xF8;
 constexpr int MIDI_START        = 0xFA;
 constexpr int MIDI_CONTINUE     = 0xFB;
@@ -294,6 +355,7 @@ constexpr auto PATCH_KEY_MASTER_VOL_OUT               = "master_vol_out";
 constexpr auto PATCH_KEY_METRONOME                    = "metronome";
 constexpr auto PATCH_KEY_LAST_TAKE_ID                 = "last_take_id";
 constexpr auto PATCH_KEY_SAMPLERATE                   = "samplerate";
+constexpr auto PATCH_KEY_SAMPLE_FORMAT                = "sample_format";
 constexpr auto PATCH_KEY_COLUMNS                      = "columns";
 constexpr auto PATCH_KEY_PLUGINS                      = "plugins";
 constexpr auto PATCH_KEY_MASTER_OUT_PLUGINS           = "master_out_plugins";
@@ -343,6 +405,7 @@ constexpr auto PATCH_KEY_CHANNEL_ARMED                = "armed";
 constexpr auto PATCH_KEY_WAVES                        = "waves";
 constexpr auto PATCH_KEY_WAVE_ID                      = "id";
 constexpr auto PATCH_KEY_WAVE_PATH                    = "path";
+constexpr auto PATCH_KEY_WAVE_STREAMED                = "streamed";
 constexpr auto PATCH_KEY_ACTIONS                      = "actions";
 constexpr auto PATCH_KEY_ACTION_TYPE                  = "type";
 constexpr auto PATCH_KEY_ACTION_FRAME                 = "frame";
@@ -446,6 +509,10 @@ constexpr auto CONF_KEY_PLUGIN_SORT_METHOD            = "plugin_sort_method";
 constexpr auto CONF_KEY_REC_TRIGGER_MODE              = "rec_trigger_mode";
 constexpr auto CONF_KEY_REC_TRIGGER_LEVEL             = "rec_trigger_level";
 constexpr auto CONF_KEY_INPUT_REC_MODE                = "input_rec_mode";
+constexpr auto CONF_KEY_RENDER_THREADS                = "render_threads";
+constexpr auto CONF_KEY_WAVE_CACHE                    = "wave_cache";
+constexpr auto CONF_KEY_WAVE_CACHE_SIZE               = "wave_cache_size";
+constexpr auto CONF_KEY_PROJECT_AUDIO                 = "project_audio";
 
 /* JSON midimaps keys */
 
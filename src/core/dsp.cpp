@@ -0,0 +1,917 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/dsp.h"
+#include "utils/log.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define G_DSP_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define G_DSP_AVX2_TARGET
+#else
+#define G_DSP_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define G_DSP_NEON
+#endif
+
+namespace giada::m::dsp
+{
+namespace
+{
+/* Kernels
+Set of functions working on raw interleaved stereo data. 'samples' counts 
+single floats (i.e. frames * 2), 'frames' counts pairs of them. */
+
+struct Kernels
+{
+	void (*sum)(float* dest, const float* src, int samples, float gainL, float gainR);
+	void (*sumRamp)(float* dest, const float* src, int frames, float gainL, float gainR, float stepL, float stepR);
+	void (*sumMono)(float* dest, const float* src, int frames, float gainL, float gainR);
+	void (*applyGain)(float* data, int samples, float gain);
+	void (*clamp)(float* data, int samples, float min, float max);
+	void (*peak)(const float* data, int frames, float& left, float& right);
+	void (*decodeInt16)(float* dest, const uint16_t* src, int samples);
+	void (*decodeHalf)(float* dest, const uint16_t* src, int samples);
+	void (*interpolate)(const float* frames, const float* a, const float* b, float t, int taps, float& left, float& right);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Conversion constants. 16-bit integers map to [-1.0, 1.0) as libsndfile does
+when reading 16-bit files, so 8 and 16-bit sources survive a round trip. Half 
+floats are decoded by shifting their bits into place and fixing the exponent 
+bias: zeros and subnormals, having no implicit leading 1, are adjusted by 
+subtracting HALF_MIN_. No float subnormals are involved, so the result doesn't 
+depend on the denormals-are-zero mode. */
+
+constexpr float    INT16_SCALE_     = 1.0f / 32768.0f;
+constexpr float    HALF_MIN_        = 1.0f / 16384.0f; // 2^-14
+constexpr uint32_t HALF_REBIAS_     = (127 - 15) << 23;
+constexpr uint32_t HALF_EXP_MASK_   = 0x1F << 23;
+constexpr uint32_t HALF_IMPLICIT_1_ = 1 << 23;
+
+float halfToFloat_(uint16_t h)
+{
+	const uint32_t bits = static_cast<uint32_t>(h & 0x7FFF) << 13;
+
+	uint32_t u = bits + HALF_REBIAS_;
+	float    f;
+	if ((bits & HALF_EXP_MASK_) == 0)
+	{
+		u += HALF_IMPLICIT_1_;
+		std::memcpy(&f, &u, sizeof(float));
+		f -= HALF_MIN_;
+		std::memcpy(&u, &f, sizeof(float));
+	}
+	u |= static_cast<uint32_t>(h & 0x8000) << 16;
+	std::memcpy(&f, &u, sizeof(float));
+	return f;
+}
+
+/* floatToHalf_
+Rounds to nearest even. Magnitudes that would round to infinity are clamped to
+the largest half (65504), NaNs are silenced. */
+
+uint16_t floatToHalf_(float f)
+{
+	uint32_t u;
+	std::memcpy(&u, &f, sizeof(float));
+
+	const uint16_t sign = (u >> 16) & 0x8000;
+	u &= 0x7FFFFFFF;
+
+	if (u >= 0x477FF000) // 65520.0f and above, infinities and NaNs
+		return u > 0x7F800000 ? 0 : sign | 0x7BFF;
+
+	if (u < 0x38800000) // Below 2^-14: subnormal half or zero
+	{
+		/* Adding a power of two aligns the 10 bits of a subnormal half at the 
+		bottom of the mantissa, rounded by the FPU. */
+
+		constexpr uint32_t ALIGN = (127 - 1) << 23; // 0.5f
+		float              a, v;
+		std::memcpy(&a, &ALIGN, sizeof(float));
+		std::memcpy(&v, &u, sizeof(float));
+		v += a;
+		std::memcpy(&u, &v, sizeof(float));
+		return sign | static_cast<uint16_t>(u - ALIGN);
+	}
+
+	const uint32_t odd = (u >> 13) & 1;
+	u = u - HALF_REBIAS_ + 0xFFF + odd;
+	return sign | static_cast<uint16_t>(u >> 13);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void sumScalar_(float* dest, const float* src, int samples, float gainL, float gainR)
+{
+	for (int i = 0; i + 1 < samples; i += 2)
+	{
+		dest[i] += src[i] * gainL;
+		dest[i + 1] += src[i + 1] * gainR;
+	}
+}
+
+void sumRampScalar_(float* dest, const float* src, int frames, float gainL, float gainR,
+    float stepL, float stepR)
+{
+	for (int i = 0; i < frames; i++)
+	{
+		dest[i * 2] += src[i * 2] * (gainL + stepL * i);
+		dest[i * 2 + 1] += src[i * 2 + 1] * (gainR + stepR * i);
+	}
+}
+
+void sumMonoScalar_(float* dest, const float* src, int frames, float gainL, float gainR)
+{
+	for (int i = 0; i < frames; i++)
+	{
+		dest[i * 2] += src[i] * gainL;
+		dest[i * 2 + 1] += src[i] * gainR;
+	}
+}
+
+void applyGainScalar_(float* data, int samples, float gain)
+{
+	for (int i = 0; i < samples; i++)
+		data[i] *= gain;
+}
+
+void clampScalar_(float* data, int samples, float min, float max)
+{
+	for (int i = 0; i < samples; i++)
+		data[i] = std::max(min, std::min(data[i], max));
+}
+
+void peakScalar_(const float* data, int frames, float& left, float& right)
+{
+	for (int i = 0; i < frames; i++)
+	{
+		left  = std::max(left, std::fabs(data[i * 2]));
+		right = std::max(right, std::fabs(data[i * 2 + 1]));
+	}
+}
+
+void decodeInt16Scalar_(float* dest, const uint16_t* src, int samples)
+{
+	for (int i = 0; i < samples; i++)
+		dest[i] = static_cast<int16_t>(src[i]) * INT16_SCALE_;
+}
+
+void decodeHalfScalar_(float* dest, const uint16_t* src, int samples)
+{
+	for (int i = 0; i < samples; i++)
+		dest[i] = halfToFloat_(src[i]);
+}
+
+void interpolateScalar_(const float* frames, const float* a, const float* b, float t,
+    int taps, float& left, float& right)
+{
+	left  = 0.0f;
+	right = 0.0f;
+	for (int i = 0; i < taps; i++)
+	{
+		const float c = a[i] + (b[i] - a[i]) * t;
+		left += frames[i * 2] * c;
+		right += frames[i * 2 + 1] * c;
+	}
+}
+
+constexpr Kernels SCALAR_{sumScalar_, sumRampScalar_, sumMonoScalar_, applyGainScalar_,
+    clampScalar_, peakScalar_, decodeInt16Scalar_, decodeHalfScalar_, interpolateScalar_};
+
+/* -------------------------------------------------------------------------- */
+
+/* SIMD kernels process as many whole vectors as possible, then hand the 
+leftovers to the scalar ones. Vectors hold an even number of samples, so the
+left/right order is preserved. */
+
+#if defined(G_DSP_X86)
+
+void sumSSE2_(float* dest, const float* src, int samples, float gainL, float gainR)
+{
+	const __m128 g = _mm_setr_ps(gainL, gainR, gainL, gainR);
+
+	int i = 0;
+	for (; i + 4 <= samples; i += 4)
+		_mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+	sumScalar_(dest + i, src + i, samples - i, gainL, gainR);
+}
+
+void sumRampSSE2_(float* dest, const float* src, int frames, float gainL, float gainR,
+    float stepL, float stepR)
+{
+	const __m128 step = _mm_setr_ps(stepL * 2, stepR * 2, stepL * 2, stepR * 2);
+	__m128       g    = _mm_setr_ps(gainL, gainR, gainL + stepL, gainR + stepR);
+
+	int i = 0;
+	for (; i + 2 <= frames; i += 2, g = _mm_add_ps(g, step))
+		_mm_storeu_ps(dest + i * 2, _mm_add_ps(_mm_loadu_ps(dest + i * 2), _mm_mul_ps(_mm_loadu_ps(src + i * 2), g)));
+	sumRampScalar_(dest + i * 2, src + i * 2, frames - i, gainL + stepL * i, gainR + stepR * i, stepL, stepR);
+}
+
+void sumMonoSSE2_(float* dest, const float* src, int frames, float gainL, float gainR)
+{
+	const __m128 g = _mm_setr_ps(gainL, gainR, gainL, gainR);
+
+	int i = 0;
+	for (; i + 4 <= frames; i += 4)
+	{
+		const __m128 s  = _mm_loadu_ps(src + i);
+		const __m128 lo = _mm_unpacklo_ps(s, s); // s0 s0 s1 s1
+		const __m128 hi = _mm_unpackhi_ps(s, s); // s2 s2 s3 s3
+		float*       d  = dest + i * 2;
+		_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(lo, g)));
+		_mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(hi, g)));
+	}
+	sumMonoScalar_(dest + i * 2, src + i, frames - i, gainL, gainR);
+}
+
+void applyGainSSE2_(float* data, int samples, float gain)
+{
+	const __m128 g = _mm_set1_ps(gain);
+
+	int i = 0;
+	for (; i + 4 <= samples; i += 4)
+		_mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+	applyGainScalar_(data + i, samples - i, gain);
+}
+
+void clampSSE2_(float* data, int samples, float min, float max)
+{
+	const __m128 lo = _mm_set1_ps(min);
+	const __m128 hi = _mm_set1_ps(max);
+
+	int i = 0;
+	for (; i + 4 <= samples; i += 4)
+		_mm_storeu_ps(data + i, _mm_max_ps(lo, _mm_min_ps(_mm_loadu_ps(data + i), hi)));
+	clampScalar_(data + i, samples - i, min, max);
+}
+
+void peakSSE2_(const float* data, int frames, float& left, float& right)
+{
+	const __m128 abs = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	__m128 m = _mm_setzero_ps();
+	int    i = 0;
+	for (; i + 2 <= frames; i += 2)
+		m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(data + i * 2), abs));
+
+	alignas(16) float v[4];
+	_mm_store_ps(v, m);
+	left  = std::max({left, v[0], v[2]});
+	right = std::max({right, v[1], v[3]});
+	peakScalar_(data + i * 2, frames - i, left, right);
+}
+
+/* halfToFloatSSE2_
+Vector version of halfToFloat_(), on four halves zero-extended to 32 bits. */
+
+__m128 halfToFloatSSE2_(__m128i h)
+{
+	const __m128i bits  = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13);
+	const __m128i u     = _mm_add_epi32(bits, _mm_set1_epi32(HALF_REBIAS_));
+	const __m128i small = _mm_cmpeq_epi32(_mm_and_si128(bits, _mm_set1_epi32(HALF_EXP_MASK_)), _mm_setzero_si128());
+	const __m128  fixed = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(u, _mm_set1_epi32(HALF_IMPLICIT_1_))), _mm_set1_ps(HALF_MIN_));
+	const __m128  sign  = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+	const __m128  mask  = _mm_castsi128_ps(small);
+	return _mm_or_ps(_mm_or_ps(_mm_and_ps(mask, fixed), _mm_andnot_ps(mask, _mm_castsi128_ps(u))), sign);
+}
+
+void decodeInt16SSE2_(float* dest, const uint16_t* src, int samples)
+{
+	const __m128 scale = _mm_set1_ps(INT16_SCALE_);
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+	{
+		/* Sign extension: put each value in the upper half, shift it down. */
+
+		const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+	decodeInt16Scalar_(dest + i, src + i, samples - i);
+}
+
+void decodeHalfSSE2_(float* dest, const uint16_t* src, int samples)
+{
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm_storeu_ps(dest + i, halfToFloatSSE2_(_mm_unpacklo_epi16(v, _mm_setzero_si128())));
+		_mm_storeu_ps(dest + i + 4, halfToFloatSSE2_(_mm_unpackhi_epi16(v, _mm_setzero_si128())));
+	}
+	decodeHalfScalar_(dest + i, src + i, samples - i);
+}
+
+/* interpolateSSE2_
+Each vector of 4 coefficients is duplicated into [c0 c0 c1 c1] and [c2 c2 c3 c3],
+to match 4 interleaved stereo frames. Left and right sums are split across even
+and odd lanes until the very end. */
+
+void interpolateSSE2_(const float* frames, const float* a, const float* b, float t,
+    int taps, float& left, float& right)
+{
+	const __m128 tv = _mm_set1_ps(t);
+
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	for (int i = 0; i < taps; i += 4)
+	{
+		const __m128 av = _mm_loadu_ps(a + i);
+		const __m128 c  = _mm_add_ps(av, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), av), tv));
+		acc0            = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(frames + i * 2), _mm_unpacklo_ps(c, c)));
+		acc1            = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(frames + i * 2 + 4), _mm_unpackhi_ps(c, c)));
+	}
+	__m128 acc = _mm_add_ps(acc0, acc1);
+	acc        = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	left       = _mm_cvtss_f32(acc);
+	right      = _mm_cvtss_f32(_mm_shuffle_ps(acc, acc, 1));
+}
+
+constexpr Kernels SSE2_{sumSSE2_, sumRampSSE2_, sumMonoSSE2_, applyGainSSE2_, clampSSE2_,
+    peakSSE2_, decodeInt16SSE2_, decodeHalfSSE2_, interpolateSSE2_};
+
+/* -------------------------------------------------------------------------- */
+
+G_DSP_AVX2_TARGET void sumAVX2_(float* dest, const float* src, int samples, float gainL, float gainR)
+{
+	const __m256 g = _mm256_setr_ps(gainL, gainR, gainL, gainR, gainL, gainR, gainL, gainR);
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+		_mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+	sumScalar_(dest + i, src + i, samples - i, gainL, gainR);
+}
+
+G_DSP_AVX2_TARGET void sumRampAVX2_(float* dest, const float* src, int frames, float gainL,
+    float gainR, float stepL, float stepR)
+{
+	const __m256 step = _mm256_setr_ps(stepL * 4, stepR * 4, stepL * 4, stepR * 4, stepL * 4, stepR * 4, stepL * 4, stepR * 4);
+	__m256       g    = _mm256_setr_ps(gainL, gainR, gainL + stepL, gainR + stepR, gainL + stepL * 2,
+        gainR + stepR * 2, gainL + stepL * 3, gainR + stepR * 3);
+
+	int i = 0;
+	for (; i + 4 <= frames; i += 4, g = _mm256_add_ps(g, step))
+		_mm256_storeu_ps(dest + i * 2, _mm256_add_ps(_mm256_loadu_ps(dest + i * 2), _mm256_mul_ps(_mm256_loadu_ps(src + i * 2), g)));
+	sumRampScalar_(dest + i * 2, src + i * 2, frames - i, gainL + stepL * i, gainR + stepR * i, stepL, stepR);
+}
+
+G_DSP_AVX2_TARGET void sumMonoAVX2_(float* dest, const float* src, int frames, float gainL, float gainR)
+{
+	const __m256 g = _mm256_setr_ps(gainL, gainR, gainL, gainR, gainL, gainR, gainL, gainR);
+
+	int i = 0;
+	for (; i + 8 <= frames; i += 8)
+	{
+		/* Unpacking works within 128-bit lanes: put halves back in order. */
+
+		const __m256 s  = _mm256_loadu_ps(src + i);
+		const __m256 lo = _mm256_unpacklo_ps(s, s); // s0 s0 s1 s1 | s4 s4 s5 s5
+		const __m256 hi = _mm256_unpackhi_ps(s, s); // s2 s2 s3 s3 | s6 s6 s7 s7
+		float*       d  = dest + i * 2;
+		_mm256_storeu_ps(d, _mm256_add_ps(_mm256_loadu_ps(d), _mm256_mul_ps(_mm256_permute2f128_ps(lo, hi, 0x20), g)));
+		_mm256_storeu_ps(d + 8, _mm256_add_ps(_mm256_loadu_ps(d + 8), _mm256_mul_ps(_mm256_permute2f128_ps(lo, hi, 0x31), g)));
+	}
+	sumMonoScalar_(dest + i * 2, src + i, frames - i, gainL, gainR);
+}
+
+G_DSP_AVX2_TARGET void applyGainAVX2_(float* data, int samples, float gain)
+{
+	const __m256 g = _mm256_set1_ps(gain);
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+		_mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+	applyGainScalar_(data + i, samples - i, gain);
+}
+
+G_DSP_AVX2_TARGET void clampAVX2_(float* data, int samples, float min, float max)
+{
+	const __m256 lo = _mm256_set1_ps(min);
+	const __m256 hi = _mm256_set1_ps(max);
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+		_mm256_storeu_ps(data + i, _mm256_max_ps(lo, _mm256_min_ps(_mm256_loadu_ps(data + i), hi)));
+	clampScalar_(data + i, samples - i, min, max);
+}
+
+G_DSP_AVX2_TARGET void peakAVX2_(const float* data, int frames, float& left, float& right)
+{
+	const __m256 abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+	__m256 m = _mm256_setzero_ps();
+	int    i = 0;
+	for (; i + 4 <= frames; i += 4)
+		m = _mm256_max_ps(m, _mm256_and_ps(_mm256_loadu_ps(data + i * 2), abs));
+
+	alignas(32) float v[8];
+	_mm256_store_ps(v, m);
+	left  = std::max({left, v[0], v[2], v[4], v[6]});
+	right = std::max({right, v[1], v[3], v[5], v[7]});
+	peakScalar_(data + i * 2, frames - i, left, right);
+}
+
+G_DSP_AVX2_TARGET __m256 halfToFloatAVX2_(__m256i h)
+{
+	const __m256i bits  = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0x7FFF)), 13);
+	const __m256i u     = _mm256_add_epi32(bits, _mm256_set1_epi32(HALF_REBIAS_));
+	const __m256i small = _mm256_cmpeq_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(HALF_EXP_MASK_)), _mm256_setzero_si256());
+	const __m256  fixed = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_add_epi32(u, _mm256_set1_epi32(HALF_IMPLICIT_1_))), _mm256_set1_ps(HALF_MIN_));
+	const __m256  sign  = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0x8000)), 16));
+	return _mm256_or_ps(_mm256_blendv_ps(_mm256_castsi256_ps(u), fixed, _mm256_castsi256_ps(small)), sign);
+}
+
+G_DSP_AVX2_TARGET void decodeInt16AVX2_(float* dest, const uint16_t* src, int samples)
+{
+	const __m256 scale = _mm256_set1_ps(INT16_SCALE_);
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+	{
+		const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+		_mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+	}
+	decodeInt16Scalar_(dest + i, src + i, samples - i);
+}
+
+G_DSP_AVX2_TARGET void decodeHalfAVX2_(float* dest, const uint16_t* src, int samples)
+{
+	/* F16C would do this in one instruction, but it's not part of AVX2. */
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+	{
+		const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+		_mm256_storeu_ps(dest + i, halfToFloatAVX2_(v));
+	}
+	decodeHalfScalar_(dest + i, src + i, samples - i);
+}
+
+/* interpolateAVX2_
+Same as the SSE2 version, 8 taps at a time. In-lane unpacking yields pairs for
+taps 0-1, 4-5 and 2-3, 6-7: lanes are then rearranged to follow the frames. 
+A 4-tap leftover goes through 128-bit vectors. */
+
+G_DSP_AVX2_TARGET void interpolateAVX2_(const float* frames, const float* a, const float* b,
+    float t, int taps, float& left, float& right)
+{
+	const __m256 tv = _mm256_set1_ps(t);
+
+	__m256 acc = _mm256_setzero_ps();
+	int    i   = 0;
+	for (; i + 8 <= taps; i += 8)
+	{
+		const __m256 av = _mm256_loadu_ps(a + i);
+		const __m256 c  = _mm256_add_ps(av, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), av), tv));
+		const __m256 lo = _mm256_unpacklo_ps(c, c);
+		const __m256 hi = _mm256_unpackhi_ps(c, c);
+		acc             = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(frames + i * 2), _mm256_permute2f128_ps(lo, hi, 0x20)));
+		acc             = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(frames + i * 2 + 8), _mm256_permute2f128_ps(lo, hi, 0x31)));
+	}
+
+	__m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+	if (i < taps)
+	{
+		const __m128 av = _mm_loadu_ps(a + i);
+		const __m128 c  = _mm_add_ps(av, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), av), _mm_set1_ps(t)));
+		acc4            = _mm_add_ps(acc4, _mm_mul_ps(_mm_loadu_ps(frames + i * 2), _mm_unpacklo_ps(c, c)));
+		acc4            = _mm_add_ps(acc4, _mm_mul_ps(_mm_loadu_ps(frames + i * 2 + 4), _mm_unpackhi_ps(c, c)));
+	}
+	acc4  = _mm_add_ps(acc4, _mm_movehl_ps(acc4, acc4));
+	left  = _mm_cvtss_f32(acc4);
+	right = _mm_cvtss_f32(_mm_shuffle_ps(acc4, acc4, 1));
+}
+
+constexpr Kernels AVX2_{sumAVX2_, sumRampAVX2_, sumMonoAVX2_, applyGainAVX2_, clampAVX2_,
+    peakAVX2_, decodeInt16AVX2_, decodeHalfAVX2_, interpolateAVX2_};
+
+/* -------------------------------------------------------------------------- */
+
+bool hasAVX2_()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) // OS saves YMM registers
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#elif defined(G_DSP_NEON)
+
+void sumNEON_(float* dest, const float* src, int samples, float gainL, float gainR)
+{
+	const float       gains[4] = {gainL, gainR, gainL, gainR};
+	const float32x4_t g        = vld1q_f32(gains);
+
+	int i = 0;
+	for (; i + 4 <= samples; i += 4)
+		vst1q_f32(dest + i, vmlaq_f32(vld1q_f32(dest + i), vld1q_f32(src + i), g));
+	sumScalar_(dest + i, src + i, samples - i, gainL, gainR);
+}
+
+void sumRampNEON_(float* dest, const float* src, int frames, float gainL, float gainR,
+    float stepL, float stepR)
+{
+	const float gains[4] = {gainL, gainR, gainL + stepL, gainR + stepR};
+	const float steps[4] = {stepL * 2, stepR * 2, stepL * 2, stepR * 2};
+
+	const float32x4_t step = vld1q_f32(steps);
+	float32x4_t       g    = vld1q_f32(gains);
+
+	int i = 0;
+	for (; i + 2 <= frames; i += 2, g = vaddq_f32(g, step))
+		vst1q_f32(dest + i * 2, vmlaq_f32(vld1q_f32(dest + i * 2), vld1q_f32(src + i * 2), g));
+	sumRampScalar_(dest + i * 2, src + i * 2, frames - i, gainL + stepL * i, gainR + stepR * i, stepL, stepR);
+}
+
+void sumMonoNEON_(float* dest, const float* src, int frames, float gainL, float gainR)
+{
+	const float       gains[4] = {gainL, gainR, gainL, gainR};
+	const float32x4_t g        = vld1q_f32(gains);
+
+	int i = 0;
+	for (; i + 4 <= frames; i += 4)
+	{
+		const float32x4_t   s = vld1q_f32(src + i);
+		const float32x4x2_t z = vzipq_f32(s, s); // s0 s0 s1 s1, s2 s2 s3 s3
+		float*              d = dest + i * 2;
+		vst1q_f32(d, vmlaq_f32(vld1q_f32(d), z.val[0], g));
+		vst1q_f32(d + 4, vmlaq_f32(vld1q_f32(d + 4), z.val[1], g));
+	}
+	sumMonoScalar_(dest + i * 2, src + i, frames - i, gainL, gainR);
+}
+
+void applyGainNEON_(float* data, int samples, float gain)
+{
+	int i = 0;
+	for (; i + 4 <= samples; i += 4)
+		vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), gain));
+	applyGainScalar_(data + i, samples - i, gain);
+}
+
+void clampNEON_(float* data, int samples, float min, float max)
+{
+	const float32x4_t lo = vdupq_n_f32(min);
+	const float32x4_t hi = vdupq_n_f32(max);
+
+	int i = 0;
+	for (; i + 4 <= samples; i += 4)
+		vst1q_f32(data + i, vmaxq_f32(lo, vminq_f32(vld1q_f32(data + i), hi)));
+	clampScalar_(data + i, samples - i, min, max);
+}
+
+void peakNEON_(const float* data, int frames, float& left, float& right)
+{
+	float32x4_t m = vdupq_n_f32(0.0f);
+	int         i = 0;
+	for (; i + 2 <= frames; i += 2)
+		m = vmaxq_f32(m, vabsq_f32(vld1q_f32(data + i * 2)));
+
+	float v[4];
+	vst1q_f32(v, m);
+	left  = std::max({left, v[0], v[2]});
+	right = std::max({right, v[1], v[3]});
+	peakScalar_(data + i * 2, frames - i, left, right);
+}
+
+float32x4_t halfToFloatNEON_(uint32x4_t h)
+{
+	const uint32x4_t  bits  = vshlq_n_u32(vandq_u32(h, vdupq_n_u32(0x7FFF)), 13);
+	const uint32x4_t  u     = vaddq_u32(bits, vdupq_n_u32(HALF_REBIAS_));
+	const uint32x4_t  small = vceqq_u32(vandq_u32(bits, vdupq_n_u32(HALF_EXP_MASK_)), vdupq_n_u32(0));
+	const float32x4_t fixed = vsubq_f32(vreinterpretq_f32_u32(vaddq_u32(u, vdupq_n_u32(HALF_IMPLICIT_1_))), vdupq_n_f32(HALF_MIN_));
+	const uint32x4_t  sign  = vshlq_n_u32(vandq_u32(h, vdupq_n_u32(0x8000)), 16);
+	return vreinterpretq_f32_u32(vorrq_u32(vbslq_u32(small, vreinterpretq_u32_f32(fixed), u), sign));
+}
+
+void decodeInt16NEON_(float* dest, const uint16_t* src, int samples)
+{
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+	{
+		const int16x8_t v = vreinterpretq_s16_u16(vld1q_u16(src + i));
+		vst1q_f32(dest + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), INT16_SCALE_));
+		vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), INT16_SCALE_));
+	}
+	decodeInt16Scalar_(dest + i, src + i, samples - i);
+}
+
+void decodeHalfNEON_(float* dest, const uint16_t* src, int samples)
+{
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+	{
+		const uint16x8_t v = vld1q_u16(src + i);
+		vst1q_f32(dest + i, halfToFloatNEON_(vmovl_u16(vget_low_u16(v))));
+		vst1q_f32(dest + i + 4, halfToFloatNEON_(vmovl_u16(vget_high_u16(v))));
+	}
+	decodeHalfScalar_(dest + i, src + i, samples - i);
+}
+
+void interpolateNEON_(const float* frames, const float* a, const float* b, float t,
+    int taps, float& left, float& right)
+{
+	float32x4_t acc = vdupq_n_f32(0.0f);
+	for (int i = 0; i < taps; i += 4)
+	{
+		const float32x4_t   av = vld1q_f32(a + i);
+		const float32x4_t   c  = vmlaq_n_f32(av, vsubq_f32(vld1q_f32(b + i), av), t);
+		const float32x4x2_t cc = vzipq_f32(c, c);
+		acc                    = vmlaq_f32(acc, vld1q_f32(frames + i * 2), cc.val[0]);
+		acc                    = vmlaq_f32(acc, vld1q_f32(frames + i * 2 + 4), cc.val[1]);
+	}
+	float v[4];
+	vst1q_f32(v, acc);
+	left  = v[0] + v[2];
+	right = v[1] + v[3];
+}
+
+constexpr Kernels NEON_{sumNEON_, sumRampNEON_, sumMonoNEON_, applyGainNEON_, clampNEON_,
+    peakNEON_, decodeInt16NEON_, decodeHalfNEON_, interpolateNEON_};
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+/* kernels_, isa_
+Kernels in use. Selected once at startup, before the audio thread kicks in. */
+
+const Kernels* kernels_ = &SCALAR_;
+Isa            isa_     = Isa::SCALAR;
+
+/* -------------------------------------------------------------------------- */
+
+const Kernels* getKernels_(Isa isa)
+{
+	switch (isa)
+	{
+#if defined(G_DSP_X86)
+	case Isa::SSE2:
+		return &SSE2_;
+	case Isa::AVX2:
+		return &AVX2_;
+#elif defined(G_DSP_NEON)
+	case Isa::NEON:
+		return &NEON_;
+#endif
+	default:
+		return &SCALAR_;
+	}
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void init()
+{
+	for (Isa isa : {Isa::AVX2, Isa::SSE2, Isa::NEON, Isa::SCALAR})
+		if (setIsa(isa))
+			break;
+	u::log::print("[dsp::init] using %s kernels\n", toString(isa_));
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool setIsa(Isa isa)
+{
+	if (!isSupported(isa))
+		return false;
+	kernels_ = getKernels_(isa);
+	isa_     = isa;
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Isa getIsa() { return isa_; }
+
+/* -------------------------------------------------------------------------- */
+
+bool isSupported(Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::SCALAR:
+		return true;
+#if defined(G_DSP_X86)
+	case Isa::SSE2:
+		return true;
+	case Isa::AVX2:
+		return hasAVX2_();
+#elif defined(G_DSP_NEON)
+	case Isa::NEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+const char* toString(Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::SSE2:
+		return "SSE2";
+	case Isa::AVX2:
+		return "AVX2";
+	case Isa::NEON:
+		return "NEON";
+	default:
+		return "scalar";
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void sum(mcl::AudioBuffer& dest, const mcl::AudioBuffer& src, float gain, mcl::AudioBuffer::Pan pan)
+{
+	const int frames = std::min(dest.countFrames(), src.countFrames());
+
+	if (dest.countChannels() == 2 && src.countChannels() == 2)
+		kernels_->sum(dest[0], src[0], frames * 2, gain * pan[0], gain * pan[1]);
+	else if (dest.countChannels() == 2 && src.countChannels() == 1)
+		kernels_->sumMono(dest[0], src[0], frames, gain * pan[0], gain * pan[1]);
+	else
+		dest.sum(src, gain, pan);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void sumRamp(mcl::AudioBuffer& dest, const mcl::AudioBuffer& src, Frame frames,
+    mcl::AudioBuffer::Pan from, mcl::AudioBuffer::Pan to)
+{
+	const int total = std::min(dest.countFrames(), src.countFrames());
+
+	frames = std::min(frames, total);
+	if (frames == 0)
+	{
+		sum(dest, src, 1.0f, to);
+		return;
+	}
+
+	const float stepL = (to[0] - from[0]) / frames;
+	const float stepR = (to[1] - from[1]) / frames;
+
+	if (dest.countChannels() == 2 && src.countChannels() == 2)
+	{
+		kernels_->sumRamp(dest[0], src[0], frames, from[0], from[1], stepL, stepR);
+		if (frames < total) // Ramps as long as the buffer leave nothing to sum
+			kernels_->sum(dest[frames], src[frames], (total - frames) * 2, to[0], to[1]);
+		return;
+	}
+
+	/* Unusual layouts, no need for speed. */
+
+	for (Frame i = 0; i < total; i++)
+	{
+		const Frame t = std::min(i, frames);
+		for (int j = 0; j < std::min(dest.countChannels(), 2); j++)
+		{
+			const float gain = j == 0 ? from[0] + stepL * t : from[1] + stepR * t;
+			dest[i][j] += src[i][std::min(j, src.countChannels() - 1)] * gain;
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void sumMono(mcl::AudioBuffer& dest, const float* src, Frame offset, Frame count, float gain)
+{
+	assert(offset + count <= dest.countFrames());
+
+	if (dest.countChannels() == 2)
+	{
+		kernels_->sumMono(dest[offset], src, count, gain, gain);
+		return;
+	}
+	for (Frame i = 0; i < count; i++)
+		for (int j = 0; j < dest.countChannels(); j++)
+			dest[offset + i][j] += src[i] * gain;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void applyGain(mcl::AudioBuffer& b, float gain)
+{
+	kernels_->applyGain(b[0], b.countFrames() * b.countChannels(), gain);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void clamp(mcl::AudioBuffer& b, float min, float max)
+{
+	kernels_->clamp(b[0], b.countFrames() * b.countChannels(), min, max);
+}
+
+/* -------------------------------------------------------------------------- */
+
+Peak getPeak(const mcl::AudioBuffer& b)
+{
+	Peak peak{0.0f, 0.0f};
+	if (b.countChannels() == 2)
+		kernels_->peak(b[0], b.countFrames(), peak.left, peak.right);
+	else if (b.countChannels() == 1)
+	{
+		peak.left  = b.getPeak(0);
+		peak.right = peak.left;
+	}
+	else
+	{
+		peak.left  = b.getPeak(0);
+		peak.right = b.getPeak(1);
+	}
+	return peak;
+}
+/* -------------------------------------------------------------------------- */
+
+void decode(float* dest, const uint16_t* src, int samples, SampleFormat format)
+{
+	assert(format != SampleFormat::FLOAT);
+
+	if (format == SampleFormat::INT16)
+		kernels_->decodeInt16(dest, src, samples);
+	else
+		kernels_->decodeHalf(dest, src, samples);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool encode(uint16_t* dest, const float* src, int samples, SampleFormat format)
+{
+	assert(format != SampleFormat::FLOAT);
+
+	if (format == SampleFormat::HALF)
+	{
+		for (int i = 0; i < samples; i++)
+			dest[i] = floatToHalf_(src[i]);
+		return true;
+	}
+
+	for (int i = 0; i < samples; i++)
+	{
+		const float v = src[i] * 32768.0f;
+		if (v < -32768.0f || v > 32767.0f || v != std::trunc(v))
+			return false;
+		dest[i] = static_cast<uint16_t>(static_cast<int16_t>(v));
+	}
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void interpolate(const float* frames, const float* a, const float* b, float t,
+    int taps, float& left, float& right)
+{
+	assert(taps % 4 == 0);
+
+	kernels_->interpolate(frames, a, b, t, taps, left, right);
+}
+} // namespace giada::m::dsp
@@ -0,0 +1,121 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_DSP_H
+#define G_DSP_H
+
+#include "core/types.h"
+#include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
+#include <cstdint>
+
+namespace giada::m::dsp
+{
+/* Isa
+Instruction sets kernels are available for. */
+
+enum class Isa
+{
+	SCALAR,
+	SSE2,
+	AVX2,
+	NEON
+};
+
+/* init
+Selects the fastest kernels supported by the running CPU. Until then, plain
+scalar kernels are used. */
+
+void init();
+
+/* setIsa
+Forces kernels for instruction set 'isa'. Returns false and leaves things as 
+they are if the CPU doesn't support it. Not thread-safe: don't call it while
+the audio thread is running. */
+
+bool setIsa(Isa isa);
+
+Isa         getIsa();
+bool        isSupported(Isa isa);
+const char* toString(Isa isa);
+
+/* sum
+Adds 'src' to 'dest', multiplied by 'gain' and 'pan'. A mono source is summed
+into all channels of 'dest'. */
+
+void sum(mcl::AudioBuffer& dest, const mcl::AudioBuffer& src, float gain = 1.0f,
+    mcl::AudioBuffer::Pan pan = {1.0f, 1.0f});
+
+/* sumRamp
+Like sum(), but gains glide linearly from 'from' to 'to' over the first 
+'frames' frames, then stay at 'to' until the end of the buffer. */
+
+void sumRamp(mcl::AudioBuffer& dest, const mcl::AudioBuffer& src, Frame frames,
+    mcl::AudioBuffer::Pan from, mcl::AudioBuffer::Pan to);
+
+/* sumMono
+Adds 'count' samples from mono array 'src' to all channels of 'dest', starting
+from frame 'offset'. */
+
+void sumMono(mcl::AudioBuffer& dest, const float* src, Frame offset, Frame count,
+    float gain = 1.0f);
+
+void applyGain(mcl::AudioBuffer& b, float gain);
+
+/* clamp
+Limits all samples to the [min, max] range. */
+
+void clamp(mcl::AudioBuffer& b, float min, float max);
+
+/* getPeak
+Returns the highest absolute value of the left and right channels in a single 
+pass. The right peak of a mono buffer is the left one. */
+
+Peak getPeak(const mcl::AudioBuffer& b);
+
+/* decode
+Converts 'samples' samples stored in the 16-bit 'format' from 'src' to floats 
+into 'dest'. */
+
+void decode(float* dest, const uint16_t* src, int samples, SampleFormat format);
+
+/* encode
+Converts 'samples' floats from 'src' to the 16-bit 'format' into 'dest'. Half 
+floats are rounded to nearest and clamped to their finite range. Integers are 
+meant to be lossless: returns false if any sample doesn't fit 16 bits exactly.
+Not realtime-safe. */
+
+bool encode(uint16_t* dest, const float* src, int samples, SampleFormat format);
+
+/* interpolate
+Computes one stereo frame as the weighted sum of 'taps' interleaved stereo 
+frames from 'frames'. Weights are blended from coefficients 'a' to 'b' by 't' in
+[0, 1]. 'taps' must be a multiple of 4. Used by the native resampler. */
+
+void interpolate(const float* frames, const float* a, const float* b, float t,
+    int taps, float& left, float& right);
+} // namespace giada::m::dsp
+
+#endif
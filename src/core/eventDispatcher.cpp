@@ -32,7 +32,10 @@
 #include "core/sequencer.h"
 #include "core/worker.h"
 #include "utils/log.h"
+#include <algorithm>
 #include <functional>
+#include <utility>
+#include <vector>
 
 namespace giada::m::eventDispatcher
 {
@@ -40,12 +43,39 @@ namespace
 {
 Worker worker_;
 
+/* latency_
+Push-to-process latency histogram. Written by the dispatcher thread only. */
+
+std::array<std::atomic<uint64_t>, G_EVENT_DISPATCHER_LATENCY_BUCKETS> latency_;
+
 /* eventBuffer_
 Buffer of events sent to channels for event parsing. This is filled with Events
 coming from the two event queues.*/
 
 EventBuffer eventBuffer_;
 
+/* unsynced_
+Channels whose volume, pan or pitch have been changed by events that didn't 
+touch the Layout, which still holds the old values. See processChannels_(). */
+
+std::vector<ID> unsynced_;
+
+/* -------------------------------------------------------------------------- */
+
+void recordLatency_(const Event& e, std::chrono::steady_clock::time_point now)
+{
+	using namespace std::chrono;
+
+	const auto us = duration_cast<microseconds>(now - e.timestamp).count();
+
+	std::size_t bucket = 0;
+	while (bucket < latency_.size() - 1 && (1LL << (bucket + 1)) <= us)
+		bucket++;
+
+	latency_[bucket].store(latency_[bucket].load(std::memory_order_relaxed) + 1,
+	    std::memory_order_relaxed);
+}
+
 /* -------------------------------------------------------------------------- */
 
 void processFuntions_()
@@ -59,7 +89,7 @@ void processFuntions_()
 			break;
 
 		case EventType::MIDI_DISPATCHER_PROCESS:
-			midiDispatcher::process(std::get<Action>(e.data).event);
+			midiDispatcher::process(std::get<Action>(e.data).event, e.timestamp);
 			break;
 
 		case EventType::MIXER_SIGNAL_CALLBACK:
@@ -70,6 +100,10 @@ void processFuntions_()
 			mixer::execEndOfRecCb();
 			break;
 
+		case EventType::SEQUENCER_BPM:
+			clock::setBpm(std::get<float>(e.data));
+			break;
+
 		default:
 			break;
 		}
@@ -78,10 +112,82 @@ void processFuntions_()
 
 /* -------------------------------------------------------------------------- */
 
+/* isRamp_
+True if the event only moves a smoothed channel parameter, see 
+channel::reactRamps(). */
+
+bool isRamp_(const Event& e)
+{
+	return e.type == EventType::CHANNEL_VOLUME ||
+	       e.type == EventType::CHANNEL_PAN ||
+	       e.type == EventType::CHANNEL_PITCH;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* isTarget_
+True if channel 'channelId' is addressed by at least one event in the buffer
+other than ramp ones. Events with channelId == 0 are broadcast to all 
+channels. */
+
+bool isTarget_(ID channelId)
+{
+	for (const Event& e : eventBuffer_)
+		if ((e.channelId == 0 || e.channelId == channelId) && !isRamp_(e))
+			return true;
+	return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool isUnsynced_(ID channelId)
+{
+	return std::find(unsynced_.begin(), unsynced_.end(), channelId) != unsynced_.end();
+}
+
+/* -------------------------------------------------------------------------- */
+
 void processChannels_()
 {
-	for (channel::Data& ch : model::get().channels)
+	/* Volume, pan and pitch events only set new targets in the shared channel
+	State, which the audio thread glides to: a knob sweep doesn't need a swap
+	per event. Values in the Layout are synced once events are over, see 
+	syncRamps_(). Access channels for writing only if they are targeted by 
+	some other event: untouched channels won't be copied by the next swap. */
+
+	model::ChannelTable& channels = model::get().channels;
+	for (std::size_t i = 0; i < channels.size(); i++)
+	{
+		const channel::Data& c = std::as_const(channels)[i];
+		if (channel::reactRamps(c, eventBuffer_) && !isUnsynced_(c.id))
+			unsynced_.push_back(c.id);
+		if (!isTarget_(c.id))
+			continue;
+		channel::Data& ch = channels[i];
 		channel::react(ch, eventBuffer_, mixer::isChannelAudible(ch));
+	}
+
+	if (!std::all_of(eventBuffer_.begin(), eventBuffer_.end(), isRamp_))
+		model::swap(model::SwapType::SOFT);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* syncRamps_
+Copies targets of volume, pan and pitch into the Layout for channels left 
+behind by processChannels_(). */
+
+void syncRamps_()
+{
+	if (unsynced_.empty())
+		return;
+
+	model::ChannelTable& channels = model::get().channels;
+	for (std::size_t i = 0; i < channels.size(); i++)
+		if (isUnsynced_(std::as_const(channels)[i].id))
+			channel::syncRamps(channels[i]);
+
+	unsynced_.clear();
 	model::swap(model::SwapType::SOFT);
 }
 
@@ -105,7 +211,14 @@ void process_()
 		eventBuffer_.push_back(e);
 
 	if (eventBuffer_.size() == 0)
+	{
+		syncRamps_();
 		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	for (const Event& e : eventBuffer_)
+		recordLatency_(e, now);
 
 	processFuntions_();
 	processChannels_();
@@ -124,11 +237,52 @@ Queue<Event, G_MAX_DISPATCHER_EVENTS> MidiEvents;
 
 void init()
 {
-	worker_.start(process_, /*sleep=*/G_EVENT_DISPATCHER_RATE_MS);
+	worker_.startOnNotify(process_, /*timeout=*/G_EVENT_DISPATCHER_TIMEOUT_MS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void close()
+{
+	worker_.stop();
 }
 
 /* -------------------------------------------------------------------------- */
 
-void pumpUIevent(Event e) { UIevents.push(e); }
-void pumpMidiEvent(Event e) { MidiEvents.push(e); }
+void process()
+{
+	process_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool pumpUIevent(Event e)
+{
+	if (e.timestamp == Timestamp{})
+		e.timestamp = std::chrono::steady_clock::now();
+	if (!UIevents.push(e))
+		return false;
+	worker_.notify();
+	return true;
+}
+
+bool pumpMidiEvent(Event e)
+{
+	if (e.timestamp == Timestamp{})
+		e.timestamp = std::chrono::steady_clock::now();
+	if (!MidiEvents.push(e))
+		return false;
+	worker_.notify();
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+LatencyHistogram getLatency()
+{
+	LatencyHistogram out;
+	for (std::size_t i = 0; i < latency_.size(); i++)
+		out[i] = latency_[i].load(std::memory_order_relaxed);
+	return out;
+}
 } // namespace giada::m::eventDispatcher
\ No newline at end of file
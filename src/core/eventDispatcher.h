@@ -32,7 +32,10 @@
 #include "core/queue.h"
 #include "core/ringBuffer.h"
 #include "core/types.h"
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <thread>
 #include <variant>
@@ -52,6 +55,7 @@ enum class EventType
 	SEQUENCER_START,
 	SEQUENCER_STOP,
 	SEQUENCER_REWIND,
+	SEQUENCER_BPM,
 	MIDI,
 	MIDI_DISPATCHER_LEARN,
 	MIDI_DISPATCHER_PROCESS,
@@ -75,6 +79,14 @@ struct Event
 	Frame     delta     = 0;
 	ID        channelId = 0;
 	EventData data      = {};
+
+	/* timestamp
+	When the event has been generated. Live MIDI events carry the time they 
+	were received by the MIDI device, everything else gets stamped by 
+	pumpUIevent() and pumpMidiEvent(). Used to measure the dispatching latency
+	and to play live events at the right frame (see mixer::LiveEvent). */
+
+	Timestamp timestamp = {};
 };
 
 /* EventBuffer
@@ -92,10 +104,45 @@ TODO - let's add a multi-producer queue sooner or later! */
 extern Queue<Event, G_MAX_DISPATCHER_EVENTS> UIevents;
 extern Queue<Event, G_MAX_DISPATCHER_EVENTS> MidiEvents;
 
+/* LatencyHistogram
+Push-to-process latency of dispatched events. Bucket 'i' counts the events
+processed within [2^i, 2^(i+1)) microseconds from being pushed (bucket 0 also 
+includes anything below 1 us, the last one anything above). */
+
+using LatencyHistogram = std::array<uint64_t, G_EVENT_DISPATCHER_LATENCY_BUCKETS>;
+
+/* init
+Starts the dispatcher thread. It sleeps until an event is pushed in one of the
+queues through the pump functions below. */
+
 void init();
 
-void pumpUIevent(Event e);
-void pumpMidiEvent(Event e);
+/* close
+Stops the dispatcher thread. Events pushed afterwards wait in the queues until
+process() is called or the thread is restarted with init(). */
+
+void close();
+
+/* process
+Processes pending events on the calling thread. Used by the offline renderer,
+which stops the dispatcher thread and drives it block by block, in step with
+its own clock. */
+
+void process();
+
+/* pumpUIevent, pumpMidiEvent
+Push an event into the UI/MIDI queue and wake up the dispatcher. The event is
+stamped with the current time, unless it carries a timestamp already. Lock-free,
+safe to call from the audio thread and the RtMidi callback. Return false if the
+queue is full. */
+
+bool pumpUIevent(Event e);
+bool pumpMidiEvent(Event e);
+
+/* getLatency
+Returns a snapshot of the latency histogram collected so far. */
+
+LatencyHistogram getLatency();
 } // namespace giada::m::eventDispatcher
 
 #endif
@@ -25,6 +25,8 @@
  * -------------------------------------------------------------------------- */
 
 #include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
 #include <thread>
 #ifdef __APPLE__
@@ -37,14 +39,17 @@
 #include "core/clock.h"
 #include "core/conf.h"
 #include "core/const.h"
+#include "core/dsp.h"
 #include "core/eventDispatcher.h"
 #include "core/kernelAudio.h"
 #include "core/kernelMidi.h"
 #include "core/midiMapConf.h"
+#include "core/midiScheduler.h"
 #include "core/mixer.h"
 #include "core/mixerHandler.h"
 #include "core/model/model.h"
 #include "core/model/storage.h"
+#include "core/offlineRenderer.h"
 #include "core/patch.h"
 #include "core/plugins/pluginHost.h"
 #include "core/plugins/pluginManager.h"
@@ -54,7 +59,9 @@
 #include "core/sequencer.h"
 #include "core/sync.h"
 #include "core/wave.h"
+#include "core/waveCache.h"
 #include "core/waveManager.h"
+#include "core/waveStreamer.h"
 #include "deps/json/single_include/nlohmann/json.hpp"
 #include "glue/main.h"
 #include "gui/dialogs/mainWindow.h"
@@ -96,15 +103,20 @@ void initConf_()
 
 void initSystem_()
 {
+	dsp::init();
 	model::init();
 	eventDispatcher::init();
+	waveStreamer::init();
+	midiScheduler::init();
+
+	if (conf::conf.waveCache)
+		waveCache::init(u::fs::getHomePath() + G_SLASH + "cache", conf::conf.waveCacheSize);
 }
 
 /* -------------------------------------------------------------------------- */
 
-void initAudio_()
+void initEngine_()
 {
-	kernelAudio::openDevice(conf::conf);
 	clock::init();
 	sync::init(conf::conf.samplerate, conf::conf.midiTCfps);
 	mh::init();
@@ -118,6 +130,14 @@ void initAudio_()
 	pluginHost::init(kernelAudio::getRealBufSize());
 
 #endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+void initAudio_()
+{
+	kernelAudio::openDevice(conf::conf);
+	initEngine_();
 
 	if (!kernelAudio::isReady())
 		return;
@@ -173,6 +193,9 @@ void shutdownAudio_()
 		u::log::print("[init] Mixer closed\n");
 	}
 
+	midiScheduler::close();
+	u::log::print("[init] MIDI scheduler closed\n");
+
 	/* TODO - why cleaning plug-ins and mixer memory? Just shutdown the audio
 	device and let the OS take care of the rest. */
 
@@ -186,6 +209,20 @@ void shutdownAudio_()
 
 /* -------------------------------------------------------------------------- */
 
+void shutdownStreaming_()
+{
+	/* Streamed Waves unregister themselves from the streamer when destroyed:
+	get rid of them while the streamer is still around. */
+
+	model::clear<model::WavePtrs>();
+	model::swap(model::SwapType::NONE);
+
+	waveStreamer::close();
+	u::log::print("[init] Wave streamer closed\n");
+}
+
+/* -------------------------------------------------------------------------- */
+
 void shutdownGUI_()
 {
 	u::gui::closeAllSubwindows();
@@ -195,6 +232,77 @@ void shutdownGUI_()
 
 /* -------------------------------------------------------------------------- */
 
+/* loadProject_
+Headless version of the project loading done by the UI: reads the patch in 
+'path' (a .gprj folder) and fills the model with it. */
+
+bool loadProject_(const std::string& path)
+{
+	const std::string fileToLoad = path + G_SLASH + u::fs::stripExt(u::fs::basename(path)) + ".gptc";
+	const std::string basePath   = path + G_SLASH;
+
+	patch::init();
+	if (patch::read(fileToLoad, basePath) != G_PATCH_OK)
+		return false;
+
+	model::load(patch::patch, nullptr);
+
+	mh::updateSoloCount();
+	recorderHandler::updateSamplerate(conf::conf.samplerate, patch::patch.samplerate);
+	clock::recomputeFrames();
+	mixer::allocRecBuffer(clock::getMaxFramesInLoop());
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* parseRenderArgs_
+Reads '--render <project> [--out <dir>] [--loops N] [--bars N] [--stems]' from
+the command line. Returns an empty project path on malformed input. */
+
+std::string parseRenderArgs_(int argc, char** argv, offlineRenderer::Config& c)
+{
+	std::string project;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg  = argv[i];
+		const bool        more = i + 1 < argc;
+
+		if (arg == "--render" && more)
+			project = argv[++i];
+		else if (arg == "--out" && more)
+			c.path = argv[++i];
+		else if (arg == "--loops" && more)
+			c.loops = std::atoi(argv[++i]);
+		else if (arg == "--bars" && more)
+			c.bars = std::atoi(argv[++i]);
+		else if (arg == "--stems")
+			c.stems = true;
+		else
+			return "";
+	}
+
+	if (c.path.empty())
+		c.path = u::fs::stripExt(project) + "-render";
+
+	return project;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void printEventLatency_()
+{
+	const eventDispatcher::LatencyHistogram h = eventDispatcher::getLatency();
+
+	u::log::print("[init] Event dispatcher latency (push to process):\n");
+	for (std::size_t i = 0; i < h.size(); i++)
+		if (h[i] > 0)
+			u::log::print("[init]   >= %8lld us: %llu\n", 1LL << i, (unsigned long long)h[i]);
+}
+
+/* -------------------------------------------------------------------------- */
+
 void printBuildInfo_()
 {
 	u::log::print("[init] Giada %s\n", G_VERSION_STR);
@@ -236,6 +344,61 @@ void startup(int argc, char** argv)
 
 /* -------------------------------------------------------------------------- */
 
+int render(int argc, char** argv)
+{
+	offlineRenderer::Config c;
+	const std::string       project = parseRenderArgs_(argc, argv, c);
+
+	if (project.empty())
+	{
+		std::fprintf(stderr, "Usage: giada --render <project.gprj> [--out <dir>] "
+		                     "[--loops N] [--bars N] [--stems]\n");
+		return 1;
+	}
+
+	printBuildInfo_();
+
+	initConf_();
+	initSystem_();
+	kernelAudio::openOffline(conf::conf);
+	initEngine_();
+
+	int ret = 0;
+
+	if (!loadProject_(project))
+	{
+		std::fprintf(stderr, "Unable to load project %s\n", project.c_str());
+		ret = 1;
+	}
+	else if (!offlineRenderer::render(c, [percent = -1](float p) mutable {
+		         if (static_cast<int>(p * 100) == percent)
+			         return;
+		         percent = static_cast<int>(p * 100);
+		         std::fprintf(stderr, "\rRendering... %3d%%", percent);
+	         }))
+	{
+		std::fprintf(stderr, "\nUnable to render to %s\n", c.path.c_str());
+		ret = 1;
+	}
+	else
+		std::fprintf(stderr, "\nRendered to %s\n", c.path.c_str());
+
+	mh::close();
+	midiScheduler::close();
+#ifdef WITH_VST
+	pluginHost::close();
+#endif
+	eventDispatcher::close();
+	shutdownStreaming_();
+
+	u::log::print("[init] Giada %s closed\n\n", G_VERSION_STR);
+	u::log::close();
+
+	return ret;
+}
+
+/* -------------------------------------------------------------------------- */
+
 void closeMainWindow()
 {
 	if (!v::gdConfirmWin("Warning", "Quit Giada: are you sure?"))
@@ -288,6 +451,8 @@ void shutdown()
 		u::log::print("[init] configuration saved\n");
 
 	shutdownAudio_();
+	shutdownStreaming_();
+	printEventLatency_();
 
 	u::log::print("[init] Giada %s closed\n\n", G_VERSION_STR);
 	u::log::close();
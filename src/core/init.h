@@ -30,6 +30,13 @@
 namespace giada::m::init
 {
 void startup(int argc, char** argv);
+
+/* render
+Headless entry point: loads the project given on the command line and bounces
+it to disk with the offline renderer, without sound card nor UI. Returns the 
+process exit code. */
+
+int render(int argc, char** argv);
 void reset();
 void closeMainWindow();
 void shutdown();
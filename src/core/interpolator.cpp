@@ -0,0 +1,266 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/interpolator.h"
+#include "core/dsp.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace giada::m
+{
+namespace
+{
+static_assert(G_MAX_IO_CHANS == 2, "Interpolator works on stereo frames only");
+static_assert(G_MAX_PITCH <= 4.0f, "Not enough polyphase bands for G_MAX_PITCH");
+
+/* PHASES_, BANDS_PER_OCTAVE_, BANDS_
+Polyphase tables store PHASES_ + 1 sets of coefficients per band, the extra one
+closing the last interval for blending. Band b serves ratios up to
+2^(b / BANDS_PER_OCTAVE_), its cutoff lowered accordingly. Band 0 covers ratios
+up to 1.0 and leaves the full bandwidth untouched. */
+
+constexpr int PHASES_           = 256;
+constexpr int BANDS_PER_OCTAVE_ = 4;
+constexpr int BANDS_            = 2 * BANDS_PER_OCTAVE_ + 1; // Two octaves up, see G_MAX_PITCH
+
+constexpr double PI_ = 3.14159265358979323846;
+
+/* -------------------------------------------------------------------------- */
+
+struct Table
+{
+	const float* get(int band, int phase) const
+	{
+		return data.data() + (band * (PHASES_ + 1) + phase) * taps;
+	}
+
+	int                taps;
+	std::vector<float> data;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* bessel0_
+Modified Bessel function of the first kind, order zero. */
+
+double bessel0_(double x)
+{
+	double sum  = 1.0;
+	double term = 1.0;
+	for (int k = 1; term > sum * 1e-12; k++)
+	{
+		const double f = x / (2.0 * k);
+		term *= f * f;
+		sum += term;
+	}
+	return sum;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* makeTable_
+Kaiser-windowed sinc filters, 'taps' long. Coefficient k of phase p weighs the
+window frame at distance k - (taps / 2 - 1) - p / PHASES_ from the output one.
+Each set is normalized to unity gain, so that DC doesn't ripple across 
+phases. */
+
+Table makeTable_(int taps, double beta)
+{
+	Table table{taps, std::vector<float>(BANDS_ * (PHASES_ + 1) * taps)};
+
+	const double half = taps / 2.0;
+	const double norm = bessel0_(beta);
+
+	for (int band = 0; band < BANDS_; band++)
+	{
+		const double cutoff = std::pow(2.0, -band / static_cast<double>(BANDS_PER_OCTAVE_));
+
+		for (int phase = 0; phase <= PHASES_; phase++)
+		{
+			float* c   = table.data.data() + (band * (PHASES_ + 1) + phase) * taps;
+			double sum = 0.0;
+
+			for (int k = 0; k < taps; k++)
+			{
+				const double d = k - (half - 1.0) - phase / static_cast<double>(PHASES_);
+				const double x = d / half;
+				const double w = std::abs(x) < 1.0 ? bessel0_(beta * std::sqrt(1.0 - x * x)) / norm : 0.0;
+				const double s = d == 0.0 ? 1.0 : std::sin(PI_ * cutoff * d) / (PI_ * cutoff * d);
+				c[k]           = static_cast<float>(s * w);
+				sum += c[k];
+			}
+			for (int k = 0; k < taps; k++)
+				c[k] = static_cast<float>(c[k] / sum);
+		}
+	}
+	return table;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* fast_, best_
+Tables are built once at startup, never while rendering. */
+
+const Table fast_ = makeTable_(8, 6.0);
+const Table best_ = makeTable_(32, 9.0);
+
+/* -------------------------------------------------------------------------- */
+
+int getBand_(float ratio)
+{
+	if (ratio <= 1.0f)
+		return 0;
+	const int band = static_cast<int>(std::ceil(std::log2(ratio) * BANDS_PER_OCTAVE_));
+	return std::min(band, BANDS_ - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* cubic_
+Catmull-Rom coefficients for the 4 frames around position 't', between the 
+second and the third one. */
+
+std::array<float, 4> cubic_(float t)
+{
+	const float t2 = t * t;
+	const float t3 = t2 * t;
+	return {
+	    -0.5f * t3 + t2 - 0.5f * t,
+	    1.5f * t3 - 2.5f * t2 + 1.0f,
+	    -1.5f * t3 + 2.0f * t2 + 0.5f * t,
+	    0.5f * t3 - 0.5f * t2};
+}
+
+/* -------------------------------------------------------------------------- */
+
+int getTaps_(Interpolator::Type type)
+{
+	switch (type)
+	{
+	case Interpolator::Type::POLYPHASE_FAST:
+		return fast_.taps;
+	case Interpolator::Type::POLYPHASE_BEST:
+		return best_.taps;
+	default:
+		return 4;
+	}
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+Interpolator::Interpolator(Type type)
+: m_type(type)
+, m_taps(getTaps_(type))
+{
+	assert(m_taps <= MAX_TAPS);
+	reset();
+}
+
+/* -------------------------------------------------------------------------- */
+
+Interpolator::Result Interpolator::process(const float* input, long inputLength,
+    float* output, long outputLength, float ratio)
+{
+	const Table& table = m_type == Type::POLYPHASE_BEST ? best_ : fast_;
+	const int    band  = getBand_(ratio);
+
+	/* State is kept in locals while looping, so that writing to 'output' 
+	doesn't force the compiler to reload it on each frame. */
+
+	double phase     = m_phase;
+	long   used      = 0;
+	long   generated = 0;
+	while (generated < outputLength)
+	{
+		for (; phase >= 1.0; phase -= 1.0)
+		{
+			if (used == inputLength)
+			{
+				m_phase = phase;
+				return {used, generated};
+			}
+			push_(input + used * G_MAX_IO_CHANS);
+			used++;
+		}
+
+		const float* frames = m_window.data() + m_write * G_MAX_IO_CHANS;
+		float*       out    = output + generated * G_MAX_IO_CHANS;
+
+		if (m_type == Type::CUBIC)
+		{
+			const std::array<float, 4> c = cubic_(static_cast<float>(phase));
+			out[0]                       = frames[0] * c[0] + frames[2] * c[1] + frames[4] * c[2] + frames[6] * c[3];
+			out[1]                       = frames[1] * c[0] + frames[3] * c[1] + frames[5] * c[2] + frames[7] * c[3];
+		}
+		else
+		{
+			const double p = phase * PHASES_;
+			const int    i = static_cast<int>(p);
+			const float* a = table.get(band, i);
+			dsp::interpolate(frames, a, a + m_taps, static_cast<float>(p - i), m_taps, out[0], out[1]);
+		}
+
+		phase += ratio;
+		generated++;
+	}
+	m_phase = phase;
+	return {used, generated};
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Interpolator::reset()
+{
+	/* The window starts with silence. The output frame sits right after its
+	middle: it takes m_taps / 2 + 1 input frames to line it up with the first 
+	one. */
+
+	m_window.fill(0.0f);
+	m_write = 0;
+	m_phase = m_taps / 2 + 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Interpolator::Type Interpolator::getType() const { return m_type; }
+
+/* -------------------------------------------------------------------------- */
+
+void Interpolator::push_(const float* frame)
+{
+	float* a = m_window.data() + m_write * G_MAX_IO_CHANS;
+	float* b = a + m_taps * G_MAX_IO_CHANS;
+	a[0] = b[0] = frame[0];
+	a[1] = b[1] = frame[1];
+	if (++m_write == m_taps)
+		m_write = 0;
+}
+} // namespace giada::m
\ No newline at end of file
@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_INTERPOLATOR_H
+#define G_INTERPOLATOR_H
+
+#include "core/const.h"
+#include <array>
+
+namespace giada::m
+{
+/* Interpolator
+Built-in resampler for stereo data, used for pitch playback. Allocation-free, 
+and its state is a plain block of memory that can be copied around at will. */
+
+class Interpolator final
+{
+public:
+	/* Type
+	CUBIC is a 4-point Hermite spline: cheap, but it aliases when pitched up.
+	POLYPHASE types are windowed-sinc filters read from precomputed tables. 
+	Their bandwidth narrows as pitch goes up, so that high notes don't alias. */
+
+	enum class Type
+	{
+		CUBIC,
+		POLYPHASE_FAST,
+		POLYPHASE_BEST
+	};
+
+	/* Result
+	Number of frames used from input and generated to output by process(). */
+
+	struct Result
+	{
+		long used, generated;
+	};
+
+	Interpolator(Type type = Type::CUBIC);
+
+	/* process
+	Reads stereo frames from 'input' and writes up to 'outputLength' frames into 
+	'output', moving forward by 'ratio' input frames for each output frame. 
+	Stops early if input runs out: the next call picks up from where this one 
+	left off. */
+
+	Result process(const float* input, long inputLength, float* output,
+	    long outputLength, float ratio);
+
+	/* reset
+	Forgets past input. The first frame generated afterwards is aligned to the
+	first input frame. */
+
+	void reset();
+
+	Type getType() const;
+
+private:
+	static constexpr int MAX_TAPS = 32;
+
+	/* push_
+	Appends a stereo frame to the window, dropping the oldest one. */
+
+	void push_(const float* frame);
+
+	Type   m_type;
+	int    m_taps;
+	int    m_write;
+	double m_phase; // Next output frame, in input frames past the window's middle
+
+	/* m_window
+	Last 'm_taps' input frames, stored twice in a row so that they can always 
+	be read as a contiguous block starting from 'm_write'. */
+
+	std::array<float, MAX_TAPS * 2 * G_MAX_IO_CHANS> m_window;
+};
+} // namespace giada::m
+
+#endif
\ No newline at end of file
@@ -157,6 +157,7 @@ int callback_(void* outBuf, void* inBuf, unsigned bufferSize, double /*streamTim
 	info.outVol          = mh::getOutVol();
 	info.inVol           = mh::getInVol();
 	info.recTriggerLevel = conf::conf.recTriggerLevel;
+	info.sampleRate      = realSampleRate_;
 
 	return mixer::render(out, in, info);
 }
@@ -338,6 +339,15 @@ int stopStream()
 
 /* -------------------------------------------------------------------------- */
 
+void openOffline(const conf::Conf& conf)
+{
+	realBufsize_    = conf.buffersize;
+	realSampleRate_ = conf.samplerate;
+	u::log::print("[KA] offline, buffer size=%d, samplerate=%d\n", realBufsize_, realSampleRate_);
+}
+
+/* -------------------------------------------------------------------------- */
+
 int closeDevice()
 {
 	if (rtSystem_->isStreamOpen())
@@ -55,6 +55,12 @@ struct Device
 };
 
 int openDevice(const conf::Conf& conf);
+
+/* openOffline
+Takes buffer size and sample rate from 'conf' without opening any device, for
+running the engine headless with the offline renderer. */
+
+void openOffline(const conf::Conf& conf);
 int closeDevice();
 int startStream();
 int stopStream();
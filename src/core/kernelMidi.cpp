@@ -28,8 +28,11 @@
 #include "const.h"
 #include "midiDispatcher.h"
 #include "midiMapConf.h"
+#include "sync.h"
 #include "utils/log.h"
 #include <RtMidi.h>
+#include <chrono>
+#include <mutex>
 
 namespace giada
 {
@@ -46,8 +49,52 @@ RtMidiIn*  midiIn_      = nullptr;
 unsigned   numOutPorts_ = 0;
 unsigned   numInPorts_  = 0;
 
-static void callback_(double /*t*/, std::vector<unsigned char>* msg, void* /*data*/)
+/* outMutex_
+RtMidiOut is not thread-safe, and messages are sent by the MIDI scheduler as 
+well as by non-realtime threads. */
+
+std::mutex outMutex_;
+
+/* lastMessageTime_
+Reconstructed arrival time of the last incoming MIDI message. */
+
+Timestamp lastMessageTime_ = {};
+
+/* getMessageTime_
+Rebuilds the time a MIDI message has been received by the device, given the 
+delta time 't' (in seconds) from the previous message provided by RtMidi. This
+is more accurate than reading the clock here, since RtMidi might invoke the 
+callback late or in bursts. Re-syncs with the system clock if the two drift 
+apart (e.g. first message, long pauses). */
+
+Timestamp getMessageTime_(double t)
+{
+	using namespace std::chrono;
+
+	constexpr auto MAX_DRIFT = milliseconds(G_MIDI_IN_MAX_DRIFT_MS);
+
+	const Timestamp now  = steady_clock::now();
+	const Timestamp time = lastMessageTime_ + duration_cast<steady_clock::duration>(duration<double>(t));
+
+	lastMessageTime_ = (time > now || now - time > MAX_DRIFT) ? now : time;
+	return lastMessageTime_;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void callback_(double t, std::vector<unsigned char>* msg, void* /*data*/)
 {
+	const Timestamp time = getMessageTime_(t);
+
+	/* Single-byte messages are system real-time ones: clock, start, stop and
+	so on (active sensing is filtered out by RtMidi). */
+
+	if (msg->size() == 1)
+	{
+		sync::recvMIDIclock(msg->at(0), time);
+		return;
+	}
+
 	if (msg->size() < 3)
 	{
 		//u::log::print("[KM] MIDI received - unknown signal - size=%d, value=0x", (int) msg->size());
@@ -56,7 +103,21 @@ static void callback_(double /*t*/, std::vector<unsigned char>* msg, void* /*dat
 		//u::log::print("\n");
 		return;
 	}
-	midiDispatcher::dispatch(msg->at(0), msg->at(1), msg->at(2));
+	midiDispatcher::dispatch(msg->at(0), msg->at(1), msg->at(2), time);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getSize_
+Returns the length in bytes of a MIDI message, given its status byte. */
+
+std::size_t getSize_(int status)
+{
+	if (status == MIDI_MTC_QUARTER || status == MIDI_SONG_SELECT)
+		return 2;
+	if (status > MIDI_POSITION_PTR && status != MIDI_SYSEX)
+		return 1;
+	return 3;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -226,12 +287,17 @@ void send(uint32_t data)
 	if (!status_)
 		return;
 
+	const std::size_t size = getSize_(getB1(data));
+
 	std::vector<unsigned char> msg(1, getB1(data));
-	msg.push_back(getB2(data));
-	msg.push_back(getB3(data));
+	if (size > 1)
+		msg.push_back(getB2(data));
+	if (size > 2)
+		msg.push_back(getB3(data));
 
+	std::scoped_lock lock(outMutex_);
 	midiOut_->sendMessage(&msg);
-	u::log::print("[KM::send] send msg=0x%X (%X %X %X)\n", data, msg[0], msg[1], msg[2]);
+	u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "[KM::send] send msg=0x%X (%X %X %X)\n", data, msg[0], msg[1], msg[2]);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -248,8 +314,9 @@ void send(int b1, int b2, int b3)
 	if (b3 != -1)
 		msg.push_back(b3);
 
+	std::scoped_lock lock(outMutex_);
 	midiOut_->sendMessage(&msg);
-	u::log::print("[KM::send] send msg=(%X %X %X)\n", b1, b2, b3);
+	u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "[KM::send] send msg=(%X %X %X)\n", b1, b2, b3);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -260,11 +327,11 @@ void sendMidiLightning(uint32_t learnt, const midimap::Message& m)
 
 	if (!midimap::isDefined(m))
 	{
-		u::log::print("[KM::sendMidiLightning] message skipped (not defined in midimap)");
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "[KM::sendMidiLightning] message skipped (not defined in midimap)");
 		return;
 	}
 
-	u::log::print("[KM::sendMidiLightning] learnt=0x%X, chan=%d, msg=0x%X, offset=%d\n",
+	u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "[KM::sendMidiLightning] learnt=0x%X, chan=%d, msg=0x%X, offset=%d\n",
 	    learnt, m.channel, m.value, m.offset);
 
 	/* Isolate 'channel' from learnt message and offset it as requested by 'nn' in 
@@ -44,7 +44,8 @@ int getB3(uint32_t iValue);
 uint32_t getIValue(int b1, int b2, int b3);
 
 /* send
-Sends a MIDI message 's' as uint32_t or as separate bytes. */
+Sends a MIDI message 's' as uint32_t or as separate bytes, right away. Might 
+block: the audio thread goes through the midiScheduler instead. */
 
 void send(uint32_t s);
 void send(int b1, int b2 = -1, int b3 = -1);
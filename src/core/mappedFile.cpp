@@ -0,0 +1,154 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/mappedFile.h"
+#include "utils/log.h"
+#if defined(G_OS_WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace giada::m
+{
+namespace
+{
+/* touch_
+Reads one byte per page, so that the whole mapping is loaded now instead of
+on first access, possibly by the audio thread. */
+
+void touch_(const std::byte* data, std::size_t size)
+{
+	constexpr std::size_t PAGE = 4096;
+
+	const volatile std::byte* page = data;
+	for (std::size_t i = 0; i < size; i += PAGE)
+		page[i]; // Volatile: the read is not optimized away
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& path)
+{
+#if defined(G_OS_WINDOWS)
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+	    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void*  data    = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	/* The view keeps both the mapping and the file alive. */
+
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	CloseHandle(file);
+
+	if (data == nullptr)
+	{
+		u::log::print("[MappedFile::open] unable to map %s\n", path);
+		return nullptr;
+	}
+	touch_(static_cast<std::byte*>(data), static_cast<std::size_t>(size.QuadPart));
+	return std::make_unique<MappedFile>(static_cast<std::byte*>(data), static_cast<std::size_t>(size.QuadPart));
+
+#else
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	struct stat info;
+	if (fstat(fd, &info) == -1 || info.st_size == 0)
+	{
+		::close(fd);
+		return nullptr;
+	}
+
+	/* MAP_POPULATE (Linux only) reads the whole file in and fills the page 
+	tables right away. Elsewhere pages are loaded by touch_() below, which is 
+	cheap when they are already there. */
+
+#if defined(MAP_POPULATE)
+	void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+#else
+	void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+#endif
+	::close(fd); // The mapping keeps its own reference to the file
+
+	if (data == MAP_FAILED)
+	{
+		u::log::print("[MappedFile::open] unable to map %s\n", path);
+		return nullptr;
+	}
+#if !defined(MAP_POPULATE)
+	madvise(data, info.st_size, MADV_WILLNEED);
+#endif
+	touch_(static_cast<std::byte*>(data), static_cast<std::size_t>(info.st_size));
+	return std::make_unique<MappedFile>(static_cast<std::byte*>(data), static_cast<std::size_t>(info.st_size));
+
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+MappedFile::MappedFile(std::byte* data, std::size_t size)
+: m_data(data)
+, m_size(size)
+{
+}
+
+/* -------------------------------------------------------------------------- */
+
+MappedFile::~MappedFile()
+{
+#if defined(G_OS_WINDOWS)
+	UnmapViewOfFile(m_data);
+#else
+	munmap(m_data, m_size);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::byte*  MappedFile::getData() const { return m_data; }
+std::size_t MappedFile::getSize() const { return m_size; }
+} // namespace giada::m
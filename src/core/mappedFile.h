@@ -0,0 +1,63 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_MAPPED_FILE_H
+#define G_MAPPED_FILE_H
+
+#include "core/const.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace giada::m
+{
+/* MappedFile
+A file mapped in memory, read-only. Pages are loaded up front by open(), off
+the audio thread, and shared with any other process mapping the same file. */
+
+class MappedFile
+{
+public:
+	/* open
+	Maps the whole file 'path' and loads it in memory. Returns nullptr on 
+	failure. */
+
+	static std::unique_ptr<MappedFile> open(const std::string& path);
+
+	MappedFile(std::byte* data, std::size_t size);
+	MappedFile(const MappedFile&) = delete;
+	~MappedFile();
+
+	std::byte*  getData() const;
+	std::size_t getSize() const;
+
+private:
+	std::byte*  m_data;
+	std::size_t m_size;
+};
+} // namespace giada::m
+
+#endif
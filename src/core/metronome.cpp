@@ -25,7 +25,9 @@
  * -------------------------------------------------------------------------- */
 
 #include "metronome.h"
+#include "core/dsp.h"
 #include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
+#include <algorithm>
 
 namespace giada::m
 {
@@ -40,14 +42,21 @@ void Metronome::trigger(Click c, Frame o)
 
 void Metronome::render(mcl::AudioBuffer& outBuf)
 {
-	const float* data = m_click == Click::BEAT ? beat : bar;
-	for (Frame f = m_offset; f < outBuf.countFrames() && m_rendering; f++)
+	if (m_rendering)
 	{
-		for (int c = 0; c < outBuf.countChannels(); c++)
-			outBuf[f][c] += data[m_tracker];
-		m_tracker = (m_tracker + 1) % CLICK_SIZE;
-		if (m_tracker == 0)
+		const float* data  = m_click == Click::BEAT ? beat : bar;
+		const Frame  count = std::min(outBuf.countFrames() - m_offset, CLICK_SIZE - m_tracker);
+
+		if (count > 0)
+		{
+			dsp::sumMono(outBuf, data + m_tracker, m_offset, count);
+			m_tracker += count;
+		}
+		if (m_tracker == CLICK_SIZE)
+		{
+			m_tracker   = 0;
 			m_rendering = false;
+		}
 	}
 	m_offset = 0;
 }
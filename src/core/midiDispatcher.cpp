@@ -37,7 +37,11 @@
 #include "glue/plugin.h"
 #include "utils/log.h"
 #include "utils/math.h"
+#include "utils/vector.h"
+#include <atomic>
 #include <cassert>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace giada::m::midiDispatcher
@@ -51,6 +55,42 @@ contains things to do once the midi message has been stored. */
 std::function<void()>          signalCb_ = nullptr;
 std::function<void(MidiEvent)> learnCb_  = nullptr;
 
+/* Route
+A destination for incoming MIDI messages, as learned by a channel: a channel 
+parameter ('param' is one of the G_MIDI_IN_* constants) or, if 'pluginId' is
+set, a plug-in parameter. The channel position in the model is cached to skip
+a lookup: it is validated against the channel ID before use. */
+
+struct Route
+{
+	std::size_t channelIndex;
+	ID          channelId;
+	int         param;
+	ID          pluginId   = 0;
+	std::size_t paramIndex = 0;
+};
+
+/* routes_
+Routing table: maps a pure MIDI value (i.e. without velocity) to the routes
+learned with that value, so that incoming messages are dispatched with a single
+lookup. Read and written by the Event Dispatcher thread only. */
+
+std::unordered_map<uint32_t, std::vector<Route>> routes_;
+
+/* midiChannels_
+Routes to MIDI channels, which forward raw MIDI messages to their plug-ins when
+armed. */
+
+std::vector<Route> midiChannels_;
+
+/* routesVersion_, routesDirty_
+Structure version of the channel table the routes have been built from, and a
+flag raised when a MIDI binding changes. Both trigger a rebuild of the routes
+on the next incoming message. */
+
+uint64_t          routesVersion_ = 0;
+std::atomic<bool> routesDirty_   = true;
+
 /* -------------------------------------------------------------------------- */
 
 bool isMasterMidiInAllowed_(int c)
@@ -69,106 +109,201 @@ bool isChannelMidiInAllowed_(ID channelId, int c)
 
 /* -------------------------------------------------------------------------- */
 
-#ifdef WITH_VST
+/* addRoute_
+Adds route 'r' for the pure MIDI value 'value'. Unlearned parameters (0x0) are
+skipped. A channel reacts only to the first parameter bound to a certain value,
+so further channel routes with the same value are skipped too. */
 
-void processPlugins_(const std::vector<Plugin*>& plugins, const MidiEvent& midiEvent)
+void addRoute_(uint32_t value, Route r)
 {
-	uint32_t pure = midiEvent.getRawNoVelocity();
-	float    vf   = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, 1.0f);
+	if (value == 0x0)
+		return;
+
+	std::vector<Route>& routes = routes_[value];
+
+	if (r.pluginId == 0 && !routes.empty() && routes.back().channelId == r.channelId)
+		return;
 
-	/* Plugins' parameters layout reflects the structure of the matrix
-	Channel::midiInPlugins. It is safe to assume then that Plugin 'p' and 
-	parameter indexes match both the structure of Channel::midiInPlugins and the 
-	vector of plugins. */
+	routes.push_back(r);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void rebuildRoutes_(const model::ChannelTable& channels)
+{
+	routes_.clear();
+	midiChannels_.clear();
 
-	for (Plugin* p : plugins)
+	for (std::size_t i = 0; i < channels.size(); i++)
 	{
-		for (const MidiLearnParam& param : p->midiInParams)
-		{
-			if (pure != param.getValue())
-				continue;
-			c::events::setPluginParameter(p->id, param.getIndex(), vf, /*gui=*/false);
-			u::log::print("  >>> [pluginId=%d paramIndex=%d] (pure=0x%X, value=%d, float=%f)\n",
-			    p->id, param.getIndex(), pure, midiEvent.getVelocity(), vf);
-		}
+		const channel::Data&     c = channels[i];
+		const midiLearner::Data& l = c.midiLearner;
+
+		/* The order matters: it sets the priority among channel parameters 
+		learned with the same MIDI value. */
+
+		addRoute_(l.keyPress.getValue(), {i, c.id, G_MIDI_IN_KEYPRESS});
+		addRoute_(l.keyRelease.getValue(), {i, c.id, G_MIDI_IN_KEYREL});
+		addRoute_(l.mute.getValue(), {i, c.id, G_MIDI_IN_MUTE});
+		addRoute_(l.kill.getValue(), {i, c.id, G_MIDI_IN_KILL});
+		addRoute_(l.arm.getValue(), {i, c.id, G_MIDI_IN_ARM});
+		addRoute_(l.solo.getValue(), {i, c.id, G_MIDI_IN_SOLO});
+		addRoute_(l.volume.getValue(), {i, c.id, G_MIDI_IN_VOLUME});
+		addRoute_(l.pitch.getValue(), {i, c.id, G_MIDI_IN_PITCH});
+		addRoute_(l.readActions.getValue(), {i, c.id, G_MIDI_IN_READ_ACTIONS});
+
+#ifdef WITH_VST
+		for (const Plugin* p : c.plugins)
+			for (const MidiLearnParam& param : p->midiInParams)
+				addRoute_(param.getValue(), {i, c.id, 0, p->id, param.getIndex()});
+#endif
+
+		if (c.type == ChannelType::MIDI)
+			midiChannels_.push_back({i, c.id, 0});
 	}
+
+	routesVersion_ = channels.getStructureVersion();
+
+	u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "[midiDispatcher] routes rebuilt - %d values, %d MIDI channels\n",
+	    static_cast<int>(routes_.size()), static_cast<int>(midiChannels_.size()));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getChannel_
+Returns the channel targeted by route 'r', or nullptr if the route is stale. */
+
+const channel::Data* getChannel_(const model::ChannelTable& channels, const Route& r)
+{
+	if (r.channelIndex >= channels.size() || channels[r.channelIndex].id != r.channelId)
+		return nullptr;
+	return &channels[r.channelIndex];
+}
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef WITH_VST
+
+void processPlugin_(const channel::Data& c, const Route& r, const MidiEvent& midiEvent)
+{
+	/* The plug-in might have been removed from the channel in the meantime. */
+
+	if (!u::vector::has(c.plugins, [&r](const Plugin* p) { return p->id == r.pluginId; }))
+		return;
+
+	float vf = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, 1.0f);
+
+	c::events::setPluginParameter(r.pluginId, r.paramIndex, vf, /*gui=*/false);
+	u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> [pluginId=%d paramIndex=%d] (pure=0x%X, value=%d, float=%f)\n",
+	    r.pluginId, r.paramIndex, midiEvent.getRawNoVelocity(), midiEvent.getVelocity(), vf);
 }
 
 #endif
 
 /* -------------------------------------------------------------------------- */
 
-void processChannels_(const MidiEvent& midiEvent)
+void processChannel_(const channel::Data& c, const Route& r, const MidiEvent& midiEvent, Timestamp t)
 {
 	uint32_t pure = midiEvent.getRawNoVelocity();
 
-	for (const channel::Data& c : model::get().channels)
+	switch (r.param)
 	{
+	case G_MIDI_IN_KEYPRESS:
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> keyPress, ch=%d (pure=0x%X)\n", c.id, pure);
+		c::events::pressChannel(c.id, midiEvent.getVelocity(), Thread::MIDI, t);
+		break;
 
-		/* Do nothing on this channel if MIDI in is disabled or filtered out for
-		the current MIDI channel. */
-		if (!c.midiLearner.isAllowed(midiEvent.getChannel()))
-			continue;
+	case G_MIDI_IN_KEYREL:
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> keyRel ch=%d (pure=0x%X)\n", c.id, pure);
+		c::events::releaseChannel(c.id, Thread::MIDI, t);
+		break;
 
-		if (pure == c.midiLearner.keyPress.getValue())
-		{
-			u::log::print("  >>> keyPress, ch=%d (pure=0x%X)\n", c.id, pure);
-			c::events::pressChannel(c.id, midiEvent.getVelocity(), Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.keyRelease.getValue())
-		{
-			u::log::print("  >>> keyRel ch=%d (pure=0x%X)\n", c.id, pure);
-			c::events::releaseChannel(c.id, Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.mute.getValue())
-		{
-			u::log::print("  >>> mute ch=%d (pure=0x%X)\n", c.id, pure);
-			c::events::toggleMuteChannel(c.id, Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.kill.getValue())
-		{
-			u::log::print("  >>> kill ch=%d (pure=0x%X)\n", c.id, pure);
-			c::events::killChannel(c.id, Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.arm.getValue())
-		{
-			u::log::print("  >>> arm ch=%d (pure=0x%X)\n", c.id, pure);
-			c::events::toggleArmChannel(c.id, Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.solo.getValue())
-		{
-			u::log::print("  >>> solo ch=%d (pure=0x%X)\n", c.id, pure);
-			c::events::toggleSoloChannel(c.id, Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.volume.getValue())
-		{
-			float vf = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, G_MAX_VOLUME);
-			u::log::print("  >>> volume ch=%d (pure=0x%X, value=%d, float=%f)\n",
-			    c.id, pure, midiEvent.getVelocity(), vf);
-			c::events::setChannelVolume(c.id, vf, Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.pitch.getValue())
-		{
-			float vf = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, G_MAX_PITCH);
-			u::log::print("  >>> pitch ch=%d (pure=0x%X, value=%d, float=%f)\n",
-			    c.id, pure, midiEvent.getVelocity(), vf);
-			c::events::setChannelPitch(c.id, vf, Thread::MIDI);
-		}
-		else if (pure == c.midiLearner.readActions.getValue())
-		{
-			u::log::print("  >>> toggle read actions ch=%d (pure=0x%X)\n", c.id, pure);
-			c::events::toggleReadActionsChannel(c.id, Thread::MIDI);
-		}
+	case G_MIDI_IN_MUTE:
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> mute ch=%d (pure=0x%X)\n", c.id, pure);
+		c::events::toggleMuteChannel(c.id, Thread::MIDI);
+		break;
+
+	case G_MIDI_IN_KILL:
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> kill ch=%d (pure=0x%X)\n", c.id, pure);
+		c::events::killChannel(c.id, Thread::MIDI, t);
+		break;
+
+	case G_MIDI_IN_ARM:
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> arm ch=%d (pure=0x%X)\n", c.id, pure);
+		c::events::toggleArmChannel(c.id, Thread::MIDI);
+		break;
+
+	case G_MIDI_IN_SOLO:
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> solo ch=%d (pure=0x%X)\n", c.id, pure);
+		c::events::toggleSoloChannel(c.id, Thread::MIDI);
+		break;
+
+	case G_MIDI_IN_VOLUME:
+	{
+		float vf = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, G_MAX_VOLUME);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> volume ch=%d (pure=0x%X, value=%d, float=%f)\n",
+		    c.id, pure, midiEvent.getVelocity(), vf);
+		c::events::setChannelVolume(c.id, vf, Thread::MIDI);
+		break;
+	}
+
+	case G_MIDI_IN_PITCH:
+	{
+		float vf = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, G_MAX_PITCH);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> pitch ch=%d (pure=0x%X, value=%d, float=%f)\n",
+		    c.id, pure, midiEvent.getVelocity(), vf);
+		c::events::setChannelPitch(c.id, vf, Thread::MIDI);
+		break;
+	}
+
+	case G_MIDI_IN_READ_ACTIONS:
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> toggle read actions ch=%d (pure=0x%X)\n", c.id, pure);
+		c::events::toggleReadActionsChannel(c.id, Thread::MIDI);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void processChannels_(const MidiEvent& midiEvent, Timestamp t)
+{
+	const model::ChannelTable& channels = std::as_const(model::get().channels);
+
+	if (routesDirty_.exchange(false) || routesVersion_ != channels.getStructureVersion())
+		rebuildRoutes_(channels);
+
+	/* Do nothing on a channel if MIDI in is disabled or filtered out for the 
+	current MIDI channel. */
 
+	if (auto it = routes_.find(midiEvent.getRawNoVelocity()); it != routes_.end())
+	{
+		for (const Route& r : it->second)
+		{
+			const channel::Data* c = getChannel_(channels, r);
+			if (c == nullptr || !c->midiLearner.isAllowed(midiEvent.getChannel()))
+				continue;
 #ifdef WITH_VST
-		/* Process learned plugins parameters. */
-		processPlugins_(c.plugins, midiEvent);
+			if (r.pluginId != 0)
+			{
+				processPlugin_(*c, r, midiEvent);
+				continue;
+			}
 #endif
+			processChannel_(*c, r, midiEvent, t);
+		}
+	}
+
+	/* Redirect raw MIDI message (pure + velocity) to plug-ins in armed MIDI 
+	channels. */
 
-		/* Redirect raw MIDI message (pure + velocity) to plug-ins in armed
-		channels. */
-		if (c.armed)
-			c::events::sendMidiToChannel(c.id, midiEvent, Thread::MIDI);
+	for (const Route& r : midiChannels_)
+	{
+		const channel::Data* c = getChannel_(channels, r);
+		if (c != nullptr && c->armed && c->midiLearner.isAllowed(midiEvent.getChannel()))
+			c::events::sendMidiToChannel(c->id, midiEvent, Thread::MIDI, t);
 	}
 }
 
@@ -182,51 +317,51 @@ void processMaster_(const MidiEvent& midiEvent)
 	if (pure == midiIn.rewind)
 	{
 		c::events::rewindSequencer(Thread::MIDI);
-		u::log::print("  >>> rewind (master) (pure=0x%X)\n", pure);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> rewind (master) (pure=0x%X)\n", pure);
 	}
 	else if (pure == midiIn.startStop)
 	{
 		c::events::toggleSequencer(Thread::MIDI);
-		u::log::print("  >>> startStop (master) (pure=0x%X)\n", pure);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> startStop (master) (pure=0x%X)\n", pure);
 	}
 	else if (pure == midiIn.actionRec)
 	{
 		c::events::toggleActionRecording();
-		u::log::print("  >>> actionRec (master) (pure=0x%X)\n", pure);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> actionRec (master) (pure=0x%X)\n", pure);
 	}
 	else if (pure == midiIn.inputRec)
 	{
 		c::events::toggleInputRecording();
-		u::log::print("  >>> inputRec (master) (pure=0x%X)\n", pure);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> inputRec (master) (pure=0x%X)\n", pure);
 	}
 	else if (pure == midiIn.metronome)
 	{
 		c::events::toggleMetronome();
-		u::log::print("  >>> metronome (master) (pure=0x%X)\n", pure);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> metronome (master) (pure=0x%X)\n", pure);
 	}
 	else if (pure == midiIn.volumeIn)
 	{
 		float vf = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, G_MAX_VOLUME);
 		c::events::setMasterInVolume(vf, Thread::MIDI);
-		u::log::print("  >>> input volume (master) (pure=0x%X, value=%d, float=%f)\n",
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> input volume (master) (pure=0x%X, value=%d, float=%f)\n",
 		    pure, midiEvent.getVelocity(), vf);
 	}
 	else if (pure == midiIn.volumeOut)
 	{
 		float vf = u::math::map(midiEvent.getVelocity(), G_MAX_VELOCITY, G_MAX_VOLUME);
 		c::events::setMasterOutVolume(vf, Thread::MIDI);
-		u::log::print("  >>> output volume (master) (pure=0x%X, value=%d, float=%f)\n",
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> output volume (master) (pure=0x%X, value=%d, float=%f)\n",
 		    pure, midiEvent.getVelocity(), vf);
 	}
 	else if (pure == midiIn.beatDouble)
 	{
 		c::events::multiplyBeats();
-		u::log::print("  >>> sequencer x2 (master) (pure=0x%X)\n", pure);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> sequencer x2 (master) (pure=0x%X)\n", pure);
 	}
 	else if (pure == midiIn.beatHalf)
 	{
 		c::events::divideBeats();
-		u::log::print("  >>> sequencer /2 (master) (pure=0x%X)\n", pure);
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "  >>> sequencer /2 (master) (pure=0x%X)\n", pure);
 	}
 }
 
@@ -281,6 +416,7 @@ void learnChannel_(MidiEvent e, int param, ID channelId, std::function<void()> d
 		break;
 	}
 
+	routesDirty_.store(true);
 	model::swap(model::SwapType::SOFT);
 
 	stopLearn();
@@ -335,7 +471,8 @@ void learnMaster_(MidiEvent e, int param, std::function<void()> doneCb)
 
 void learnPlugin_(MidiEvent e, std::size_t paramIndex, ID pluginId, std::function<void()> doneCb)
 {
-	model::DataLock lock(model::SwapType::NONE);
+	/* MIDI input parameters are never read by the audio thread: no need to
+	swap the model. */
 
 	Plugin* plugin = model::find<Plugin>(pluginId);
 
@@ -343,6 +480,7 @@ void learnPlugin_(MidiEvent e, std::size_t paramIndex, ID pluginId, std::functio
 	assert(paramIndex < plugin->midiInParams.size());
 
 	plugin->midiInParams[paramIndex].setValue(e.getRawNoVelocity());
+	routesDirty_.store(true);
 
 	stopLearn();
 	doneCb();
@@ -412,7 +550,7 @@ void clearPluginLearn(std::size_t paramIndex, ID pluginId, std::function<void()>
 
 /* -------------------------------------------------------------------------- */
 
-void dispatch(int byte1, int byte2, int byte3)
+void dispatch(int byte1, int byte2, int byte3, Timestamp t)
 {
 	/* Here we want to catch two things: a) note on/note off from a MIDI keyboard 
 	and b) knob/wheel/slider movements from a MIDI controller. 
@@ -422,7 +560,7 @@ void dispatch(int byte1, int byte2, int byte3)
 	MidiEvent midiEvent(byte1, byte2, byte3);
 	midiEvent.fixVelocityZero();
 
-	u::log::print("[midiDispatcher] MIDI received - 0x%X (chan %d)\n", midiEvent.getRaw(),
+	u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::INFO, "[midiDispatcher] MIDI received - 0x%X (chan %d)\n", midiEvent.getRaw(),
 	    midiEvent.getChannel());
 
 	/* Start dispatcher. Don't parse channels if MIDI learn is ON, just learn 
@@ -430,9 +568,12 @@ void dispatch(int byte1, int byte2, int byte3)
 	to be perfomed by the Event Dispatcher. */
 
 	Action                     action = {0, 0, 0, midiEvent};
-	eventDispatcher::EventType event  = learnCb_ != nullptr ? eventDispatcher::EventType::MIDI_DISPATCHER_LEARN : eventDispatcher::EventType::MIDI_DISPATCHER_PROCESS;
+	eventDispatcher::EventType type   = learnCb_ != nullptr ? eventDispatcher::EventType::MIDI_DISPATCHER_LEARN : eventDispatcher::EventType::MIDI_DISPATCHER_PROCESS;
+	eventDispatcher::Event     event  = {type, 0, 0, action};
+
+	event.timestamp = t;
 
-	eventDispatcher::pumpMidiEvent({event, 0, 0, action});
+	eventDispatcher::pumpMidiEvent(event);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -445,15 +586,22 @@ void learn(const MidiEvent& e)
 
 /* -------------------------------------------------------------------------- */
 
-void process(const MidiEvent& e)
+void process(const MidiEvent& e, Timestamp t)
 {
 	processMaster_(e);
-	processChannels_(e);
+	processChannels_(e, t);
 	triggerSignalCb_();
 }
 
 /* -------------------------------------------------------------------------- */
 
+void invalidateRoutes()
+{
+	routesDirty_.store(true);
+}
+
+/* -------------------------------------------------------------------------- */
+
 void setSignalCallback(std::function<void()> f)
 {
 	signalCb_ = f;
@@ -46,9 +46,10 @@ void clearPluginLearn(std::size_t paramIndex, ID pluginId, std::function<void()>
 #endif
 
 /* dispatch
-Main callback invoked by kernelMidi whenever a new MIDI data comes in. */
+Main callback invoked by kernelMidi whenever a new MIDI data comes in. 't' is 
+the time the message has been received by the MIDI device. */
 
-void dispatch(int byte1, int byte2, int byte3);
+void dispatch(int byte1, int byte2, int byte3, Timestamp t);
 
 /* learn
 Learns event 'e'. Called by the Event Dispatcher. */
@@ -56,12 +57,19 @@ Learns event 'e'. Called by the Event Dispatcher. */
 void learn(const MidiEvent& e);
 
 /* process
-Sends event 'e' to channels (masters and keyboard). Called by the Event 
-Dispatcher. */
+Sends event 'e', received at time 't', to channels (masters and keyboard). 
+Called by the Event Dispatcher. */
 
-void process(const MidiEvent& e);
+void process(const MidiEvent& e, Timestamp t);
 
 void setSignalCallback(std::function<void()> f);
+
+/* invalidateRoutes
+Rebuilds the MIDI routes on the next incoming message. Changes in the channel
+table structure are detected on their own: call this when plug-ins are added,
+cloned, moved or removed instead. */
+
+void invalidateRoutes();
 } // namespace giada::m::midiDispatcher
 
 #endif
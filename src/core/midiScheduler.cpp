@@ -0,0 +1,278 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/midiScheduler.h"
+#include "core/const.h"
+#include "core/kernelMidi.h"
+#include "core/notifier.h"
+#include "core/queue.h"
+#include "utils/log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#if defined(G_OS_WINDOWS)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace giada::m::midiScheduler
+{
+namespace
+{
+/* Message
+Entry of the queue between the audio thread and the scheduler. A BLOCK message
+carries the position and the start time of the audio block the following MIDI
+messages belong to. */
+
+struct Message
+{
+	enum class Type
+	{
+		BLOCK,
+		MIDI
+	};
+
+	Type      type;
+	int64_t   frame; // Absolute position in the audio stream
+	uint32_t  raw;
+	Timestamp time;
+	Frame     bufferSize;
+	int       sampleRate;
+};
+
+/* Pending
+MIDI message waiting to be sent at time 'time'. */
+
+struct Pending
+{
+	Timestamp time;
+	uint32_t  raw;
+};
+
+Queue<Message, G_MAX_MIDI_OUT_EVENTS> queue_;
+Notifier                              notifier_;
+std::thread                           thread_;
+std::atomic<bool>                     running_ = false;
+std::function<void(uint32_t)>         send_    = nullptr;
+
+/* streamFrame_, blockSize_, blockTime_, sampleRate_, blockQueued_
+Current audio block, as seen by the audio thread. The block is pushed to the 
+scheduler lazily, along with its first MIDI message: silent blocks cost 
+nothing. */
+
+int64_t   streamFrame_ = 0;
+Frame     blockSize_   = 0;
+Timestamp blockTime_   = {};
+int       sampleRate_  = 0;
+bool      blockQueued_ = false;
+
+/* block_, pending_
+Scheduler's own copy of the last block received and the messages waiting to be
+sent, sorted by time. Accessed by the scheduler thread only. */
+
+Message              block_   = {};
+std::vector<Pending> pending_ = {};
+
+/* -------------------------------------------------------------------------- */
+
+/* setRealtimePriority_
+MIDI messages are tiny and few, but late ones are clearly audible on external
+gear: run the scheduler above ordinary threads, when allowed to. */
+
+void setRealtimePriority_()
+{
+#if defined(G_OS_WINDOWS)
+	if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+		u::log::print("[midiScheduler] can't set realtime priority\n");
+#else
+	sched_param param;
+	param.sched_priority = std::min(G_MIDI_OUT_THREAD_PRIORITY, sched_get_priority_max(SCHED_FIFO));
+	if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+		u::log::print("[midiScheduler] can't set realtime priority\n");
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getTime_
+Returns the wall-clock time of the absolute frame 'frame', which belongs to the
+block 'b'. Adds one block of latency, see the header. */
+
+Timestamp getTime_(const Message& b, int64_t frame)
+{
+	using namespace std::chrono;
+
+	const double offset = (frame - b.frame + b.bufferSize) / static_cast<double>(b.sampleRate);
+	return b.time + duration_cast<steady_clock::duration>(duration<double>(offset));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* drain_
+Moves new messages from the queue to the pending list. Messages with the same
+time keep their order. */
+
+void drain_()
+{
+	Message m;
+	while (queue_.pop(m))
+	{
+		if (m.type == Message::Type::BLOCK)
+		{
+			block_ = m;
+			continue;
+		}
+		const Pending p   = {getTime_(block_, m.frame), m.raw};
+		const auto    pos = std::upper_bound(pending_.begin(), pending_.end(), p,
+		    [](const Pending& a, const Pending& b) { return a.time < b.time; });
+		pending_.insert(pos, p);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* sendDue_
+Sends all pending messages due by now. */
+
+void sendDue_(Timestamp now)
+{
+	auto it = pending_.begin();
+	for (; it != pending_.end() && it->time <= now; ++it)
+		send_(it->raw);
+	pending_.erase(pending_.begin(), it);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* loop_
+Sleeps until the next message is due, waking up every G_MIDI_OUT_POLL_US in
+the meantime: the audio thread might have queued something more urgent. With
+nothing to send it just waits for the audio thread to notify. */
+
+void loop_()
+{
+	using namespace std::chrono;
+
+	setRealtimePriority_();
+
+	while (running_.load())
+	{
+		drain_();
+
+		if (pending_.empty())
+		{
+			notifier_.wait(G_MIDI_OUT_TIMEOUT_MS);
+			continue;
+		}
+
+		const Timestamp now  = steady_clock::now();
+		const Timestamp next = pending_.front().time;
+
+		if (next > now)
+			std::this_thread::sleep_until(std::min(next, now + microseconds(G_MIDI_OUT_POLL_US)));
+		else
+			sendDue_(now);
+	}
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void init(std::function<void(uint32_t)> send)
+{
+	send_ = send != nullptr ? send : [](uint32_t raw) { kernelMidi::send(raw); };
+	pending_.reserve(G_MAX_MIDI_OUT_EVENTS);
+
+	running_.store(true);
+	thread_ = std::thread(loop_);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void close()
+{
+	running_.store(false);
+	notifier_.notify();
+	if (thread_.joinable())
+		thread_.join();
+
+	Message m;
+	while (queue_.pop(m))
+		;
+	pending_.clear();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void startBlock(Timestamp t, Frame bufferSize, int sampleRate)
+{
+	streamFrame_ += blockSize_;
+	blockSize_   = bufferSize;
+	blockTime_   = t;
+	sampleRate_  = sampleRate;
+	blockQueued_ = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool schedule(uint32_t raw, Frame localFrame)
+{
+	if (!running_.load())
+		return false;
+
+	if (!blockQueued_)
+	{
+		Message b;
+		b.type       = Message::Type::BLOCK;
+		b.frame      = streamFrame_;
+		b.time       = blockTime_;
+		b.bufferSize = blockSize_;
+		b.sampleRate = sampleRate_;
+		blockQueued_ = queue_.push(b);
+	}
+
+	Message m;
+	m.type  = Message::Type::MIDI;
+	m.frame = streamFrame_ + localFrame;
+	m.raw   = raw;
+
+	if (!blockQueued_ || !queue_.push(m))
+	{
+		u::log::printAsync(u::log::Subsystem::MIDI, u::log::Level::WARNING,
+		    "[midiScheduler::schedule] queue full, message 0x%X dropped\n", raw);
+		return false;
+	}
+
+	notifier_.notify();
+	return true;
+}
+} // namespace giada::m::midiScheduler
@@ -0,0 +1,70 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_MIDI_SCHEDULER_H
+#define G_MIDI_SCHEDULER_H
+
+#include "core/types.h"
+#include <cstdint>
+#include <functional>
+
+/* giada::m::midiScheduler
+Sends MIDI messages generated by the audio thread at the right time, without
+ever blocking the audio callback on MIDI I/O. The audio thread stamps each 
+message with its absolute position in the audio stream and pushes it into a 
+lock-free queue; a dedicated high-priority thread turns stream positions into
+wall-clock times and emits the messages when they are due. Like live input, 
+MIDI output runs one audio block behind: a message on frame 'n' of a block 
+leaves when the audio of that frame reaches the sound card. */
+
+namespace giada::m::midiScheduler
+{
+/* init
+Spawns the scheduler thread. Due messages are handed over to 'send', which 
+defaults to kernelMidi::send(). */
+
+void init(std::function<void(uint32_t)> send = nullptr);
+
+/* close
+Stops the scheduler thread. Messages not yet sent are discarded. */
+
+void close();
+
+/* startBlock
+Tells the scheduler that a new audio block of 'bufferSize' frames has started
+at time 't'. Audio thread only. */
+
+void startBlock(Timestamp t, Frame bufferSize, int sampleRate);
+
+/* schedule
+Queues the MIDI message 'raw' for frame 'localFrame' of the current block. 
+Returns false if the message has been dropped, because the queue is full or the
+scheduler is not running. Audio thread only, lock-free. */
+
+bool schedule(uint32_t raw, Frame localFrame);
+} // namespace giada::m::midiScheduler
+
+#endif
@@ -26,22 +26,24 @@
 
 #include "core/mixer.h"
 #include "core/const.h"
+#include "core/dsp.h"
+#include "core/midiScheduler.h"
 #include "core/model/model.h"
+#include "core/renderPool.h"
 #include "core/sequencer.h"
+#ifdef WITH_VST
+#include "core/plugins/pluginHost.h"
+#endif
 #include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
 #include "utils/log.h"
 #include "utils/math.h"
+#include <array>
+#include <chrono>
 
 namespace giada::m::mixer
 {
 namespace
 {
-/* CH_LEFT, CH_RIGHT
-Channels identifiers. */
-
-constexpr int CH_LEFT  = 0;
-constexpr int CH_RIGHT = 1;
-
 /* recBuffer_
 Working buffer for audio recording. */
 
@@ -76,6 +78,26 @@ a slightly different moment (see fireSignalCb_() below). */
 
 bool signalCbFired_ = false;
 
+/* blockTime_
+Estimated time the current audio block has started. It advances by one block 
+period on each render() call and gets re-synced with the system clock when the 
+two drift apart (first block, xruns, buffer size changes). */
+
+Timestamp blockTime_ = {};
+
+/* pendingEvents_, pendingCount_
+Live events already popped from the queue that belong to a future block. Read
+and written by the realtime thread only. */
+
+std::array<LiveEvent, G_MAX_LIVE_EVENTS> pendingEvents_;
+std::size_t                              pendingCount_ = 0;
+
+/* renderPool_
+Helper threads for rendering channels in parallel. With conf::renderThreads 
+set to 1 it has no helpers and channels are rendered on the audio thread. */
+
+RenderPool renderPool_;
+
 /* -------------------------------------------------------------------------- */
 
 /* fireSignalCb_
@@ -145,11 +167,11 @@ recording. */
 void processLineIn_(const model::Mixer& mixer, const mcl::AudioBuffer& inBuf,
     float inVol, float recTriggerLevel)
 {
-	const Peak peak{inBuf.getPeak(CH_LEFT), inBuf.getPeak(CH_RIGHT)};
+	const Peak peak = dsp::getPeak(inBuf);
 
 	if (signalCb_ != nullptr && thresholdReached_(peak, recTriggerLevel) && !signalCbFired_)
 	{
-		G_DEBUG("Signal > threshold!");
+		u::log::printAsync(u::log::Subsystem::AUDIO, u::log::Level::VERBOSE, "[mixer] signal > threshold\n");
 		fireSignalCb_();
 		signalCbFired_ = true;
 	}
@@ -167,11 +189,89 @@ void processLineIn_(const model::Mixer& mixer, const mcl::AudioBuffer& inBuf,
 
 /* -------------------------------------------------------------------------- */
 
-void processChannels_(const model::Layout& layout, mcl::AudioBuffer& out, mcl::AudioBuffer& in)
+void updateBlockTime_(Frame bufferSize, int sampleRate)
+{
+	using namespace std::chrono;
+
+	const auto      period = duration_cast<steady_clock::duration>(duration<double>(bufferSize / static_cast<double>(sampleRate)));
+	const Timestamp now    = steady_clock::now();
+
+	blockTime_ += period;
+	if (now - blockTime_ > period / 2 || blockTime_ - now > period / 2)
+		blockTime_ = now;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getLocalFrame_
+Maps the timestamp of a live event to a frame in the current block. Live events
+are played with a constant latency of one block: anything that took place 
+during the previous block period lands in [0, bufferSize), older events on 
+frame 0. Returns a value >= bufferSize if the event belongs to a future block. */
+
+Frame getLocalFrame_(Timestamp t, Frame bufferSize, int sampleRate)
+{
+	const double elapsed = std::chrono::duration<double>(t - blockTime_).count();
+	return std::max(0, bufferSize + static_cast<Frame>(elapsed * sampleRate));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* processLiveEvent_
+Applies a live event to its channel. Returns false if the event is due in a 
+future block and must be kept around. */
+
+bool processLiveEvent_(const model::Layout& layout, const LiveEvent& e, Frame bufferSize, int sampleRate)
 {
+	const Frame localFrame = getLocalFrame_(e.timestamp, bufferSize, sampleRate);
+
+	if (localFrame >= bufferSize)
+		return false;
+
+	/* The channel might have been deleted in the meantime: look for it 
+	without asserting. */
+
+	for (const channel::Data& c : layout.channels)
+		if (c.id == e.channelId)
+			channel::advanceLive(c, e.event, localFrame);
+
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void processLiveEvents_(const model::Layout& layout, Frame bufferSize, int sampleRate)
+{
+	std::size_t stillPending = 0;
+	for (std::size_t i = 0; i < pendingCount_; i++)
+		if (!processLiveEvent_(layout, pendingEvents_[i], bufferSize, sampleRate))
+			pendingEvents_[stillPending++] = pendingEvents_[i];
+	pendingCount_ = stillPending;
+
+	LiveEvent e;
+	while (pendingCount_ < pendingEvents_.size() && liveEvents.pop(e))
+		if (!processLiveEvent_(layout, e, bufferSize, sampleRate))
+			pendingEvents_[pendingCount_++] = e;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void processChannels_(const model::Layout& layout, mcl::AudioBuffer& out, const mcl::AudioBuffer& in)
+{
+	/* Channels are rendered into their own buffers, possibly in parallel, and
+	then summed into the output in channel order: the mix doesn't depend on 
+	which thread rendered what. */
+
+	auto renderChannel = [&layout, &in](std::size_t i) {
+		const channel::Data& c = layout.channels[i];
+		if (!c.isInternal())
+			channel::renderBuffer(c, in);
+	};
+	renderPool_.run(layout.channels.size(), renderChannel);
+
 	for (const channel::Data& c : layout.channels)
 		if (!c.isInternal())
-			channel::render(c, &out, &in, isChannelAudible(c));
+			channel::mixBuffer(c, out, isChannelAudible(c));
 }
 
 /* -------------------------------------------------------------------------- */
@@ -182,14 +282,11 @@ void processSequencer_(const model::Layout& layout, mcl::AudioBuffer& out, const
 	generating metronome audio). This way the metronome is aligned with 
 	everything else. */
 
-	const sequencer::EventBuffer& events = sequencer::advance(in.countFrames());
-	sequencer::render(out);
-
-	/* No channel processing if layout is locked: another thread is changing
-    data (e.g. Plugins or Waves). */
+	/* Actions come from the layout's own snapshot, so they are always 
+	consistent with the channels being rendered. */
 
-	if (layout.locked)
-		return;
+	const sequencer::EventBuffer& events = sequencer::advance(in.countFrames(), layout.timeline);
+	sequencer::render(out);
 
 	for (const channel::Data& c : layout.channels)
 		if (!c.isInternal())
@@ -215,18 +312,6 @@ void renderPreview_(const model::Layout& layout, mcl::AudioBuffer& out)
 
 /* -------------------------------------------------------------------------- */
 
-/* limit_
-Applies a very dumb hard limiter. */
-
-void limit_(mcl::AudioBuffer& outBuf)
-{
-	for (int i = 0; i < outBuf.countFrames(); i++)
-		for (int j = 0; j < outBuf.countChannels(); j++)
-			outBuf[i][j] = std::max(-1.0f, std::min(outBuf[i][j], 1.0f));
-}
-
-/* -------------------------------------------------------------------------- */
-
 /* finalizeOutput
 Last touches after the output has been rendered: apply inToOut if any, apply
 output volume, compute peak. */
@@ -235,15 +320,19 @@ void finalizeOutput_(const model::Mixer& mixer, mcl::AudioBuffer& outBuf,
     const RenderInfo& info)
 {
 	if (info.inToOut)
-		outBuf.sum(inBuffer_, info.outVol);
+		dsp::sum(outBuf, inBuffer_, info.outVol);
 	else
-		outBuf.applyGain(info.outVol);
+		dsp::applyGain(outBuf, info.outVol);
+
+	/* A very dumb hard limiter. */
 
 	if (info.limitOutput)
-		limit_(outBuf);
+		dsp::clamp(outBuf, -1.0f, 1.0f);
 
-	mixer.state->peakOutL.store(outBuf.getPeak(CH_LEFT));
-	mixer.state->peakOutR.store(outBuf.getPeak(CH_RIGHT));
+	const Peak peak = dsp::getPeak(outBuf);
+
+	mixer.state->peakOutL.store(peak.left);
+	mixer.state->peakOutR.store(peak.right);
 }
 } // namespace
 
@@ -251,7 +340,11 @@ void finalizeOutput_(const model::Mixer& mixer, mcl::AudioBuffer& outBuf,
 /* -------------------------------------------------------------------------- */
 /* -------------------------------------------------------------------------- */
 
-void init(Frame maxFramesInLoop, Frame framesInBuffer)
+Queue<LiveEvent, G_MAX_LIVE_EVENTS> liveEvents;
+
+/* -------------------------------------------------------------------------- */
+
+void init(Frame maxFramesInLoop, Frame framesInBuffer, int renderThreads)
 {
 	/* Allocate working buffers. recBuffer_ has variable size: it depends on how
 	many frames there are in the current loop. */
@@ -261,6 +354,23 @@ void init(Frame maxFramesInLoop, Frame framesInBuffer)
 
 	u::log::print("[mixer::init] buffers ready - maxFramesInLoop=%d, framesInBuffer=%d\n",
 	    maxFramesInLoop, framesInBuffer);
+
+	/* Helpers process plug-in stacks too: let them allocate their scratch 
+	buffers up front. */
+
+	std::function<void()> onStart = nullptr;
+#ifdef WITH_VST
+	onStart = [framesInBuffer]() { pluginHost::initThread(framesInBuffer); };
+#endif
+	renderPool_.stop();
+	renderPool_.start(renderThreads, onStart);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void close()
+{
+	renderPool_.stop();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -304,6 +414,8 @@ int render(mcl::AudioBuffer& out, const mcl::AudioBuffer& in, const RenderInfo&
 	const model::Mixer& mixer  = rtLock.get().mixer;
 
 	inBuffer_.clear();
+	updateBlockTime_(out.countFrames(), info.sampleRate);
+	midiScheduler::startBlock(blockTime_, out.countFrames(), info.sampleRate);
 
 	/* Reset peak computation. */
 
@@ -331,11 +443,11 @@ int render(mcl::AudioBuffer& out, const mcl::AudioBuffer& in, const RenderInfo&
 			processSequencer_(rtLock.get(), out, inBuffer_);
 	}
 
-	/* Channel processing. Don't do it if layout is locked: another thread is 
-	changing data (e.g. Plugins or Waves). */
+	/* Apply live events (key presses and the like) due in this block, then 
+	process channels. */
 
-	if (!rtLock.get().locked)
-		processChannels_(rtLock.get(), out, inBuffer_);
+	processLiveEvents_(rtLock.get(), out.countFrames(), info.sampleRate);
+	processChannels_(rtLock.get(), out, inBuffer_);
 
 	/* Render remaining internal channels. */
 
@@ -27,6 +27,7 @@
 #ifndef G_MIXER_H
 #define G_MIXER_H
 
+#include "core/const.h"
 #include "core/midiEvent.h"
 #include "core/queue.h"
 #include "core/recorder.h"
@@ -69,6 +70,20 @@ struct RenderInfo
 	float outVol;
 	float inVol;
 	float recTriggerLevel;
+	int   sampleRate;
+};
+
+/* LiveEvent
+A key press/release/kill coming from a MIDI device or the UI, with the time it
+was generated. The realtime thread turns the timestamp into a frame offset
+within the audio block, so that live events are rendered sample-accurately as
+recorded actions are. */
+
+struct LiveEvent
+{
+	ID        channelId = 0;
+	MidiEvent event     = {};
+	Timestamp timestamp = {};
 };
 
 /* RecordInfo
@@ -80,7 +95,22 @@ struct RecordInfo
 	Frame maxLength;
 };
 
-void init(Frame framesInLoop, Frame framesInBuffer);
+/* liveEvents
+Queue of live events, filled by the Event Dispatcher thread and drained by 
+render() at the beginning of each block. */
+
+extern Queue<LiveEvent, G_MAX_LIVE_EVENTS> liveEvents;
+
+/* init
+Allocates working buffers and spawns the threads for parallel channel 
+rendering: 'renderThreads' is their total count, audio thread included. */
+
+void init(Frame framesInLoop, Frame framesInBuffer, int renderThreads);
+
+/* close
+Stops the render threads. Call it with the mixer disabled. */
+
+void close();
 
 /* enable, disable
 Toggles master callback processing. Useful to suspend the rendering. */
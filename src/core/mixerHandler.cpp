@@ -42,6 +42,7 @@
 #include "core/recManager.h"
 #include "core/recorder.h"
 #include "core/recorderHandler.h"
+#include "core/resampler.h"
 #include "core/wave.h"
 #include "core/waveFx.h"
 #include "core/waveManager.h"
@@ -50,7 +51,6 @@
 #include "utils/fs.h"
 #include "utils/log.h"
 #include "utils/string.h"
-#include "utils/vector.h"
 #include <algorithm>
 #include <cassert>
 #include <vector>
@@ -69,17 +69,40 @@ channel::Data& addChannel_(ChannelType type, ID columnId)
 
 /* -------------------------------------------------------------------------- */
 
-waveManager::Result createWave_(const std::string& fname)
+/* retireWave_
+Removes Wave 'old' from the model, once no longer used by any channel. The 
+preview channel might be showing it in the Sample Editor: it is given 'w'
+instead, or emptied if 'w' is nullptr. Call it before swapping, so that the
+audio thread stops reading 'old' before it's destroyed. */
+
+void retireWave_(const Wave& old, Wave* w)
+{
+	channel::Data& preview = model::get().getChannel(mixer::PREVIEW_CHANNEL_ID);
+	if (preview.samplePlayer->getWave() == &old)
+		samplePlayer::loadWave(preview, w);
+	model::remove(old);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* createWave_
+Loads a new Wave from file 'fname', in the project sample format. */
+
+waveManager::Result createWave_(const std::string& fname, bool streamed = false)
 {
-	return waveManager::createFromFile(fname, /*id=*/0, conf::conf.samplerate,
-	    conf::conf.rsmpQuality);
+	waveManager::Result res = waveManager::createFromFile(fname, /*id=*/0,
+	    conf::conf.samplerate, Resampler::toSrcQuality(conf::conf.rsmpQuality), streamed);
+	if (res.wave != nullptr)
+		res.wave->pack(model::get().sampleFormat);
+	return res;
 }
 
 /* -------------------------------------------------------------------------- */
 
 bool anyChannel_(std::function<bool(const channel::Data&)> f)
 {
-	return std::any_of(model::get().channels.begin(), model::get().channels.end(), f);
+	const model::ChannelTable& channels = model::get().channels;
+	return std::any_of(channels.begin(), channels.end(), f);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -134,6 +157,7 @@ void recordChannel_(channel::Data& ch, Frame recordedFrames)
 	/* Copy up to wave.getSize() from the mixer's input buffer into wave's. */
 
 	wave->getBuffer().set(mixer::getRecBuffer(), wave->getBuffer().countFrames());
+	wave->computePeaks();
 
 	/* Update channel with the new Wave. */
 
@@ -152,16 +176,24 @@ Wave, overdub mode. */
 
 void overdubChannel_(channel::Data& ch)
 {
-	Wave* wave = ch.samplePlayer->getWave();
+	/* The audio thread might be reading the current Wave: sum the recorded 
+	audio into a copy of it and replace the original one, which is destroyed
+	after the swap. The copy shares data with the original until detached. */
 
-	/* Need model::DataLock here, as data might be being read by the audio
-	thread at the same time. */
+	const Wave&           oldWave = *ch.samplePlayer->getWave();
+	std::unique_ptr<Wave> wave    = waveManager::clone(oldWave);
 
-	model::DataLock lock;
+	wave->detach();
 	wave->getBuffer().sum(mixer::getRecBuffer(), /*gain=*/1.0f);
+	wave->computePeaks();
 	wave->setLogical(true);
 
+	model::add(std::move(wave));
+	samplePlayer::setWave(ch, &model::back<Wave>(), /*samplerateRatio=*/1.0f);
+	retireWave_(oldWave, &model::back<Wave>());
 	setupChannelPostRecording_(ch);
+
+	model::swap(model::SwapType::HARD);
 }
 } // namespace
 
@@ -171,7 +203,7 @@ void overdubChannel_(channel::Data& ch)
 
 void init()
 {
-	mixer::init(clock::getMaxFramesInLoop(), kernelAudio::getRealBufSize());
+	mixer::init(clock::getMaxFramesInLoop(), kernelAudio::getRealBufSize(), conf::conf.renderThreads);
 
 	model::get().channels.clear();
 
@@ -190,6 +222,7 @@ void init()
 void close()
 {
 	mixer::disable();
+	mixer::close();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -214,13 +247,9 @@ int loadChannel(ID channelId, const std::string& fname)
 	Wave* old  = model::get().getChannel(channelId).samplePlayer->getWave();
 
 	samplePlayer::loadWave(model::get().getChannel(channelId), &wave);
-	model::swap(model::SwapType::HARD);
-
-	/* Remove old wave, if any. It is safe to do it now: the audio thread is
-	already processing the new layout. */
-
 	if (old != nullptr)
-		model::remove<Wave>(*old);
+		retireWave_(*old, &wave);
+	model::swap(model::SwapType::HARD);
 
 	recManager::refreshInputRecMode();
 
@@ -229,6 +258,54 @@ int loadChannel(ID channelId, const std::string& fname)
 
 /* -------------------------------------------------------------------------- */
 
+int setWaveStreamed(ID channelId, bool streamed)
+{
+	channel::Data& ch  = model::get().getChannel(channelId);
+	Wave*          old = ch.samplePlayer->getWave();
+
+	if (old == nullptr || old->isStreamed() == streamed)
+		return G_RES_OK;
+
+	/* Takes and edited Waves have nothing on disk to stream from. */
+
+	if (old->isLogical() || old->isEdited())
+		return G_RES_ERR_WRONG_DATA;
+
+	waveManager::Result res = createWave_(old->getPath(), streamed);
+
+	if (res.status != G_RES_OK)
+		return res.status;
+
+	model::add(std::move(res.wave));
+
+	Wave& wave = model::back<Wave>();
+
+	samplePlayer::setWave(ch, &wave, /*samplerateRatio=*/1.0f);
+	ch.samplePlayer->end = std::min(ch.samplePlayer->end, wave.countFrames() - 1);
+	retireWave_(*old, &wave);
+	model::swap(model::SwapType::HARD);
+
+	return G_RES_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void replaceWave(ID channelId, std::unique_ptr<Wave>&& w)
+{
+	channel::Data& ch  = model::get().getChannel(channelId);
+	const Wave&    old = *ch.samplePlayer->getWave();
+
+	model::add(std::move(w));
+
+	Wave& wave = model::back<Wave>();
+
+	samplePlayer::setWave(ch, &wave, /*samplerateRatio=*/1.0f);
+	retireWave_(old, &wave);
+	model::swap(model::SwapType::HARD);
+}
+
+/* -------------------------------------------------------------------------- */
+
 int addAndLoadChannel(ID columnId, const std::string& fname)
 {
 	waveManager::Result res = createWave_(fname);
@@ -267,7 +344,7 @@ void cloneChannel(ID channelId)
 	if (newChannel.samplePlayer && newChannel.samplePlayer->hasWave())
 	{
 		Wave* wave = newChannel.samplePlayer->getWave();
-		model::add(waveManager::createFromWave(*wave, 0, wave->getBuffer().countFrames()));
+		model::add(waveManager::createFromWave(*wave, 0, wave->countFrames()));
 	}
 
 	/* Then push the new channel in the channels vector. */
@@ -287,10 +364,9 @@ void freeChannel(ID channelId)
 	const Wave* wave = ch.samplePlayer->getWave();
 
 	samplePlayer::loadWave(ch, nullptr);
-	model::swap(model::SwapType::HARD);
-
 	if (wave != nullptr)
-		model::remove<Wave>(*wave);
+		retireWave_(*wave, nullptr);
+	model::swap(model::SwapType::HARD);
 
 	recManager::refreshInputRecMode();
 }
@@ -319,13 +395,12 @@ void deleteChannel(ID channelId)
 	const std::vector<Plugin*> plugins = ch.plugins;
 #endif
 
-	u::vector::removeIf(model::get().channels, [channelId](const channel::Data& c) {
+	model::get().channels.removeIf([channelId](const channel::Data& c) {
 		return c.id == channelId;
 	});
-	model::swap(model::SwapType::HARD);
-
 	if (wave != nullptr)
-		model::remove<Wave>(*wave);
+		retireWave_(*wave, nullptr);
+	model::swap(model::SwapType::HARD);
 
 #ifdef WITH_VST
 	pluginHost::freePlugins(plugins);
@@ -366,12 +441,12 @@ void setInToOut(bool v)
 
 float getInVol()
 {
-	return model::get().getChannel(mixer::MASTER_IN_CHANNEL_ID).volume;
+	return model::get().getChannel(mixer::MASTER_IN_CHANNEL_ID).state->volume.getTarget();
 }
 
 float getOutVol()
 {
-	return model::get().getChannel(mixer::MASTER_OUT_CHANNEL_ID).volume;
+	return model::get().getChannel(mixer::MASTER_OUT_CHANNEL_ID).state->volume.getTarget();
 }
 
 bool getInToOut()
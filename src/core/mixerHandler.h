@@ -60,6 +60,19 @@ Loads a new Wave inside a Sample Channel. */
 
 int loadChannel(ID channelId, const std::string& fname);
 
+/* setWaveStreamed
+Reloads the Wave of a Sample Channel from its file, either streamed from disk or
+fully loaded in memory. Begin/end points are preserved. */
+
+int setWaveStreamed(ID channelId, bool streamed);
+
+/* replaceWave
+Puts Wave 'w' in place of the one in Sample Channel 'channelId', keeping 
+begin/end points. The preview channel follows along if it was showing the old
+Wave, which is destroyed once the audio thread is done with it. */
+
+void replaceWave(ID channelId, std::unique_ptr<Wave>&& w);
+
 /* addAndLoadChannel (1)
 Creates a new channels, fills it with a Wave and then add it to the stack. */
 
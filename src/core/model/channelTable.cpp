@@ -0,0 +1,145 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/model/channelTable.h"
+#include <algorithm>
+#include <cassert>
+
+namespace giada::m::model
+{
+ChannelTable& ChannelTable::operator=(const ChannelTable& o)
+{
+	if (this == &o)
+		return *this;
+
+	m_lastVersion      = o.m_lastVersion;
+	m_structureVersion = o.m_structureVersion;
+
+	/* Structural change (channels added or removed): copy everything. This
+	happens rarely, i.e. on HARD swaps. */
+
+	if (m_channels.size() != o.m_channels.size())
+	{
+		m_channels = o.m_channels;
+		m_versions = o.m_versions;
+		return *this;
+	}
+
+	for (std::size_t i = 0; i < m_channels.size(); i++)
+	{
+		if (m_versions[i] == o.m_versions[i])
+			continue;
+		m_channels[i] = o.m_channels[i];
+		m_versions[i] = o.m_versions[i];
+	}
+	return *this;
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::size_t ChannelTable::size() const { return m_channels.size(); }
+bool        ChannelTable::empty() const { return m_channels.empty(); }
+uint64_t    ChannelTable::getStructureVersion() const { return m_structureVersion; }
+
+/* -------------------------------------------------------------------------- */
+
+std::size_t ChannelTable::indexOf(ID id) const
+{
+	auto it = std::find_if(m_channels.begin(), m_channels.end(), [id](const channel::Data& c) {
+		return c.id == id;
+	});
+	assert(it != m_channels.end());
+	return std::distance(m_channels.begin(), it);
+}
+
+/* -------------------------------------------------------------------------- */
+
+const channel::Data& ChannelTable::operator[](std::size_t i) const
+{
+	assert(i < m_channels.size());
+	return m_channels[i];
+}
+
+channel::Data& ChannelTable::operator[](std::size_t i)
+{
+	assert(i < m_channels.size());
+	touch_(i);
+	return m_channels[i];
+}
+
+/* -------------------------------------------------------------------------- */
+
+const channel::Data& ChannelTable::back() const
+{
+	return m_channels.back();
+}
+
+channel::Data& ChannelTable::back()
+{
+	touch_(m_channels.size() - 1);
+	return m_channels.back();
+}
+
+/* -------------------------------------------------------------------------- */
+
+ChannelTable::const_iterator ChannelTable::begin() const { return m_channels.begin(); }
+ChannelTable::const_iterator ChannelTable::end() const { return m_channels.end(); }
+
+ChannelTable::iterator ChannelTable::begin()
+{
+	for (std::size_t i = 0; i < m_channels.size(); i++)
+		touch_(i);
+	return m_channels.begin();
+}
+
+ChannelTable::iterator ChannelTable::end() { return m_channels.end(); }
+
+/* -------------------------------------------------------------------------- */
+
+void ChannelTable::push_back(channel::Data d)
+{
+	m_channels.push_back(std::move(d));
+	m_versions.push_back(0);
+	touch_(m_channels.size() - 1);
+	m_structureVersion++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ChannelTable::clear()
+{
+	m_channels.clear();
+	m_versions.clear();
+	m_structureVersion++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ChannelTable::touch_(std::size_t i)
+{
+	m_versions[i] = ++m_lastVersion;
+}
+} // namespace giada::m::model
@@ -0,0 +1,135 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_MODEL_CHANNEL_TABLE_H
+#define G_MODEL_CHANNEL_TABLE_H
+
+#include "core/channels/channel.h"
+#include "core/types.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace giada::m::model
+{
+/* ChannelTable
+A versioned container of channels, used by the Layout. Each channel carries a
+version stamp that changes every time the channel is accessed for writing. The
+copy-assignment operator, invoked by Swapper on every swap, compares stamps and
+copies only the channels that have changed since the last swap, instead of
+deep-copying the whole table. Read-only access (through a const reference) 
+never touches the stamps, so use it whenever you don't need to modify a channel.
+Channel addresses stay stable across swaps as long as the table is not
+structurally changed (add/remove channels). */
+
+class ChannelTable
+{
+public:
+	using iterator       = std::vector<channel::Data>::iterator;
+	using const_iterator = std::vector<channel::Data>::const_iterator;
+
+	ChannelTable() = default;
+	ChannelTable(const ChannelTable&) = default;
+	ChannelTable(ChannelTable&&)      = default;
+	ChannelTable& operator=(ChannelTable&&) = default;
+
+	/* operator =
+	Versioned copy: only channels with a different stamp are copied over. Falls
+	back to a full copy if the number of channels differs. */
+
+	ChannelTable& operator=(const ChannelTable&);
+
+	std::size_t size() const;
+	bool        empty() const;
+
+	/* getStructureVersion
+	Returns a number that changes every time channels are added or removed. 
+	Useful to invalidate data derived from the channel set (e.g. lookup 
+	tables). */
+
+	uint64_t getStructureVersion() const;
+
+	/* indexOf
+	Returns the index of channel with ID 'id'. The channel must exist. */
+
+	std::size_t indexOf(ID id) const;
+
+	/* operator [], back
+	Non-const versions mark the channel as changed. */
+
+	const channel::Data& operator[](std::size_t i) const;
+	channel::Data&       operator[](std::size_t i);
+	const channel::Data& back() const;
+	channel::Data&       back();
+
+	/* begin, end
+	Non-const versions mark all channels as changed: prefer const iteration or
+	operator [] on specific channels in hot paths. */
+
+	const_iterator begin() const;
+	const_iterator end() const;
+	iterator       begin();
+	iterator       end();
+
+	void push_back(channel::Data d);
+	void clear();
+
+	template <typename F>
+	void removeIf(F&& f)
+	{
+		std::size_t j = 0;
+		for (std::size_t i = 0; i < m_channels.size(); i++)
+		{
+			if (f(std::as_const(m_channels[i])))
+				continue;
+			if (i != j)
+			{
+				m_channels[j] = std::move(m_channels[i]);
+				m_versions[j] = m_versions[i];
+			}
+			j++;
+		}
+		m_channels.erase(m_channels.begin() + j, m_channels.end());
+		m_versions.resize(j);
+		m_structureVersion++;
+	}
+
+private:
+	/* touch_
+	Assigns a brand new version stamp to channel 'i'. Stamps are unique across 
+	the table history, so two channels with the same stamp are guaranteed to
+	hold the same data. */
+
+	void touch_(std::size_t i);
+
+	std::vector<channel::Data> m_channels;
+	std::vector<uint64_t>      m_versions;
+	uint64_t                   m_lastVersion      = 0;
+	uint64_t                   m_structureVersion = 0;
+};
+} // namespace giada::m::model
+
+#endif
@@ -26,6 +26,8 @@
 
 #include "core/model/model.h"
 #include <cassert>
+#include <mutex>
+#include <utility>
 #ifdef G_DEBUG_MODE
 #include "core/channels/channelManager.h"
 #endif
@@ -41,16 +43,36 @@ struct State
 	std::vector<std::unique_ptr<channel::State>> channels;
 };
 
+/* ActionData
+A snapshot of recorded actions. Never modified once published: any change
+produces a brand new snapshot (see setActions()). */
+
+struct ActionData
+{
+	recorder::ActionMap map;
+	ActionTimeline      timeline;
+};
+
 struct Data
 {
 	std::vector<std::unique_ptr<channel::Buffer>> channels;
 	std::vector<std::unique_ptr<Wave>>            waves;
-	recorder::ActionMap                           actions;
+	std::unique_ptr<ActionData>                   actions = std::make_unique<ActionData>();
 #ifdef WITH_VST
 	std::vector<std::unique_ptr<Plugin>> plugins;
 #endif
 };
 
+/* Garbage
+Objects removed from the model, waiting for the realtime thread to pass a
+quiescent point (i.e. the next swap) before being destroyed. */
+
+struct Garbage
+{
+	std::mutex                         mutex;
+	std::vector<std::shared_ptr<void>> objects;
+};
+
 /* -------------------------------------------------------------------------- */
 
 template <typename T>
@@ -67,14 +89,6 @@ auto* get_(S& source, ID id)
 	auto it = getIter_(source, id);
 	return it == source.end() ? nullptr : it->get();
 }
-
-/* -------------------------------------------------------------------------- */
-
-template <typename D, typename T>
-void remove_(D& dest, T& ref)
-{
-	u::vector::removeIf(dest, [&ref](const auto& other) { return other.get() == &ref; });
-}
 } // namespace
 
 /* -------------------------------------------------------------------------- */
@@ -86,44 +100,54 @@ std::function<void(SwapType)> onSwap_ = nullptr;
 Swapper<Layout> layout;
 State           state;
 Data            data;
+Garbage         garbage;
 
 /* -------------------------------------------------------------------------- */
 
-DataLock::DataLock(SwapType t)
-: m_swapType(t)
+namespace
 {
-	get().locked = true;
-	swap(SwapType::NONE);
+template <typename T>
+void retire_(std::unique_ptr<T> p)
+{
+	if (p == nullptr)
+		return;
+	std::scoped_lock lock(garbage.mutex);
+	garbage.objects.push_back(std::shared_ptr<T>(std::move(p)));
 }
 
-DataLock::~DataLock()
+/* -------------------------------------------------------------------------- */
+
+template <typename D, typename T>
+void remove_(D& dest, T& ref)
 {
-	get().locked = false;
-	swap(m_swapType);
+	auto it = u::vector::findIf(dest, [&ref](const auto& other) { return other.get() == &ref; });
+	if (it == dest.end())
+		return;
+	retire_(std::move(*it));
+	dest.erase(it);
 }
+} // namespace
 
 /* -------------------------------------------------------------------------- */
 
 channel::Data& Layout::getChannel(ID id)
 {
-	return const_cast<channel::Data&>(const_cast<const Layout*>(this)->getChannel(id));
+	return channels[channels.indexOf(id)];
 }
 
 const channel::Data& Layout::getChannel(ID id) const
 {
-	auto it = std::find_if(channels.begin(), channels.end(), [id](const channel::Data& c) {
-		return c.id == id;
-	});
-	assert(it != channels.end());
-	return *it;
+	return channels[channels.indexOf(id)];
 }
 
 /* -------------------------------------------------------------------------- */
 
 void init()
 {
-	get().clock.state = &state.clock;
-	get().mixer.state = &state.mixer;
+	get().clock.state  = &state.clock;
+	get().mixer.state  = &state.mixer;
+	get().timeline     = &data.actions->timeline;
+	get().sampleFormat = SampleFormat::FLOAT;
 	swap(SwapType::NONE);
 }
 
@@ -142,6 +166,14 @@ Lock get_RT()
 void swap(SwapType t)
 {
 	layout.swap();
+
+	/* The realtime thread is now reading the new layout: nothing retired before
+	this point is reachable anymore. */
+	{
+		std::scoped_lock lock(garbage.mutex);
+		garbage.objects.clear();
+	}
+
 	if (onSwap_)
 		onSwap_(t);
 }
@@ -170,7 +202,9 @@ T& getAll()
 	if constexpr (std::is_same_v<T, WavePtrs>)
 		return data.waves;
 	if constexpr (std::is_same_v<T, Actions>)
-		return data.actions;
+		return data.actions->map;
+	if constexpr (std::is_same_v<T, ActionTimeline>)
+		return data.actions->timeline;
 	if constexpr (std::is_same_v<T, ChannelBufferPtrs>)
 		return data.channels;
 	if constexpr (std::is_same_v<T, ChannelStatePtrs>)
@@ -184,6 +218,7 @@ template PluginPtrs& getAll<PluginPtrs>();
 #endif
 template WavePtrs&          getAll<WavePtrs>();
 template Actions&           getAll<Actions>();
+template ActionTimeline&    getAll<ActionTimeline>();
 template ChannelBufferPtrs& getAll<ChannelBufferPtrs>();
 template ChannelStatePtrs&  getAll<ChannelStatePtrs>();
 
@@ -280,16 +315,38 @@ void clear()
 {
 #ifdef WITH_VST
 	if constexpr (std::is_same_v<T, PluginPtrs>)
-		data.plugins.clear();
+		for (PluginPtr& p : std::exchange(data.plugins, {}))
+			retire_(std::move(p));
 #endif
 	if constexpr (std::is_same_v<T, WavePtrs>)
-		data.waves.clear();
+		for (WavePtr& w : std::exchange(data.waves, {}))
+			retire_(std::move(w));
+	if constexpr (std::is_same_v<T, ChannelBufferPtrs>)
+		for (ChannelBufferPtr& b : std::exchange(data.channels, {}))
+			retire_(std::move(b));
+	if constexpr (std::is_same_v<T, ChannelStatePtrs>)
+		for (ChannelStatePtr& s : std::exchange(state.channels, {}))
+			retire_(std::move(s));
 }
 
 #ifdef WITH_VST
 template void clear<PluginPtrs>();
 #endif
 template void clear<WavePtrs>();
+template void clear<ChannelBufferPtrs>();
+template void clear<ChannelStatePtrs>();
+
+/* -------------------------------------------------------------------------- */
+
+void setActions(recorder::ActionMap map)
+{
+	auto next = std::make_unique<ActionData>();
+	next->map = std::move(map);
+	next->timeline.build(next->map);
+
+	get().timeline = &next->timeline;
+	retire_(std::exchange(data.actions, std::move(next)));
+}
 
 /* -------------------------------------------------------------------------- */
 
@@ -302,7 +359,7 @@ void debug()
 	puts("model::layout");
 
 	int i = 0;
-	for (const channel::Data& c : get().channels)
+	for (const channel::Data& c : std::as_const(get().channels))
 	{
 		printf("\t%d) - ID=%d name='%s' type=%d columnID=%d state=%p\n",
 		    i++, c.id, c.name.c_str(), (int)c.type, c.columnId, (void*)&c.state);
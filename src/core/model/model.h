@@ -27,8 +27,10 @@
 #ifndef G_RENDER_MODEL_H
 #define G_RENDER_MODEL_H
 
+#include "core/actionTimeline.h"
 #include "core/channels/channel.h"
 #include "core/const.h"
+#include "core/model/channelTable.h"
 #include "core/plugins/plugin.h"
 #include "core/recorder.h"
 #include "core/swapper.h"
@@ -113,13 +115,20 @@ struct Layout
 	Recorder recorder;
 	MidiIn   midiIn;
 
-	std::vector<channel::Data> channels;
+	ChannelTable channels;
 
-	/* locked
-	If locked, Mixer won't process channels. This is used to allow editing the 
-	data (e.g. Actions or Plugins) a channel points to without data races. */
+	/* sampleFormat
+	In-memory format of the project Waves, applied as they are loaded. See 
+	Wave::pack(). */
 
-	bool locked = false;
+	SampleFormat sampleFormat = SampleFormat::FLOAT;
+
+	/* timeline
+	Flat view of the recorded actions, read by the sequencer. It belongs to the
+	current actions snapshot, which is replaced as a whole on every change (see
+	setActions() below). */
+
+	const ActionTimeline* timeline = nullptr;
 };
 
 /* Lock
@@ -145,18 +154,6 @@ enum class SwapType
 
 /* -------------------------------------------------------------------------- */
 
-class DataLock
-{
-public:
-	DataLock(SwapType t = SwapType::HARD);
-	~DataLock();
-
-private:
-	SwapType m_swapType;
-};
-
-/* -------------------------------------------------------------------------- */
-
 /* init
 Initializes the internal layout. */
 
@@ -174,7 +171,10 @@ Lock::get() method (returns ready-only Layout). */
 Lock get_RT();
 
 /* swap
-Swap non-rt layout with the rt one. See 'SwapType' notes above. */
+Swap non-rt layout with the rt one. See 'SwapType' notes above. When this 
+returns the realtime thread has passed a quiescent point, i.e. it is no longer
+reading the previous layout: all objects retired so far (see remove() and 
+setActions()) are destroyed here. */
 
 void swap(SwapType t);
 
@@ -220,6 +220,11 @@ T* find(ID id);
 template <typename T>
 void add(T);
 
+/* remove
+Unlinks an object from the model. Destruction is deferred to the next swap(), 
+as the realtime thread might still be using it. Make sure the object is no
+longer referenced by the non-realtime layout before calling this. */
+
 template <typename T>
 void remove(const T&);
 
@@ -229,6 +234,14 @@ T& back();
 template <typename T>
 void clear();
 
+/* setActions
+Replaces all recorded actions with 'map', RCU-style: a new snapshot (map and 
+timeline) is built here off the realtime thread and linked to the non-realtime 
+layout, while the current one is retired. The realtime thread keeps reading the
+old snapshot, always consistent, until the next swap(). */
+
+void setActions(recorder::ActionMap map);
+
 #ifdef G_DEBUG_MODE
 void debug();
 #endif
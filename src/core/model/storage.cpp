@@ -32,9 +32,15 @@
 #include "core/patch.h"
 #include "core/plugins/pluginManager.h"
 #include "core/recorderHandler.h"
+#include "core/resampler.h"
 #include "core/sequencer.h"
 #include "core/waveManager.h"
+#include "utils/time.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <thread>
+#include <vector>
 
 namespace giada::m::model
 {
@@ -52,7 +58,54 @@ void loadChannels_(const std::vector<patch::Channel>& channels, int samplerate)
 
 void loadActions_(const std::vector<patch::Action>& pactions)
 {
-	getAll<Actions>() = std::move(recorderHandler::deserializeActions(pactions));
+	setActions(recorderHandler::deserializeActions(pactions));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* loadWaves_
+Decodes 'pwaves' on a pool of worker threads, packing them in 'format'. 
+Meanwhile the calling thread runs 'f', then waits for the workers reporting 
+progress through 'onProgress'. The returned Waves keep the patch order, null if
+failed. */
+
+template <typename F>
+std::vector<std::unique_ptr<Wave>> loadWaves_(const std::vector<patch::Wave>& pwaves,
+    SampleFormat format, F f, const std::function<void(std::size_t)>& onProgress)
+{
+	std::vector<std::unique_ptr<Wave>> waves(pwaves.size());
+	std::atomic<std::size_t>           next = 0;
+	std::atomic<std::size_t>           done = 0;
+
+	auto work = [&]() {
+		for (std::size_t i = next++; i < pwaves.size(); i = next++)
+		{
+			waves[i] = waveManager::deserializeWave(pwaves[i], conf::conf.samplerate,
+			    Resampler::toSrcQuality(conf::conf.rsmpQuality));
+			if (waves[i] != nullptr)
+				waves[i]->pack(format);
+			done++;
+		}
+	};
+
+	const std::size_t        count = std::min<std::size_t>(pwaves.size(), std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> workers;
+	for (std::size_t i = 0; i < count; i++)
+		workers.emplace_back(work);
+
+	f();
+
+	while (done.load() < pwaves.size())
+	{
+		onProgress(done.load());
+		u::time::sleep(G_PATCH_LOAD_PROGRESS_RATE_MS);
+	}
+	onProgress(pwaves.size());
+
+	for (std::thread& w : workers)
+		w.join();
+
+	return waves;
 }
 } // namespace
 
@@ -64,12 +117,13 @@ void store(patch::Patch& patch)
 {
 	const Layout& layout = get();
 
-	patch.bars       = layout.clock.bars;
-	patch.beats      = layout.clock.beats;
-	patch.bpm        = layout.clock.bpm;
-	patch.quantize   = layout.clock.quantize;
-	patch.metronome  = sequencer::isMetronomeOn(); // TODO - add bool metronome to Layout
-	patch.samplerate = conf::conf.samplerate;
+	patch.bars         = layout.clock.bars;
+	patch.beats        = layout.clock.beats;
+	patch.bpm          = layout.clock.bpm;
+	patch.quantize     = layout.clock.quantize;
+	patch.metronome    = sequencer::isMetronomeOn(); // TODO - add bool metronome to Layout
+	patch.samplerate   = conf::conf.samplerate;
+	patch.sampleFormat = layout.sampleFormat;
 
 #ifdef WITH_VST
 	for (const auto& p : getAll<PluginPtrs>())
@@ -106,32 +160,60 @@ void store(conf::Conf& conf)
 
 /* -------------------------------------------------------------------------- */
 
-void load(const patch::Patch& patch)
+void load(const patch::Patch& patch, std::function<void(float)> onProgress)
 {
-	DataLock lock;
+	/* The new model is built in the non-realtime layout, while the realtime 
+	thread keeps rendering the old one. Old objects are retired, not destroyed:
+	they go away on the final swap below. */
 
 	/* Clear and re-initialize channels first. */
 
-	get().channels = {};
-	getAll<ChannelBufferPtrs>().clear();
-	getAll<ChannelStatePtrs>().clear();
+	get().channels.clear();
+	clear<ChannelBufferPtrs>();
+	clear<ChannelStatePtrs>();
 
-	/* Load external data first: plug-ins and waves. */
+	clear<WavePtrs>();
+#ifdef WITH_VST
+	clear<PluginPtrs>();
+	const std::size_t plugins = patch.plugins.size();
+#else
+	const std::size_t plugins = 0;
+#endif
+
+	/* Load external data first: waves in background, plug-ins on this thread in
+	the meantime. Progress is measured in loaded objects. */
+
+	const float total       = static_cast<float>(patch.waves.size() + plugins);
+	std::size_t wavesDone   = 0;
+	std::size_t pluginsDone = 0;
+
+	auto progress = [&]() {
+		if (onProgress != nullptr && total > 0)
+			onProgress((wavesDone + pluginsDone) / total);
+	};
 
+	auto loadPlugins = [&]() {
 #ifdef WITH_VST
-	getAll<PluginPtrs>().clear();
-	for (const patch::Plugin& pplugin : patch.plugins)
-		getAll<PluginPtrs>().push_back(pluginManager::deserializePlugin(pplugin, patch.version));
+		for (const patch::Plugin& pplugin : patch.plugins)
+		{
+			getAll<PluginPtrs>().push_back(pluginManager::deserializePlugin(pplugin, patch.version));
+			pluginsDone++;
+			progress();
+		}
 #endif
+	};
 
-	getAll<WavePtrs>().clear();
-	for (const patch::Wave& pwave : patch.waves)
-	{
-		std::unique_ptr<Wave> w = waveManager::deserializeWave(pwave, conf::conf.samplerate,
-		    conf::conf.rsmpQuality);
+	get().sampleFormat = patch.sampleFormat;
+
+	std::vector<std::unique_ptr<Wave>> waves = loadWaves_(patch.waves, patch.sampleFormat, loadPlugins,
+	    [&](std::size_t done) {
+		    wavesDone = done;
+		    progress();
+	    });
+
+	for (std::unique_ptr<Wave>& w : waves)
 		if (w != nullptr)
 			getAll<WavePtrs>().push_back(std::move(w));
-	}
 
 	/* Then load up channels, actions and global properties. */
 
@@ -143,6 +225,8 @@ void load(const patch::Patch& patch)
 	get().clock.beats    = patch.beats;
 	get().clock.bpm      = patch.bpm;
 	get().clock.quantize = patch.quantize;
+
+	swap(SwapType::HARD);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -27,6 +27,8 @@
 #ifndef G_MODEL_STORAGE_H
 #define G_MODEL_STORAGE_H
 
+#include <functional>
+
 namespace giada::m::patch
 {
 struct Patch;
@@ -39,7 +41,18 @@ namespace giada::m::model
 {
 void store(conf::Conf& c);
 void store(patch::Patch& p);
-void load(const patch::Patch& p);
+
+/* load (1)
+Fills the model with the content of patch 'p', then swaps it in one go. Waves 
+are decoded on a pool of worker threads while plug-ins are instantiated on the
+calling thread, as most formats require. 'onProgress', if any, is invoked on 
+the calling thread with the fraction of work done so far, from 0.0 to 1.0. */
+
+void load(const patch::Patch& p, std::function<void(float)> onProgress = nullptr);
+
+/* load (2)
+Fills the model with configuration values. */
+
 void load(const conf::Conf& c);
 } // namespace giada::m::model
 
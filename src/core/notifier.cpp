@@ -0,0 +1,115 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/notifier.h"
+#include <cassert>
+#include <cerrno>
+#if defined(G_OS_WINDOWS)
+#include <windows.h>
+#elif defined(G_OS_LINUX) || defined(G_OS_FREEBSD)
+#include <ctime>
+#endif
+
+namespace giada
+{
+Notifier::Notifier()
+: m_pending(false)
+{
+#if defined(G_OS_MAC)
+	m_semaphore = dispatch_semaphore_create(0);
+#elif defined(G_OS_LINUX) || defined(G_OS_FREEBSD)
+	sem_init(&m_semaphore, /*pshared=*/0, /*value=*/0);
+#elif defined(G_OS_WINDOWS)
+	m_semaphore = CreateSemaphore(nullptr, 0, LONG_MAX, nullptr);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+Notifier::~Notifier()
+{
+#if defined(G_OS_MAC)
+	dispatch_release(m_semaphore);
+#elif defined(G_OS_LINUX) || defined(G_OS_FREEBSD)
+	sem_destroy(&m_semaphore);
+#elif defined(G_OS_WINDOWS)
+	CloseHandle(m_semaphore);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Notifier::notify()
+{
+	/* Post only on the first notification since the last wake up. */
+
+	if (m_pending.exchange(true))
+		return;
+
+#if defined(G_OS_MAC)
+	dispatch_semaphore_signal(m_semaphore);
+#elif defined(G_OS_LINUX) || defined(G_OS_FREEBSD)
+	sem_post(&m_semaphore);
+#elif defined(G_OS_WINDOWS)
+	ReleaseSemaphore(m_semaphore, 1, nullptr);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Notifier::wait(int timeout)
+{
+	bool notified = false;
+
+#if defined(G_OS_MAC)
+	dispatch_time_t t = dispatch_time(DISPATCH_TIME_NOW, static_cast<int64_t>(timeout) * 1000000);
+	notified          = dispatch_semaphore_wait(m_semaphore, t) == 0;
+#elif defined(G_OS_LINUX) || defined(G_OS_FREEBSD)
+	timespec t;
+	clock_gettime(CLOCK_REALTIME, &t);
+	t.tv_sec += timeout / 1000;
+	t.tv_nsec += (timeout % 1000) * 1000000L;
+	if (t.tv_nsec >= 1000000000L)
+	{
+		t.tv_sec += 1;
+		t.tv_nsec -= 1000000000L;
+	}
+	int res;
+	while ((res = sem_timedwait(&m_semaphore, &t)) == -1 && errno == EINTR)
+		;
+	notified = res == 0;
+#elif defined(G_OS_WINDOWS)
+	notified = WaitForSingleObject(m_semaphore, timeout) == WAIT_OBJECT_0;
+#endif
+
+	/* Clear the pending flag with a read-modify-write, so that everything the
+	notifier did before notify() is visible from now on. Notifications sent 
+	after this point will post the semaphore again. */
+
+	m_pending.exchange(false);
+	return notified;
+}
+} // namespace giada
@@ -0,0 +1,77 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_NOTIFIER_H
+#define G_NOTIFIER_H
+
+#include "core/const.h"
+#include <atomic>
+#if defined(G_OS_MAC)
+#include <dispatch/dispatch.h>
+#elif defined(G_OS_LINUX) || defined(G_OS_FREEBSD)
+#include <semaphore.h>
+#endif
+
+namespace giada
+{
+/* Notifier
+Wakes up a thread sleeping in wait(). Multiple notifications sent before the
+sleeping thread wakes up are coalesced into a single one, while a notification
+sent when nobody is waiting is not lost: the next wait() returns immediately.
+notify() is lock-free and never blocks (it's just an atomic exchange plus a 
+semaphore post, which only enters the kernel if the other thread is actually 
+sleeping), so it's safe to call it from the audio thread or the RtMidi 
+callback. */
+
+class Notifier
+{
+public:
+	Notifier();
+	Notifier(const Notifier&) = delete;
+	~Notifier();
+
+	void notify();
+
+	/* wait
+	Blocks until notified or until 'timeout' milliseconds have passed. Returns
+	true if woken up by a notification. */
+
+	bool wait(int timeout);
+
+private:
+	std::atomic<bool> m_pending;
+
+#if defined(G_OS_MAC)
+	dispatch_semaphore_t m_semaphore;
+#elif defined(G_OS_LINUX) || defined(G_OS_FREEBSD)
+	sem_t m_semaphore;
+#elif defined(G_OS_WINDOWS)
+	void* m_semaphore; // HANDLE
+#endif
+};
+} // namespace giada
+
+#endif
@@ -0,0 +1,345 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/offlineRenderer.h"
+#include "core/clock.h"
+#include "core/conf.h"
+#include "core/const.h"
+#include "core/eventDispatcher.h"
+#include "core/kernelAudio.h"
+#include "core/midiScheduler.h"
+#include "core/mixer.h"
+#include "core/mixerHandler.h"
+#include "core/model/model.h"
+#include "core/sequencer.h"
+#include "core/waveStreamer.h"
+#include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
+#include "utils/fs.h"
+#include "utils/log.h"
+#include "utils/string.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sndfile.h>
+#include <thread>
+#include <vector>
+
+namespace giada::m::offlineRenderer
+{
+namespace
+{
+/* Writer_
+Collects audio blocks for a set of files into large chunks and hands them over
+to a background thread that writes them to disk. write() blocks only when 
+G_OFFLINE_MAX_CHUNKS chunks are already waiting, i.e. when the disk can't keep
+up with the renderer. */
+
+class Writer_
+{
+public:
+	~Writer_();
+
+	bool open(const std::vector<std::string>& paths, int channels, int sampleRate);
+
+	/* write
+	Appends the first 'frames' frames of 'b' to file 'file'. */
+
+	void write(std::size_t file, const mcl::AudioBuffer& b, Frame frames);
+
+	/* close
+	Flushes pending chunks, stops the thread and closes all files. Returns false
+	if any write has failed. */
+
+	bool close();
+
+private:
+	struct File
+	{
+		SNDFILE*           handle;
+		std::vector<float> chunk;
+		Frame              frames;
+	};
+
+	struct Chunk
+	{
+		std::size_t        file;
+		std::vector<float> data;
+		Frame              frames;
+	};
+
+	void push_(std::size_t file);
+	void loop_();
+
+	std::vector<File>       m_files;
+	int                     m_channels = 0;
+	std::thread             m_thread;
+	std::mutex              m_mutex;
+	std::condition_variable m_cond;
+	std::deque<Chunk>       m_chunks;
+	bool                    m_running = false;
+	bool                    m_failed  = false;
+};
+
+/* -------------------------------------------------------------------------- */
+
+Writer_::~Writer_()
+{
+	close();
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Writer_::open(const std::vector<std::string>& paths, int channels, int sampleRate)
+{
+	m_channels = channels;
+
+	for (const std::string& path : paths)
+	{
+		SF_INFO header;
+		header.samplerate = sampleRate;
+		header.channels   = channels;
+		header.format     = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+		SNDFILE* handle = sf_open(path.c_str(), SFM_WRITE, &header);
+		if (handle == nullptr)
+		{
+			u::log::print("[offlineRenderer] unable to open %s for writing: %s\n",
+			    path, sf_strerror(handle));
+			close();
+			return false;
+		}
+		m_files.push_back({handle, std::vector<float>(G_OFFLINE_CHUNK_FRAMES * channels), 0});
+	}
+
+	m_running = true;
+	m_thread  = std::thread(&Writer_::loop_, this);
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Writer_::write(std::size_t file, const mcl::AudioBuffer& b, Frame frames)
+{
+	File&     f        = m_files[file];
+	const int channels = std::min(b.countChannels(), m_channels);
+
+	for (Frame i = 0; i < frames; i++)
+	{
+		if (f.frames == G_OFFLINE_CHUNK_FRAMES)
+			push_(file);
+		std::copy(b[i], b[i] + channels, f.chunk.data() + f.frames * m_channels);
+		f.frames++;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Writer_::close()
+{
+	if (m_thread.joinable())
+	{
+		for (std::size_t i = 0; i < m_files.size(); i++)
+			if (m_files[i].frames > 0)
+				push_(i);
+		{
+			std::scoped_lock lock(m_mutex);
+			m_running = false;
+		}
+		m_cond.notify_all();
+		m_thread.join();
+	}
+
+	for (File& f : m_files)
+		sf_close(f.handle);
+	m_files.clear();
+
+	return !m_failed;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Writer_::push_(std::size_t file)
+{
+	File& f = m_files[file];
+
+	std::unique_lock lock(m_mutex);
+	m_cond.wait(lock, [this] { return m_chunks.size() < G_OFFLINE_MAX_CHUNKS; });
+	m_chunks.push_back({file, std::move(f.chunk), f.frames});
+	lock.unlock();
+	m_cond.notify_all();
+
+	f.chunk.assign(G_OFFLINE_CHUNK_FRAMES * m_channels, 0.0f);
+	f.frames = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Writer_::loop_()
+{
+	while (true)
+	{
+		std::unique_lock lock(m_mutex);
+		m_cond.wait(lock, [this] { return !m_chunks.empty() || !m_running; });
+		if (m_chunks.empty())
+			return;
+		Chunk chunk = std::move(m_chunks.front());
+		m_chunks.pop_front();
+		lock.unlock();
+		m_cond.notify_all();
+
+		if (sf_writef_float(m_files[chunk.file].handle, chunk.data.data(), chunk.frames) != chunk.frames)
+		{
+			u::log::print("[offlineRenderer] incomplete write!\n");
+			m_failed = true;
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+mixer::RenderInfo makeRenderInfo_()
+{
+	mixer::RenderInfo info;
+	info.isAudioReady    = true;
+	info.hasInput        = false;
+	info.isClockActive   = true;
+	info.isClockRunning  = true;
+	info.canLineInRec    = false;
+	info.limitOutput     = conf::conf.limitOutput;
+	info.inToOut         = false;
+	info.maxFramesToRec  = 0;
+	info.outVol          = mh::getOutVol();
+	info.inVol           = mh::getInVol();
+	info.recTriggerLevel = conf::conf.recTriggerLevel;
+	info.sampleRate      = conf::conf.samplerate;
+	return info;
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::vector<ID> getStems_()
+{
+	std::vector<ID> ids;
+	for (const channel::Data& c : model::get().channels)
+		if (!c.isInternal())
+			ids.push_back(c.id);
+	return ids;
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+bool render(const Config& c, std::function<void(float)> onProgress)
+{
+	const Frame bufferSize = kernelAudio::getRealBufSize();
+	const Frame total      = c.bars > 0 ? c.bars * clock::getFramesInBar() : std::max(c.loops, 1) * clock::getFramesInLoop();
+
+	if (bufferSize == 0 || total == 0)
+	{
+		u::log::print("[offlineRenderer] nothing to render\n");
+		return false;
+	}
+
+	if (!u::fs::dirExists(c.path) && !u::fs::mkdir(c.path))
+	{
+		u::log::print("[offlineRenderer] unable to create %s\n", c.path);
+		return false;
+	}
+
+	const std::vector<ID> stems = c.stems ? getStems_() : std::vector<ID>();
+
+	std::vector<std::string> paths = {c.path + G_SLASH + "master.wav"};
+	for (ID id : stems)
+		paths.push_back(c.path + G_SLASH + u::string::format("channel-%d.wav", id));
+
+	Writer_ writer;
+	if (!writer.open(paths, G_MAX_IO_CHANS, conf::conf.samplerate))
+		return false;
+
+	u::log::print("[offlineRenderer] rendering %d frames to %s\n", total, c.path);
+
+	/* Take over from the realtime side: mute the audio callback, stop the 
+	event dispatcher thread (events are processed below, once per block) and
+	the MIDI scheduler, which would send messages at wall-clock times. */
+
+	const bool wasActive = model::get().mixer.state->active.load();
+
+	mixer::disable();
+	eventDispatcher::close();
+	midiScheduler::close();
+
+	sequencer::rawStop();
+	sequencer::rawRewind();
+	sequencer::rawStart();
+
+	const mixer::RenderInfo info = makeRenderInfo_();
+	mcl::AudioBuffer        out(bufferSize, G_MAX_IO_CHANS);
+	mcl::AudioBuffer        in;
+
+	for (Frame done = 0; done < total; done += bufferSize)
+	{
+		eventDispatcher::process();
+		waveStreamer::fill();
+
+		out.clear();
+		mixer::render(out, in, info);
+
+		/* The last block may exceed the requested length: write only the 
+		frames that belong to it. */
+
+		const Frame frames = std::min(bufferSize, total - done);
+
+		writer.write(0, out, frames);
+		if (!stems.empty())
+		{
+			const model::Lock rtLock = model::get_RT();
+			for (std::size_t i = 0; i < stems.size(); i++)
+				writer.write(i + 1, rtLock.get().getChannel(stems[i]).buffer->audio, frames);
+		}
+
+		if (onProgress != nullptr)
+			onProgress((done + frames) / static_cast<float>(total));
+	}
+
+	sequencer::rawStop();
+	sequencer::rawRewind();
+	eventDispatcher::process();
+
+	midiScheduler::init();
+	eventDispatcher::init();
+	if (wasActive)
+		mixer::enable();
+
+	const bool ok = writer.close();
+
+	u::log::print("[offlineRenderer] done, %s\n", ok ? "success" : "with errors");
+
+	return ok;
+}
+} // namespace giada::m::offlineRenderer
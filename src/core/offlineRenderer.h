@@ -0,0 +1,62 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_OFFLINE_RENDERER_H
+#define G_OFFLINE_RENDERER_H
+
+#include <functional>
+#include <string>
+
+/* giada::m::offlineRenderer
+Renders the current project to disk as fast as the CPU allows, without a sound
+card. The offline loop takes the place of the audio callback: it feeds 
+mixer::render() with blocks of the configured buffer size, while the event 
+dispatcher and the sequencer (and with it the transport seen by plug-ins) follow
+the offline clock instead of the wall clock. Files are written by a separate 
+thread, so that disk I/O never stalls the rendering. */
+
+namespace giada::m::offlineRenderer
+{
+struct Config
+{
+	std::string path;          // Output directory, created if missing
+	int         loops = 1;     // Length in sequencer loops...
+	int         bars  = 0;     // ...or in bars, if > 0
+	bool        stems = false; // Also write each channel to its own file
+};
+
+/* render
+Rewinds the sequencer and renders the requested length to 'master.wav' in 
+Config::path. With Config::stems, each channel is also written to 
+'channel-<id>.wav', as found in its buffer: after plug-ins, before volume and 
+pan. Channels play as driven by recorded actions. 'onProgress' is called 
+after each block with a value in [0.0, 1.0]. Suspends the realtime audio while
+running. Returns false on I/O errors. */
+
+bool render(const Config& c, std::function<void(float)> onProgress = nullptr);
+} // namespace giada::m::offlineRenderer
+
+#endif
@@ -29,6 +29,7 @@
 #include "deps/json/single_include/nlohmann/json.hpp"
 #include "utils/log.h"
 #include "utils/math.h"
+#include <filesystem>
 #include <fstream>
 
 namespace nl = nlohmann;
@@ -43,14 +44,15 @@ namespace
 {
 void readCommons_(const nl::json& j)
 {
-	patch.name       = j.value(PATCH_KEY_NAME, G_DEFAULT_PATCH_NAME);
-	patch.bars       = j.value(PATCH_KEY_BARS, G_DEFAULT_BARS);
-	patch.beats      = j.value(PATCH_KEY_BEATS, G_DEFAULT_BEATS);
-	patch.bpm        = j.value(PATCH_KEY_BPM, G_DEFAULT_BPM);
-	patch.quantize   = j.value(PATCH_KEY_QUANTIZE, G_DEFAULT_QUANTIZE);
-	patch.lastTakeId = j.value(PATCH_KEY_LAST_TAKE_ID, 0);
-	patch.samplerate = j.value(PATCH_KEY_SAMPLERATE, G_DEFAULT_SAMPLERATE);
-	patch.metronome  = j.value(PATCH_KEY_METRONOME, false);
+	patch.name         = j.value(PATCH_KEY_NAME, G_DEFAULT_PATCH_NAME);
+	patch.bars         = j.value(PATCH_KEY_BARS, G_DEFAULT_BARS);
+	patch.beats        = j.value(PATCH_KEY_BEATS, G_DEFAULT_BEATS);
+	patch.bpm          = j.value(PATCH_KEY_BPM, G_DEFAULT_BPM);
+	patch.quantize     = j.value(PATCH_KEY_QUANTIZE, G_DEFAULT_QUANTIZE);
+	patch.lastTakeId   = j.value(PATCH_KEY_LAST_TAKE_ID, 0);
+	patch.samplerate   = j.value(PATCH_KEY_SAMPLERATE, G_DEFAULT_SAMPLERATE);
+	patch.sampleFormat = static_cast<SampleFormat>(j.value(PATCH_KEY_SAMPLE_FORMAT, 0));
+	patch.metronome    = j.value(PATCH_KEY_METRONOME, false);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -110,8 +112,9 @@ void readWaves_(const nl::json& j, const std::string& basePath)
 	for (const auto& jwave : j[PATCH_KEY_WAVES])
 	{
 		Wave w;
-		w.id   = jwave.value(PATCH_KEY_WAVE_ID, ++id);
-		w.path = basePath + jwave.value(PATCH_KEY_WAVE_PATH, "");
+		w.id       = jwave.value(PATCH_KEY_WAVE_ID, ++id);
+		w.path     = basePath + jwave.value(PATCH_KEY_WAVE_PATH, "");
+		w.streamed = jwave.value(PATCH_KEY_WAVE_STREAMED, false);
 		patch.waves.push_back(w);
 	}
 }
@@ -270,8 +273,9 @@ void writeWaves_(nl::json& j)
 	for (const Wave& w : patch.waves)
 	{
 		nl::json jwave;
-		jwave[PATCH_KEY_WAVE_ID]   = w.id;
-		jwave[PATCH_KEY_WAVE_PATH] = w.path;
+		jwave[PATCH_KEY_WAVE_ID]       = w.id;
+		jwave[PATCH_KEY_WAVE_PATH]     = w.path;
+		jwave[PATCH_KEY_WAVE_STREAMED] = w.streamed;
 
 		j[PATCH_KEY_WAVES].push_back(jwave);
 	}
@@ -292,6 +296,7 @@ void writeCommons_(nl::json& j)
 	j[PATCH_KEY_QUANTIZE]      = patch.quantize;
 	j[PATCH_KEY_LAST_TAKE_ID]  = patch.lastTakeId;
 	j[PATCH_KEY_SAMPLERATE]    = patch.samplerate;
+	j[PATCH_KEY_SAMPLE_FORMAT] = static_cast<int>(patch.sampleFormat);
 	j[PATCH_KEY_METRONOME]     = patch.metronome;
 }
 
@@ -432,11 +437,28 @@ bool write(const std::string& file)
 	writePlugins_(j);
 #endif
 
-	std::ofstream ofs(file);
+	/* Write to a temp file first, then rename it: a crash or a full disk 
+	never leaves a truncated patch behind. */
+
+	const std::string temp = file + ".tmp";
+
+	std::ofstream ofs(temp);
 	if (!ofs.good())
 		return false;
 
 	ofs << j;
+	ofs.close();
+
+	const bool      ok = !ofs.fail();
+	std::error_code ec;
+	if (ok)
+		std::filesystem::rename(temp, file, ec);
+	if (!ok || ec)
+	{
+		u::log::print("[patch::write] unable to write %s\n", file);
+		std::filesystem::remove(temp, ec);
+		return false;
+	}
 	return true;
 }
 
@@ -117,6 +117,7 @@ struct Wave
 {
 	ID          id;
 	std::string path;
+	bool        streamed = false;
 };
 
 #ifdef WITH_VST
@@ -133,15 +134,16 @@ struct Plugin
 
 struct Patch
 {
-	Version     version;
-	std::string name       = G_DEFAULT_PATCH_NAME;
-	int         bars       = G_DEFAULT_BARS;
-	int         beats      = G_DEFAULT_BEATS;
-	float       bpm        = G_DEFAULT_BPM;
-	bool        quantize   = G_DEFAULT_QUANTIZE;
-	int         lastTakeId = 0;
-	int         samplerate = G_DEFAULT_SAMPLERATE;
-	bool        metronome  = false;
+	Version      version;
+	std::string  name         = G_DEFAULT_PATCH_NAME;
+	int          bars         = G_DEFAULT_BARS;
+	int          beats        = G_DEFAULT_BEATS;
+	float        bpm          = G_DEFAULT_BPM;
+	bool         quantize     = G_DEFAULT_QUANTIZE;
+	int          lastTakeId   = 0;
+	int          samplerate   = G_DEFAULT_SAMPLERATE;
+	SampleFormat sampleFormat = SampleFormat::FLOAT; // In-memory format of waves
+	bool         metronome    = false;
 
 	std::vector<Column>  columns;
 	std::vector<Channel> channels;
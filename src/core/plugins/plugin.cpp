@@ -66,6 +66,7 @@ Plugin::Plugin(ID id, std::unique_ptr<juce::AudioPluginInstance> plugin, double
 		midiInParams.emplace_back(0x0, i);
 
 	m_buffer.setSize(G_MAX_IO_CHANS, buffersize);
+	m_midiBuffer.ensureSize(G_MAX_MIDI_BUFFER_BYTES);
 
 	/* Try to set the main bus to the current number of channels. In the future
 	this setup will be performed manually through a proper channel matrix. */
@@ -98,6 +99,8 @@ Plugin::Plugin(const Plugin& o)
 , m_plugin(std::move(pluginManager::makePlugin(o)->m_plugin))
 , m_bypass(o.m_bypass.load())
 {
+	m_buffer.setSize(o.m_buffer.getNumChannels(), o.m_buffer.getNumSamples());
+	m_midiBuffer.ensureSize(G_MAX_MIDI_BUFFER_BYTES);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -228,7 +231,7 @@ void Plugin::setBypass(bool b) { m_bypass.store(b); }
 
 /* -------------------------------------------------------------------------- */
 
-void Plugin::process(juce::AudioBuffer<float>& out, juce::MidiBuffer m)
+void Plugin::process(juce::AudioBuffer<float>& out, const juce::MidiBuffer& m)
 {
 	/* If this is not an instrument (i.e. doesn't accept MIDI), copy the 
 	incoming buffer data into the temporary one. This way FXes will process
@@ -244,7 +247,13 @@ void Plugin::process(juce::AudioBuffer<float>& out, juce::MidiBuffer m)
 	else
 		m_buffer.clear();
 
-	m_plugin->processBlock(m_buffer, m);
+	/* Local copy of the MIDI events. clear() keeps the allocated storage, so 
+	this doesn't allocate unless the preallocated space is exceeded. */
+
+	m_midiBuffer.clear();
+	m_midiBuffer.addEvents(m, 0, -1, 0);
+
+	m_plugin->processBlock(m_buffer, m_midiBuffer);
 
 	/* The local buffer is now filled. Let's try to fill the 'out' one as well
 	by taking into account the bus layout - many plug-ins might have mono output
@@ -71,12 +71,12 @@ public:
 
 	/* process
 	Process the plug-in with audio and MIDI data. The audio buffer is a reference:
-	it has to be altered by the plug-in itself. Conversely, the MIDI buffer must
-	be passed by copy: each plug-in must receive its own copy of the event set, so
-	that any attempt to change/clear the MIDI buffer will only modify the local 
-	copy. */
+	it has to be altered by the plug-in itself. Conversely, each plug-in must 
+	receive its own copy of the MIDI event set, so that any attempt to 
+	change/clear the MIDI buffer will only modify the local copy: events are 
+	copied into a preallocated local buffer. */
 
-	void process(juce::AudioBuffer<float>& b, juce::MidiBuffer m);
+	void process(juce::AudioBuffer<float>& b, const juce::MidiBuffer& m);
 
 	void setState(PluginState p);
 	void setBypass(bool b);
@@ -126,6 +126,7 @@ private:
 	std::unique_ptr<juce::AudioPluginInstance> m_plugin;
 	std::unique_ptr<pluginHost::Info>          m_playHead;
 	juce::AudioBuffer<float>                   m_buffer;
+	juce::MidiBuffer                           m_midiBuffer;
 
 	std::atomic<bool> m_bypass;
 
@@ -30,30 +30,160 @@
 #include "core/channels/channel.h"
 #include "core/clock.h"
 #include "core/const.h"
+#include "core/midiDispatcher.h"
 #include "core/model/model.h"
 #include "core/plugins/plugin.h"
 #include "core/plugins/pluginManager.h"
 #include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
 #include "utils/log.h"
 #include "utils/vector.h"
-#include <cassert>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define G_PLUGIN_HOST_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define G_PLUGIN_HOST_NEON
+#endif
 
 namespace giada::m::pluginHost
 {
 namespace
 {
-std::vector<Plugin*>     plugins_;
-juce::MessageManager*    messageManager_;
-juce::AudioBuffer<float> audioBuffer_;
-ID                       pluginId_;
+std::vector<Plugin*>  plugins_;
+juce::MessageManager* messageManager_;
+ID                    pluginId_;
+
+/* Scratch_
+Working buffers of a thread processing plug-in stacks: the planar audio buffer
+plug-ins work on, and a MIDI buffer for audio stacks, which don't receive MIDI 
+events. The latter is always empty: processPlugins_() clears it after each use. */
+
+struct Scratch_
+{
+	juce::AudioBuffer<float> audio;
+	juce::MidiBuffer         emptyEvents;
+};
+
+/* mainScratch_
+Buffers of the thread driving the mixer: the audio callback, or the offline 
+renderer while the callback is muted. RtAudio gives no chance to run code on 
+its thread before the first block, so these are sized in init() instead. */
+
+Scratch_ mainScratch_;
+
+/* helperScratch_, scratch_
+Render pool helpers process stacks in parallel: each one has its own buffers, 
+pointed to by scratch_ once initThread() has run. Null on any other thread. */
+
+thread_local Scratch_  helperScratch_;
+thread_local Scratch_* scratch_ = nullptr;
+
+/* -------------------------------------------------------------------------- */
+
+/* getScratch_
+Returns the buffers of the calling thread. */
+
+Scratch_& getScratch_()
+{
+	return scratch_ != nullptr ? *scratch_ : mainScratch_;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* allocScratch_
+Sizes buffers for blocks of 'buffersize' frames. Never releases memory: a 
+smaller block size afterwards doesn't allocate. */
+
+void allocScratch_(Scratch_& s, int buffersize)
+{
+	s.audio.setSize(G_MAX_IO_CHANS, buffersize, /*keepExistingContent=*/false,
+	    /*clearExtraSpace=*/false, /*avoidReallocating=*/true);
+	s.emptyEvents.ensureSize(G_MAX_MIDI_BUFFER_BYTES);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* deinterleaveStereo_, interleaveStereo_
+Convert stereo audio between Giada's interleaved layout (LRLR...) and JUCE's
+planar one (LL... RR...), four frames at a time when SIMD is available. */
+
+void deinterleaveStereo_(const float* src, float* l, float* r, int frames)
+{
+	int i = 0;
+#if defined(G_PLUGIN_HOST_SSE2)
+	for (; i + 4 <= frames; i += 4)
+	{
+		__m128 a = _mm_loadu_ps(src + i * 2);     // L0 R0 L1 R1
+		__m128 b = _mm_loadu_ps(src + i * 2 + 4); // L2 R2 L3 R3
+		_mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+#elif defined(G_PLUGIN_HOST_NEON)
+	for (; i + 4 <= frames; i += 4)
+	{
+		float32x4x2_t v = vld2q_f32(src + i * 2);
+		vst1q_f32(l + i, v.val[0]);
+		vst1q_f32(r + i, v.val[1]);
+	}
+#endif
+	for (; i < frames; i++)
+	{
+		l[i] = src[i * 2];
+		r[i] = src[i * 2 + 1];
+	}
+}
+
+void interleaveStereo_(const float* l, const float* r, float* dst, int frames)
+{
+	int i = 0;
+#if defined(G_PLUGIN_HOST_SSE2)
+	for (; i + 4 <= frames; i += 4)
+	{
+		__m128 a = _mm_loadu_ps(l + i);
+		__m128 b = _mm_loadu_ps(r + i);
+		_mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(a, b));
+		_mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(a, b));
+	}
+#elif defined(G_PLUGIN_HOST_NEON)
+	for (; i + 4 <= frames; i += 4)
+	{
+		float32x4x2_t v = {{vld1q_f32(l + i), vld1q_f32(r + i)}};
+		vst2q_f32(dst + i * 2, v);
+	}
+#endif
+	for (; i < frames; i++)
+	{
+		dst[i * 2]     = l[i];
+		dst[i * 2 + 1] = r[i];
+	}
+}
 
 /* -------------------------------------------------------------------------- */
 
+/* giadaToJuceTempBuf_
+Converts buffer from Giada to Juce. Channels not provided by Giada's buffer 
+(e.g. mono input) are silenced. */
+
 void giadaToJuceTempBuf_(const mcl::AudioBuffer& outBuf)
 {
-	for (int i = 0; i < outBuf.countFrames(); i++)
-		for (int j = 0; j < outBuf.countChannels(); j++)
-			audioBuffer_.setSample(j, i, outBuf[i][j]);
+	juce::AudioBuffer<float>& audioBuffer = getScratch_().audio;
+
+	const int    frames   = outBuf.countFrames();
+	const int    channels = outBuf.countChannels();
+	const float* src      = outBuf[0];
+
+	if (channels == 2)
+		deinterleaveStereo_(src, audioBuffer.getWritePointer(0), audioBuffer.getWritePointer(1), frames);
+	else
+		for (int j = 0; j < channels; j++)
+		{
+			float* dst = audioBuffer.getWritePointer(j);
+			for (int i = 0; i < frames; i++)
+				dst[i] = src[i * channels + j];
+		}
+
+	for (int j = channels; j < audioBuffer.getNumChannels(); j++)
+		audioBuffer.clear(j, 0, frames);
 }
 
 /* juceToGiadaOutBuf_
@@ -62,20 +192,34 @@ Converts buffer from Juce to Giada. A note for the future: if we overwrite (=)
 
 void juceToGiadaOutBuf_(mcl::AudioBuffer& outBuf)
 {
-	for (int i = 0; i < outBuf.countFrames(); i++)
-		for (int j = 0; j < outBuf.countChannels(); j++)
-			outBuf[i][j] = audioBuffer_.getSample(j, i);
+	const juce::AudioBuffer<float>& audioBuffer = getScratch_().audio;
+
+	const int frames   = outBuf.countFrames();
+	const int channels = outBuf.countChannels();
+	float*    dst      = outBuf[0];
+
+	if (channels == 2)
+		interleaveStereo_(audioBuffer.getReadPointer(0), audioBuffer.getReadPointer(1), dst, frames);
+	else
+		for (int j = 0; j < channels; j++)
+		{
+			const float* src = audioBuffer.getReadPointer(j);
+			for (int i = 0; i < frames; i++)
+				dst[i * channels + j] = src[i];
+		}
 }
 
 /* -------------------------------------------------------------------------- */
 
 void processPlugins_(const std::vector<Plugin*>& plugins, juce::MidiBuffer& events)
 {
+	juce::AudioBuffer<float>& audioBuffer = getScratch_().audio;
+
 	for (Plugin* p : plugins)
 	{
 		if (!p->valid || p->isSuspended() || p->isBypassed())
 			continue;
-		p->process(audioBuffer_, events);
+		p->process(audioBuffer, events);
 	}
 	events.clear();
 }
@@ -110,6 +254,7 @@ void close()
 {
 	messageManager_->deleteInstance();
 	model::clear<model::PluginPtrs>();
+	model::swap(model::SwapType::NONE); // Destroy retired plug-ins right away
 }
 
 /* -------------------------------------------------------------------------- */
@@ -117,8 +262,16 @@ void close()
 void init(int buffersize)
 {
 	messageManager_ = juce::MessageManager::getInstance();
-	audioBuffer_.setSize(G_MAX_IO_CHANS, buffersize);
-	pluginId_ = 0;
+	pluginId_       = 0;
+	allocScratch_(mainScratch_, buffersize);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void initThread(int buffersize)
+{
+	allocScratch_(helperScratch_, buffersize);
+	scratch_ = &helperScratch_;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -126,7 +279,12 @@ void init(int buffersize)
 void processStack(mcl::AudioBuffer& outBuf, const std::vector<Plugin*>& plugins,
     juce::MidiBuffer* events)
 {
-	assert(outBuf.countFrames() == audioBuffer_.getNumSamples());
+	/* Buffers are sized up front for the stream's block size. Drivers may 
+	deliver shorter blocks, which just shrink the view: no allocation. */
+
+	Scratch_& scratch = getScratch_();
+	if (outBuf.countFrames() != scratch.audio.getNumSamples())
+		allocScratch_(scratch, outBuf.countFrames());
 
 	/* If events are null: Audio stack processing (master in, master out or
 	sample channels. No need for MIDI events. 
@@ -136,12 +294,11 @@ void processStack(mcl::AudioBuffer& outBuf, const std::vector<Plugin*>& plugins,
 	if (events == nullptr)
 	{
 		giadaToJuceTempBuf_(outBuf);
-		juce::MidiBuffer dummyEvents; // empty
-		processPlugins_(plugins, dummyEvents);
+		processPlugins_(plugins, scratch.emptyEvents);
 	}
 	else
 	{
-		audioBuffer_.clear();
+		scratch.audio.clear();
 		processPlugins_(plugins, *events);
 	}
 	juceToGiadaOutBuf_(outBuf);
@@ -160,6 +317,7 @@ void addPlugin(std::unique_ptr<Plugin> p, ID channelId)
 	only in the Plugin class? */
 	model::get().getChannel(channelId).plugins.push_back(const_cast<Plugin*>(&pluginRef));
 	model::swap(model::SwapType::HARD);
+	midiDispatcher::invalidateRoutes();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -172,6 +330,7 @@ void swapPlugin(const m::Plugin& p1, const m::Plugin& p2, ID channelId)
 	std::swap(pvec.at(index1), pvec.at(index2));
 
 	model::swap(model::SwapType::HARD);
+	midiDispatcher::invalidateRoutes();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -180,6 +339,7 @@ void freePlugin(const m::Plugin& plugin, ID channelId)
 {
 	u::vector::remove(model::get().getChannel(channelId).plugins, &plugin);
 	model::swap(model::SwapType::HARD);
+	midiDispatcher::invalidateRoutes();
 	model::remove(plugin);
 }
 
@@ -188,6 +348,7 @@ void freePlugins(const std::vector<Plugin*>& plugins)
 	// TODO - channels???
 	for (const Plugin* p : plugins)
 		model::remove(*p);
+	midiDispatcher::invalidateRoutes();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -200,6 +361,7 @@ std::vector<Plugin*> clonePlugins(const std::vector<Plugin*>& plugins)
 		model::add(pluginManager::makePlugin(*p));
 		out.push_back(&model::back<Plugin>());
 	}
+	midiDispatcher::invalidateRoutes();
 	return out;
 }
 
@@ -51,9 +51,20 @@ struct Info : public juce::AudioPlayHead
 
 /* -------------------------------------------------------------------------- */
 
+/* init
+Initializes the host and sizes the scratch buffers of the thread driving the 
+mixer (the audio callback) for blocks of 'buffersize' frames. */
+
 void init(int buffersize);
 void close();
 
+/* initThread
+Allocates the scratch buffers of the calling render pool helper. Each helper 
+has its own: call this once on every helper before it processes any block, so
+that no allocation takes place in the realtime path. */
+
+void initThread(int buffersize);
+
 /* addPlugin
 Adds a new plugin to channel 'channelId'. */
 
@@ -0,0 +1,122 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_RAMP_H
+#define G_RAMP_H
+
+#include "core/const.h"
+#include "core/types.h"
+#include "core/weakAtomic.h"
+#include <algorithm>
+
+namespace giada
+{
+/* Ramp
+A parameter that glides linearly towards its target value instead of jumping
+to it, so that changes don't click. Any thread can set the target, while the
+current value is owned and advanced by the audio thread. Each new target 
+restarts the glide from the current value, so that a stream of targets (e.g. a 
+knob sweep) turns into a continuous curve. */
+
+class Ramp
+{
+public:
+	/* Block
+	What happened within a block of audio: the value moved linearly from 
+	'start' to 'end' over the first 'frames' frames, then stayed still. */
+
+	struct Block
+	{
+		float start;
+		float end;
+		Frame frames;
+	};
+
+	Ramp(float v)
+	: m_target(v)
+	, m_value(v)
+	, m_last(v)
+	, m_step(0.0f)
+	, m_left(0)
+	{
+	}
+
+	float getTarget() const
+	{
+		return m_target.load();
+	}
+
+	void setTarget(float v)
+	{
+		m_target.store(v);
+	}
+
+	/* jump
+	Sets value and target at once, with no glide. Not for the audio thread to
+	race with: use it on channels not being rendered yet. */
+
+	void jump(float v)
+	{
+		m_target.store(v);
+		m_value = v;
+		m_last  = v;
+		m_left  = 0;
+	}
+
+	/* advance
+	Moves the ramp forward by a block of 'frames' frames. Audio thread only. */
+
+	Block advance(Frame frames)
+	{
+		const float target = m_target.load();
+		if (target != m_last)
+		{
+			m_last = target;
+			m_step = (target - m_value) / G_PARAM_RAMP_FRAMES;
+			m_left = G_PARAM_RAMP_FRAMES;
+		}
+
+		Block b{m_value, m_value, 0};
+		if (m_left == 0)
+			return b;
+
+		b.frames = std::min(frames, m_left);
+		m_left -= b.frames;
+		m_value = m_left == 0 ? target : m_value + m_step * b.frames;
+		b.end   = m_value;
+		return b;
+	}
+
+private:
+	WeakAtomic<float> m_target;
+	float             m_value; // Current value
+	float             m_last;  // Last target seen by advance()
+	float             m_step;  // Increment per frame
+	Frame             m_left;  // Frames to go until target
+};
+} // namespace giada
+
+#endif
@@ -26,6 +26,7 @@
 
 #include "core/recorder.h"
 #include "core/action.h"
+#include "core/actionTimeline.h"
 #include "core/idManager.h"
 #include "core/model/model.h"
 #include "utils/log.h"
@@ -74,6 +75,19 @@ void updateMapPointers_(ActionMap& src)
 
 /* -------------------------------------------------------------------------- */
 
+/* publish_
+Makes 'map' the new set of recorded actions. The realtime thread keeps reading
+the previous snapshot until the swap, so no locking is needed. Pointers in 'map'
+must be already up to date. */
+
+void publish_(ActionMap map)
+{
+	model::setActions(std::move(map));
+	model::swap(model::SwapType::HARD);
+}
+
+/* -------------------------------------------------------------------------- */
+
 /* optimize
 Removes frames without actions. */
 
@@ -87,13 +101,12 @@ void optimize_(ActionMap& map)
 
 void removeIf_(std::function<bool(const Action&)> f)
 {
-	model::DataLock lock;
-
-	ActionMap& map = model::getAll<model::Actions>();
+	ActionMap map = model::getAll<model::Actions>();
 	for (auto& [frame, actions] : map)
 		actions.erase(std::remove_if(actions.begin(), actions.end(), f), actions.end());
 	optimize_(map);
 	updateMapPointers_(map);
+	publish_(std::move(map));
 }
 
 /* -------------------------------------------------------------------------- */
@@ -127,8 +140,7 @@ void init()
 
 void clearAll()
 {
-	model::DataLock lock;
-	model::getAll<model::Actions>().clear();
+	publish_({});
 }
 
 /* -------------------------------------------------------------------------- */
@@ -181,28 +193,29 @@ void updateKeyFrames(std::function<Frame(Frame old)> f)
 	}
 
 	updateMapPointers_(temp);
-
-	model::DataLock lock;
-	model::getAll<model::Actions>() = std::move(temp);
+	publish_(std::move(temp));
 }
 
 /* -------------------------------------------------------------------------- */
 
 void updateEvent(ID id, MidiEvent e)
 {
-	model::DataLock lock;
-	findAction_(model::getAll<model::Actions>(), id)->event = e;
+	ActionMap map = model::getAll<model::Actions>();
+	updateMapPointers_(map);
+	findAction_(map, id)->event = e;
+	publish_(std::move(map));
 }
 
 /* -------------------------------------------------------------------------- */
 
 void updateSiblings(ID id, ID prevId, ID nextId)
 {
-	model::DataLock lock;
+	ActionMap map = model::getAll<model::Actions>();
+	updateMapPointers_(map);
 
-	Action* pcurr = findAction_(model::getAll<model::Actions>(), id);
-	Action* pprev = findAction_(model::getAll<model::Actions>(), prevId);
-	Action* pnext = findAction_(model::getAll<model::Actions>(), nextId);
+	Action* pcurr = findAction_(map, id);
+	Action* pprev = findAction_(map, prevId);
+	Action* pnext = findAction_(map, nextId);
 
 	pcurr->prev   = pprev;
 	pcurr->prevId = pprev->id;
@@ -219,6 +232,8 @@ void updateSiblings(ID id, ID prevId, ID nextId)
 		pnext->prev   = pcurr;
 		pnext->prevId = pcurr->id;
 	}
+
+	publish_(std::move(map));
 }
 
 /* -------------------------------------------------------------------------- */
@@ -262,10 +277,10 @@ Action rec(ID channelId, Frame frame, MidiEvent event)
 	/* If key frame doesn't exist yet, the [] operator in std::map is smart 
 	enough to insert a new item first. No plug-in data for now. */
 
-	model::DataLock lock;
-
-	model::getAll<model::Actions>()[frame].push_back(a);
-	updateMapPointers_(model::getAll<model::Actions>());
+	ActionMap map = model::getAll<model::Actions>();
+	map[frame].push_back(a);
+	updateMapPointers_(map);
+	publish_(std::move(map));
 
 	return a;
 }
@@ -277,23 +292,20 @@ void rec(std::vector<Action>& actions)
 	if (actions.size() == 0)
 		return;
 
-	model::DataLock lock;
-
-	ActionMap& map = model::getAll<model::Actions>();
+	ActionMap map = model::getAll<model::Actions>();
 
 	for (const Action& a : actions)
 		if (!exists_(a.channelId, a.frame, a.event, map))
 			map[a.frame].push_back(a);
 	updateMapPointers_(map);
+	publish_(std::move(map));
 }
 
 /* -------------------------------------------------------------------------- */
 
 void rec(ID channelId, Frame f1, Frame f2, MidiEvent e1, MidiEvent e2)
 {
-	model::DataLock lock;
-
-	ActionMap& map = model::getAll<model::Actions>();
+	ActionMap map = model::getAll<model::Actions>();
 
 	map[f1].push_back(makeAction(0, channelId, f1, e1));
 	map[f2].push_back(makeAction(0, channelId, f2, e2));
@@ -304,6 +316,7 @@ void rec(ID channelId, Frame f1, Frame f2, MidiEvent e1, MidiEvent e2)
 	a2->prevId = a1->id;
 
 	updateMapPointers_(map);
+	publish_(std::move(map));
 }
 
 /* -------------------------------------------------------------------------- */
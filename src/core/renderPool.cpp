@@ -0,0 +1,207 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/renderPool.h"
+#include "core/const.h"
+#include "utils/log.h"
+#include <algorithm>
+#include <cassert>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(G_OS_WINDOWS)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace giada
+{
+namespace
+{
+uint64_t pack_(uint32_t generation, std::size_t count, std::size_t next)
+{
+	return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(count) << 16) | next;
+}
+
+std::size_t getCount_(uint64_t cursor) { return (cursor >> 16) & 0xFFFF; }
+std::size_t getNext_(uint64_t cursor) { return cursor & 0xFFFF; }
+
+/* -------------------------------------------------------------------------- */
+
+void pause_()
+{
+#if defined(__SSE2__) || defined(_M_X64)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* setRealtimePriority_
+Raises the priority of the calling thread, so that helpers are not preempted by
+ordinary threads while the audio thread waits for them. Unprivileged users might
+not be allowed to do so: helpers keep running at normal priority then. */
+
+void setRealtimePriority_()
+{
+#if defined(G_OS_WINDOWS)
+	if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+		u::log::print("[RenderPool] can't set realtime priority\n");
+#else
+	sched_param param;
+	param.sched_priority = std::min(G_RENDER_THREAD_PRIORITY, sched_get_priority_max(SCHED_FIFO));
+	if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+		u::log::print("[RenderPool] can't set realtime priority\n");
+#endif
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+RenderPool::RenderPool()
+: m_running(false)
+, m_cursor(0)
+, m_done(0)
+, m_generation(0)
+, m_job(nullptr)
+, m_ctx(nullptr)
+{
+}
+
+/* -------------------------------------------------------------------------- */
+
+RenderPool::~RenderPool()
+{
+	stop();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void RenderPool::start(int threads, std::function<void()> onStart)
+{
+	assert(m_helpers.empty());
+
+	/* More threads than cores would only make the caller wait for helpers that
+	have been preempted while holding a job. */
+
+	const int cores = static_cast<int>(std::thread::hardware_concurrency());
+	if (cores > 0)
+		threads = std::min(threads, cores);
+
+	m_running.store(true);
+	for (int i = 1; i < threads; i++)
+	{
+		m_helpers.push_back(std::make_unique<Helper>());
+		Helper& h = *m_helpers.back();
+		h.thread  = std::thread([this, &h, onStart]() { loop_(h, onStart); });
+	}
+
+	u::log::print("[RenderPool::start] %d render threads\n", countThreads());
+}
+
+/* -------------------------------------------------------------------------- */
+
+void RenderPool::stop()
+{
+	m_running.store(false);
+	for (std::unique_ptr<Helper>& h : m_helpers)
+	{
+		h->notifier.notify();
+		if (h->thread.joinable())
+			h->thread.join();
+	}
+	m_helpers.clear();
+}
+
+/* -------------------------------------------------------------------------- */
+
+int RenderPool::countThreads() const
+{
+	return static_cast<int>(m_helpers.size()) + 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void RenderPool::dispatch_(std::size_t count)
+{
+	/* Reset the completion counter before publishing the new batch: helpers
+	can't claim (and complete) any job before the cursor is stored. */
+
+	m_done.store(0, std::memory_order_relaxed);
+	m_cursor.store(pack_(++m_generation, count, 0), std::memory_order_release);
+
+	for (std::unique_ptr<Helper>& h : m_helpers)
+		h->notifier.notify();
+
+	work_();
+
+	/* Jobs claimed by helpers might still be running. */
+
+	while (m_done.load(std::memory_order_acquire) < count)
+		pause_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void RenderPool::work_()
+{
+	/* The generation in the cursor guarantees that a stale helper, still
+	holding a value from a previous batch, fails the exchange instead of 
+	claiming a job that belongs to nobody. */
+
+	uint64_t cursor = m_cursor.load(std::memory_order_acquire);
+	while (getNext_(cursor) < getCount_(cursor))
+	{
+		if (!m_cursor.compare_exchange_weak(cursor, cursor + 1, std::memory_order_acq_rel,
+		        std::memory_order_acquire))
+			continue;
+		m_job(m_ctx, getNext_(cursor));
+		m_done.fetch_add(1, std::memory_order_release);
+		cursor += 1;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void RenderPool::loop_(Helper& h, std::function<void()> onStart)
+{
+	setRealtimePriority_();
+	if (onStart != nullptr)
+		onStart();
+
+	while (m_running.load() == true)
+	{
+		h.notifier.wait(G_RENDER_THREAD_TIMEOUT_MS);
+		work_();
+	}
+}
+} // namespace giada
@@ -0,0 +1,127 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_RENDER_POOL_H
+#define G_RENDER_POOL_H
+
+#include "core/notifier.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace giada
+{
+/* RenderPool
+Set of pre-spawned helper threads that share a batch of independent jobs with
+the thread calling run(), which takes part in the work too. Jobs are claimed one
+at a time from a shared atomic cursor, so a thread that is done with a cheap job
+immediately grabs the next one and the load balances itself. No locks nor 
+allocations take place in run(): it's safe to call it from the audio thread. */
+
+class RenderPool
+{
+public:
+	RenderPool();
+	RenderPool(const RenderPool&) = delete;
+	~RenderPool();
+
+	/* start
+	Spawns 'threads' - 1 helper threads, the one calling run() completes the
+	count. Never spawns more threads than available cores. 'onStart' is invoked once on each helper before it picks up any job, 
+	and it's the place for thread-local allocations. */
+
+	void start(int threads, std::function<void()> onStart = nullptr);
+
+	void stop();
+
+	/* countThreads
+	Returns the number of threads taking part in run(), caller included. */
+
+	int countThreads() const;
+
+	/* run
+	Calls job(i) for each i in [0, count) across the pool and returns when all
+	calls are over. The order in which jobs are executed is undefined. Must be
+	called by one thread at a time. */
+
+	template <typename F>
+	void run(std::size_t count, F& job)
+	{
+		if (m_helpers.empty() || count > MAX_JOBS)
+		{
+			for (std::size_t i = 0; i < count; i++)
+				job(i);
+			return;
+		}
+		m_job = [](void* ctx, std::size_t i) { (*static_cast<F*>(ctx))(i); };
+		m_ctx = &job;
+		dispatch_(count);
+	}
+
+private:
+	/* MAX_JOBS
+	The cursor packs the generation (32 bits), the job count (16 bits) and the 
+	next job to claim (16 bits) in a single atomic word. Larger batches are run
+	serially. */
+
+	static constexpr std::size_t MAX_JOBS = 0xFFFF;
+
+	struct Helper
+	{
+		std::thread thread;
+		Notifier    notifier;
+	};
+
+	void dispatch_(std::size_t count);
+
+	/* work_
+	Claims and runs jobs until the current batch is exhausted. */
+
+	void work_();
+
+	void loop_(Helper& h, std::function<void()> onStart);
+
+	std::vector<std::unique_ptr<Helper>> m_helpers;
+	std::atomic<bool>                    m_running;
+	std::atomic<uint64_t>                m_cursor;
+	std::atomic<std::size_t>             m_done;
+	uint32_t                             m_generation;
+
+	/* m_job, m_ctx
+	Current batch. Written by run() before publishing the cursor and left 
+	untouched until all its jobs are done, so helpers can read them without 
+	synchronization once they have claimed a job. */
+
+	void (*m_job)(void*, std::size_t);
+	void* m_ctx;
+};
+} // namespace giada
+
+#endif
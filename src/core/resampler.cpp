@@ -25,6 +25,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "core/resampler.h"
+#include "core/dsp.h"
 #include <algorithm>
 #include <cassert>
 #include <new>
@@ -34,13 +35,60 @@
 
 namespace giada::m
 {
+namespace
+{
+Interpolator::Type toInterpolatorType_(Resampler::Quality quality)
+{
+	switch (quality)
+	{
+	case Resampler::Quality::POLYPHASE_FAST:
+		return Interpolator::Type::POLYPHASE_FAST;
+	case Resampler::Quality::POLYPHASE_BEST:
+		return Interpolator::Type::POLYPHASE_BEST;
+	default:
+		return Interpolator::Type::CUBIC;
+	}
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+bool Resampler::isNative(Quality quality)
+{
+	return quality >= Quality::CUBIC;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Resampler::toSrcQuality(int quality)
+{
+	switch (static_cast<Quality>(quality))
+	{
+	case Quality::CUBIC:
+		return SRC_SINC_FASTEST;
+	case Quality::POLYPHASE_FAST:
+		return SRC_SINC_MEDIUM_QUALITY;
+	case Quality::POLYPHASE_BEST:
+		return SRC_SINC_BEST_QUALITY;
+	default:
+		return quality;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
 Resampler::Resampler()
 : m_state(nullptr)
+, m_quality(Quality::SINC_BEST)
 , m_input(nullptr)
 , m_inputPos(0)
 , m_inputLength(0)
 , m_channels(0)
 , m_usedFrames(0)
+, m_packed(nullptr)
+, m_format(SampleFormat::FLOAT)
 {
 }
 
@@ -64,7 +112,7 @@ Resampler::Resampler(const Resampler& o)
 
 /* This is a fake move constructor that makes a copy instead. The SRC_STATE
 object has a callback that, if moved, would still point to the original object.
-TODO: maybe delete the move constructor? */
+Built-in qualities are cheap to copy anyway. */
 
 Resampler::Resampler(Resampler&& o)
 : Resampler()
@@ -79,6 +127,12 @@ Resampler& Resampler::operator=(const Resampler& o)
 	if (this == &o)
 		return *this;
 	alloc(o.m_quality, o.m_channels);
+
+	/* A libsamplerate state can't be cloned and starts over. The built-in one
+	is plain data: the copy carries on seamlessly. */
+
+	if (m_state == nullptr)
+		m_interpolator = o.m_interpolator;
 	return *this;
 }
 
@@ -90,7 +144,7 @@ Resampler& Resampler::operator=(Resampler&& o)
 {
 	if (this == &o)
 		return *this;
-	alloc(o.m_quality, o.m_channels);
+	*this = o;
 	return *this;
 }
 
@@ -98,7 +152,8 @@ Resampler& Resampler::operator=(Resampler&& o)
 
 Resampler::~Resampler()
 {
-	src_delete(m_state);
+	if (m_state != nullptr)
+		src_delete(m_state);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -114,11 +169,6 @@ long Resampler::callback(float** audio)
 {
 	assert(audio != nullptr);
 
-	/* Move pointer properly, taking into account read data and number of 
-	channels in input data. */
-
-	*audio = m_input + (m_inputPos * m_channels);
-
 	/* Returns how many frames have been read in this callback shot. */
 
 	long frames;
@@ -130,6 +180,18 @@ long Resampler::callback(float** audio)
 	else
 		frames = m_inputLength - m_inputPos;
 
+	/* Move pointer properly, taking into account read data and number of 
+	channels in input data. Packed data is decoded first: the chunk stays valid
+	until the next callback, as libsamplerate requires. */
+
+	if (m_packed != nullptr)
+	{
+		dsp::decode(m_chunk.data(), m_packed + (m_inputPos * m_channels), frames * m_channels, m_format);
+		*audio = m_chunk.data();
+	}
+	else
+		*audio = m_input + (m_inputPos * m_channels);
+
 	m_usedFrames += frames;
 	m_inputPos += frames;
 
@@ -142,9 +204,18 @@ void Resampler::alloc(Quality quality, int channels)
 {
 	if (m_state != nullptr)
 		src_delete(m_state);
-	m_state    = src_callback_new(callback, static_cast<int>(quality), channels, nullptr, this);
+	m_state    = nullptr;
 	m_quality  = quality;
 	m_channels = channels;
+
+	if (isNative(quality))
+	{
+		assert(channels == G_MAX_IO_CHANS);
+		m_interpolator = Interpolator(toInterpolatorType_(quality));
+		return;
+	}
+
+	m_state = src_callback_new(callback, static_cast<int>(quality), channels, nullptr, this);
 	if (m_state == nullptr)
 		throw std::bad_alloc();
 	src_reset(m_state);
@@ -155,12 +226,62 @@ void Resampler::alloc(Quality quality, int channels)
 Resampler::Result Resampler::process(float* input, long inputPos, long inputLength,
     float* output, long outputLength, float ratio)
 {
+	if (isNative(m_quality))
+	{
+		const Interpolator::Result res = m_interpolator.process(input + (inputPos * m_channels),
+		    inputLength - inputPos, output, outputLength, ratio);
+		return {res.used, res.generated};
+	}
+
 	assert(m_state != nullptr); // Must be initialized first!
 
 	m_input       = input;
 	m_inputPos    = inputPos;
 	m_inputLength = inputLength;
 	m_usedFrames  = 0;
+	m_packed      = nullptr;
+
+	long generated = src_callback_read(m_state, 1 / ratio, outputLength, output);
+
+	return {m_usedFrames, generated};
+}
+
+/* -------------------------------------------------------------------------- */
+
+Resampler::Result Resampler::process(const uint16_t* input, SampleFormat format,
+    long inputPos, long inputLength, float* output, long outputLength, float ratio)
+{
+	assert(m_channels <= G_MAX_IO_CHANS);
+
+	/* The built-in interpolator is fed one decoded chunk at a time. Whatever it
+	leaves unused in a chunk is decoded again on the next call. */
+
+	if (isNative(m_quality))
+	{
+		Result res = {0, 0};
+		while (res.generated < outputLength && inputPos + res.used < inputLength)
+		{
+			const long pos    = inputPos + res.used;
+			const long frames = std::min<long>(CHUNK_LEN, inputLength - pos);
+
+			dsp::decode(m_chunk.data(), input + (pos * m_channels), frames * m_channels, format);
+
+			const Interpolator::Result r = m_interpolator.process(m_chunk.data(), frames,
+			    output + (res.generated * m_channels), outputLength - res.generated, ratio);
+			res.used += r.used;
+			res.generated += r.generated;
+		}
+		return res;
+	}
+
+	assert(m_state != nullptr);
+
+	m_input       = nullptr;
+	m_inputPos    = inputPos;
+	m_inputLength = inputLength;
+	m_usedFrames  = 0;
+	m_packed      = input;
+	m_format      = format;
 
 	long generated = src_callback_read(m_state, 1 / ratio, outputLength, output);
 
@@ -171,6 +292,9 @@ Resampler::Result Resampler::process(float* input, long inputPos, long inputLeng
 
 void Resampler::last()
 {
-	src_reset(m_state);
+	if (m_state != nullptr)
+		src_reset(m_state);
+	else
+		m_interpolator.reset();
 }
 } // namespace giada::m
@@ -27,7 +27,12 @@
 #ifndef G_RESAMPLER_H
 #define G_RESAMPLER_H
 
+#include "core/const.h"
+#include "core/interpolator.h"
+#include "core/types.h"
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <samplerate.h>
 
 namespace giada::m
@@ -35,15 +40,34 @@ namespace giada::m
 class Resampler final
 {
 public:
+	/* Quality
+	The first five values match libsamplerate's converters. The others select 
+	the built-in Interpolator, which needs no allocation nor external state. */
+
 	enum class Quality
 	{
 		SINC_BEST       = 0,
 		SINC_MEDIUM     = 1,
 		SINC_FASTEST    = 2,
 		ZERO_ORDER_HOLD = 3,
-		LINEAR          = 4
+		LINEAR          = 4,
+		CUBIC           = 5,
+		POLYPHASE_FAST  = 6,
+		POLYPHASE_BEST  = 7
 	};
 
+	/* isNative
+	True if 'quality' is served by the built-in Interpolator. */
+
+	static bool isNative(Quality quality);
+
+	/* toSrcQuality
+	Returns the libsamplerate converter to use for 'quality' where libsamplerate
+	is always in charge, i.e. sample rate conversion of files. Built-in 
+	qualities map to the sinc converter of comparable cost. */
+
+	static int toSrcQuality(int quality);
+
 	/* Result
 	A Result object is returned by the process() function below, containing the 
 	number of frames used from input and generated to output. */
@@ -68,6 +92,13 @@ public:
 	Result process(float* input, long inputPos, long inputLength, float* output,
 	    long outputLength, float ratio);
 
+	/* process (packed)
+	Same as above, for 'input' packed in the 16-bit 'format'. Data is decoded on
+	the fly, one chunk at a time. */
+
+	Result process(const uint16_t* input, SampleFormat format, long inputPos,
+	    long inputLength, float* output, long outputLength, float ratio);
+
 	/* last
 	Call this when you are about to process the last chunk of data. */
 
@@ -84,13 +115,22 @@ private:
 
 	static constexpr int CHUNK_LEN = 256;
 
-	SRC_STATE* m_state;
-	Quality    m_quality;
-	float*     m_input;       // Pointer to input data
-	long       m_inputPos;    // Where to read from input
-	long       m_inputLength; // Total number of frames in input data
-	int        m_channels;    // Number of channels
-	long       m_usedFrames;  // How many frames have been read from input with a process() call
+	SRC_STATE*   m_state;       // nullptr for built-in qualities
+	Interpolator m_interpolator;
+	Quality      m_quality;
+	float*       m_input;       // Pointer to input data
+	long         m_inputPos;    // Where to read from input
+	long         m_inputLength; // Total number of frames in input data
+	int          m_channels;    // Number of channels
+	long         m_usedFrames;  // How many frames have been read from input with a process() call
+
+	/* m_packed, m_format, m_chunk
+	Packed input data, if any, and the buffer it is decoded into, a chunk at a
+	time. */
+
+	const uint16_t*                               m_packed;
+	SampleFormat                                  m_format;
+	std::array<float, CHUNK_LEN * G_MAX_IO_CHANS> m_chunk;
 };
 } // namespace giada::m
 
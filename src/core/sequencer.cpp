@@ -25,6 +25,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "sequencer.h"
+#include "core/actionTimeline.h"
 #include "core/clock.h"
 #include "core/conf.h"
 #include "core/const.h"
@@ -34,6 +35,9 @@
 #include "core/model/model.h"
 #include "core/quantizer.h"
 #include "core/recManager.h"
+#include "core/sync.h"
+#include <algorithm>
+#include <cassert>
 
 namespace giada::m::sequencer
 {
@@ -47,10 +51,26 @@ filled during react(). */
 
 EventBuffer eventBuffer_;
 
+/* actionCursor_
+Index of the next entry in the ActionTimeline to be read. Kept across blocks so
+that the timeline lookup is O(1) while the sequencer runs linearly. */
+
+std::size_t actionCursor_ = 0;
+
 Metronome metronome_;
 
 /* -------------------------------------------------------------------------- */
 
+/* nextMultiple_
+Returns the smallest multiple of 'step' which is >= 'f'. */
+
+Frame nextMultiple_(Frame f, Frame step)
+{
+	return ((f + step - 1) / step) * step;
+}
+
+/* -------------------------------------------------------------------------- */
+
 void rewindQ_(Frame delta)
 {
 	clock::rewind();
@@ -98,41 +118,106 @@ void react(const eventDispatcher::EventBuffer& events)
 
 /* -------------------------------------------------------------------------- */
 
-const EventBuffer& advance(Frame bufferSize)
+void parse(EventBuffer& out, Frame start, Frame bufferSize, Frame framesInLoop,
+    Frame framesInBar, Frame framesInBeat, const ActionTimeline* timeline,
+    std::size_t& cursor, Metronome* metronome)
 {
-	eventBuffer_.clear();
+	assert(framesInLoop > 0 && framesInBar > 0 && framesInBeat > 0);
+
+	Frame global = start % framesInLoop; // wraps around 'framesInLoop'
+	Frame local  = 0;
+
+	/* Position the action cursor on the first action at or after the current
+	frame with a single lookup. Actions are then consumed in order. */
+
+	std::size_t nextAction = timeline != nullptr ? timeline->find(global, cursor) : 0;
+	std::size_t lastAction = timeline != nullptr ? timeline->size() : 0;
 
-	const Frame start        = clock::getCurrentFrame();
-	const Frame end          = start + bufferSize;
-	const Frame framesInLoop = clock::getFramesInLoop();
-	const Frame framesInBar  = clock::getFramesInBar();
-	const Frame framesInBeat = clock::getFramesInBeat();
+	/* Split the block into segments that don't cross the end of the loop. There
+	is usually one segment, two if the loop wraps in this block (or more, with
+	very short loops and very large buffers). Within a segment, global and local
+	frames differ by a constant 'offset'. */
 
-	for (Frame i = start, local = 0; i < end; i++, local++)
+	while (local < bufferSize)
 	{
+		const Frame segmentEnd = global + std::min(bufferSize - local, framesInLoop - global);
+		const Frame offset     = local - global;
 
-		Frame global = i % framesInLoop; // wraps around 'framesInLoop'
+		Frame nextBar  = nextMultiple_(global, framesInBar);
+		Frame nextBeat = nextMultiple_(global, framesInBeat);
 
-		if (global == 0)
-		{
-			eventBuffer_.push_back({EventType::FIRST_BEAT, global, local});
-			metronome_.trigger(Metronome::Click::BEAT, local);
-		}
-		else if (global % framesInBar == 0)
+		/* Jump from one interesting frame to the next one: the closest among 
+		bar, beat and action frames. */
+
+		while (true)
 		{
-			eventBuffer_.push_back({EventType::BAR, global, local});
-			metronome_.trigger(Metronome::Click::BAR, local);
+			const Frame nextActionFrame = nextAction < lastAction ? (*timeline)[nextAction].frame : segmentEnd;
+			const Frame frame           = std::min({nextBar, nextBeat, nextActionFrame});
+
+			if (frame >= segmentEnd)
+				break;
+
+			if (frame == 0)
+			{
+				out.push_back({EventType::FIRST_BEAT, frame, frame + offset});
+				if (metronome != nullptr)
+					metronome->trigger(Metronome::Click::BEAT, frame + offset);
+			}
+			else if (frame == nextBar)
+			{
+				out.push_back({EventType::BAR, frame, frame + offset});
+				if (metronome != nullptr)
+					metronome->trigger(Metronome::Click::BAR, frame + offset);
+			}
+			else if (frame == nextBeat)
+			{
+				if (metronome != nullptr)
+					metronome->trigger(Metronome::Click::BEAT, frame + offset);
+			}
+
+			if (frame == nextBar)
+				nextBar += framesInBar;
+			if (frame == nextBeat)
+				nextBeat += framesInBeat;
+
+			if (frame == nextActionFrame)
+				out.push_back({EventType::ACTIONS, frame, frame + offset, &(*timeline)[nextAction++]});
 		}
-		else if (global % framesInBeat == 0)
+
+		local += segmentEnd - global;
+		global = segmentEnd;
+
+		/* End of loop reached: the next segment (or the next block) reads
+		actions from the beginning. */
+
+		if (global == framesInLoop)
 		{
-			metronome_.trigger(Metronome::Click::BEAT, local);
+			global     = 0;
+			nextAction = 0;
 		}
-
-		const std::vector<Action>* as = recorder::getActionsOnFrame(global);
-		if (as != nullptr)
-			eventBuffer_.push_back({EventType::ACTIONS, global, local, as});
 	}
 
+	if (timeline != nullptr)
+		cursor = nextAction;
+}
+
+/* -------------------------------------------------------------------------- */
+
+const EventBuffer& advance(Frame bufferSize, const ActionTimeline* timeline)
+{
+	eventBuffer_.clear();
+
+	const Frame start = clock::getCurrentFrame();
+	const Frame end   = start + bufferSize;
+
+	parse(eventBuffer_, start, bufferSize, clock::getFramesInLoop(),
+	    clock::getFramesInBar(), clock::getFramesInBeat(), timeline, actionCursor_,
+	    &metronome_);
+
+	/* MIDI clock ticks follow the same beat grid, on the same block. */
+
+	sync::advance(start, bufferSize, clock::getFramesInLoop(), clock::getFramesInBeat());
+
 	/* Advance clock and quantizer after the event parsing. */
 	clock::advance(bufferSize);
 	quantizer.advance(Range<Frame>(start, end), clock::getQuantizerStep());
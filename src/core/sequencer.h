@@ -27,6 +27,7 @@
 #ifndef G_SEQUENCER_H
 #define G_SEQUENCER_H
 
+#include "core/actionTimeline.h"
 #include "core/eventDispatcher.h"
 #include "core/quantizer.h"
 #include <vector>
@@ -35,6 +36,10 @@ namespace mcl
 {
 class AudioBuffer;
 }
+namespace giada::m
+{
+class Metronome;
+} // namespace giada::m
 namespace giada::m::sequencer
 {
 enum class EventType
@@ -46,12 +51,16 @@ enum class EventType
 	ACTIONS
 };
 
+/* Event
+ACTIONS events point to the timeline entry of their frame: channels take their 
+own actions from it with Entry::getActions(). */
+
 struct Event
 {
-	EventType                  type    = EventType::NONE;
-	Frame                      global  = 0;
-	Frame                      delta   = 0;
-	const std::vector<Action>* actions = nullptr;
+	EventType                    type   = EventType::NONE;
+	Frame                        global = 0;
+	Frame                        delta  = 0;
+	const ActionTimeline::Entry* entry  = nullptr;
 };
 
 using EventBuffer = RingBuffer<Event, G_MAX_SEQUENCER_EVENTS>;
@@ -71,9 +80,22 @@ void react(const eventDispatcher::EventBuffer& e);
 /* advance
 Parses sequencer events that might occur in a block and advances the internal 
 quantizer. Returns a reference to the internal EventBuffer filled with events
-(if any). Call this on each new audio block. */
-
-const EventBuffer& advance(Frame bufferSize);
+(if any). Call this on each new audio block. Recorded actions are read from 
+'timeline', taken from the realtime layout, or skipped if null. */
+
+const EventBuffer& advance(Frame bufferSize, const ActionTimeline* timeline);
+
+/* parse
+Fills the EventBuffer 'out' with FIRST_BEAT, BAR and ACTIONS events found in 
+block [start, start + bufferSize), wrapping around 'framesInLoop'. Beat and bar
+boundaries are computed in closed form, so the cost depends on the number of
+events rather than on the block size. Actions are read from 'timeline' (if not
+null) starting from 'cursor', which is then updated for the next block. Clicks
+are triggered on 'metronome', if not null. Used internally by advance(). */
+
+void parse(EventBuffer& out, Frame start, Frame bufferSize, Frame framesInLoop,
+    Frame framesInBar, Frame framesInBeat, const ActionTimeline* timeline,
+    std::size_t& cursor, Metronome* metronome);
 
 /* render
 Renders audio coming out from the sequencer: that is, the metronome! */
@@ -25,27 +25,140 @@
  * -------------------------------------------------------------------------- */
 
 #include "sync.h"
+#include "core/clockPll.h"
 #include "core/conf.h"
 #include "core/kernelAudio.h"
 #include "core/kernelMidi.h"
-#include "core/model/model.h"
+#include "core/midiScheduler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 
 namespace giada::m::sync
 {
 namespace
 {
-/* midiTC*
-MIDI timecode variables. */
+/* sampleRate_, midiTCfps_
+Copies of the current configuration, for the MTC generator. */
 
-int midiTCrate_    = 0; // Send MTC data every midiTCrate_ frames
-int midiTCframes_  = 0;
-int midiTCseconds_ = 0;
-int midiTCminutes_ = 0;
-int midiTChours_   = 0;
+int   sampleRate_ = 0;
+float midiTCfps_  = 0.0f;
+
+/* mtcQuarter_, mtcFrames_
+Number of MTC quarter frames sent and of audio frames elapsed since the last
+rewind. Quarter frames are placed in closed form on the stream of audio frames,
+so that their period doesn't accumulate rounding errors. */
+
+int64_t mtcQuarter_ = 0;
+int64_t mtcFrames_  = 0;
+
+/* pll_, pllTicks_, pllBpm_
+Tempo follower for MIDI_SYNC_CLOCK_S mode, along with the number of ticks 
+received since the last beat and the last tempo sent to the clock. Used by the
+MIDI input thread only. */
+
+ClockPll pll_;
+int      pllTicks_ = 0;
+float    pllBpm_   = 0.0f;
 
 #ifdef WITH_AUDIO_JACK
 JackTransport::State jackStatePrev_;
 #endif
+
+/* -------------------------------------------------------------------------- */
+
+/* getMTCrate_
+Returns the SMPTE rate code sent along with the hours in MTC. Non-standard
+rates are rounded to the closest one. */
+
+int getMTCrate_(float fps)
+{
+	if (fps < 24.5f)
+		return 0; // 24 fps
+	if (fps < 27.5f)
+		return 1; // 25 fps
+	if (fps < 29.99f)
+		return 2; // 29.97 fps, drop frame
+	return 3;     // 30 fps
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getMTCquarter_
+Returns the MTC quarter frame message number 'n' since the last rewind. A full
+timecode is sent in eight pieces, spanning two SMPTE frames. */
+
+uint32_t getMTCquarter_(int64_t n)
+{
+	const int     fps     = std::max(1, static_cast<int>(std::lround(midiTCfps_)));
+	const int     piece   = n % 8;
+	const int64_t frames  = (n / 8) * 2;
+	const int64_t seconds = frames / fps;
+
+	const int ff = frames % fps;
+	const int ss = seconds % 60;
+	const int mm = (seconds / 60) % 60;
+	const int hh = (seconds / 3600) % 24;
+
+	int nibble = 0;
+	switch (piece)
+	{
+	case 0: nibble = ff & 0x0F; break;
+	case 1: nibble = ff >> 4; break;
+	case 2: nibble = ss & 0x0F; break;
+	case 3: nibble = ss >> 4; break;
+	case 4: nibble = mm & 0x0F; break;
+	case 5: nibble = mm >> 4; break;
+	case 6: nibble = hh & 0x0F; break;
+	case 7: nibble = (hh >> 4) | (getMTCrate_(midiTCfps_) << 1); break;
+	}
+
+	return kernelMidi::getIValue(MIDI_MTC_QUARTER, (piece << 4) | nibble, 0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* advanceMTC_
+Schedules the MTC quarter frames that fall in the next 'bufferSize' frames. */
+
+void advanceMTC_(Frame bufferSize)
+{
+	const double step = sampleRate_ / (midiTCfps_ * 4.0);
+
+	while (true)
+	{
+		const int64_t frame = std::llround(mtcQuarter_ * step) - mtcFrames_;
+		if (frame >= bufferSize)
+			break;
+		midiScheduler::schedule(getMTCquarter_(mtcQuarter_++), std::max<Frame>(0, frame));
+	}
+	mtcFrames_ += bufferSize;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* recvMIDItick_
+Feeds the tempo follower with a new tick and, once per beat, passes the tempo 
+on to the clock if it has changed enough. */
+
+void recvMIDItick_(Timestamp t)
+{
+	pll_.tick(t);
+
+	if (++pllTicks_ < G_MIDI_CLOCK_PPQN)
+		return;
+	pllTicks_ = 0;
+
+	if (!pll_.isLocked())
+		return;
+
+	const float bpm = std::clamp(pll_.getBpm(), G_MIN_BPM, G_MAX_BPM);
+	if (std::abs(bpm - pllBpm_) < G_MIDI_CLOCK_BPM_THRESHOLD)
+		return;
+
+	pllBpm_ = bpm;
+	onMidiClockChangeBpm(bpm);
+}
 } // namespace
 
 /* -------------------------------------------------------------------------- */
@@ -57,93 +170,69 @@ std::function<void(float)> onJackChangeBpm = nullptr;
 std::function<void()>      onJackStart     = nullptr;
 std::function<void()>      onJackStop      = nullptr;
 
+std::function<void()>      onMidiClockStart     = nullptr;
+std::function<void()>      onMidiClockContinue  = nullptr;
+std::function<void()>      onMidiClockStop      = nullptr;
+std::function<void(float)> onMidiClockChangeBpm = nullptr;
+
 /* -------------------------------------------------------------------------- */
 
 void init(int sampleRate, float midiTCfps)
 {
-	midiTCrate_ = static_cast<int>((sampleRate / midiTCfps) * G_MAX_IO_CHANS); // stereo values
+	sampleRate_ = sampleRate;
+	midiTCfps_  = midiTCfps;
 }
 
 /* -------------------------------------------------------------------------- */
 
-void sendMIDIsync()
+void advance(Frame start, Frame bufferSize, Frame framesInLoop, Frame framesInBeat)
 {
-	const model::Clock& c = model::get().clock;
-
-	/* Sending MIDI sync while waiting is meaningless. */
-
-	if (c.status == ClockStatus::WAITING)
-		return;
-
-	int currentFrame = c.state->currentFrame.load();
-
-	/* TODO - only Master (_M) is implemented so far. */
-
 	if (conf::conf.midiSync == MIDI_SYNC_CLOCK_M)
 	{
-		if (currentFrame % (c.framesInBeat / 24) == 0)
-			kernelMidi::send(MIDI_CLOCK, -1, -1);
-		return;
+		const uint32_t tick = kernelMidi::getIValue(MIDI_CLOCK, 0, 0);
+		forEachTick(start, bufferSize, framesInLoop, framesInBeat,
+		    [tick](Frame f) { midiScheduler::schedule(tick, f); });
 	}
+	else if (conf::conf.midiSync == MIDI_SYNC_MTC_M)
+		advanceMTC_(bufferSize);
+}
 
-	if (conf::conf.midiSync == MIDI_SYNC_MTC_M)
-	{
-
-		/* check if a new timecode frame has passed. If so, send MIDI TC
-		 * quarter frames. 8 quarter frames, divided in two branches:
-		 * 1-4 and 5-8. We check timecode frame's parity: if even, send
-		 * range 1-4, if odd send 5-8. */
+/* -------------------------------------------------------------------------- */
 
-		if (currentFrame % midiTCrate_ != 0) // no timecode frame passed
-			return;
+void recvMIDIclock(int status, Timestamp t)
+{
+	if (conf::conf.midiSync != MIDI_SYNC_CLOCK_S)
+		return;
 
-		/* frame low nibble
-		 * frame high nibble
-		 * seconds low nibble
-		 * seconds high nibble */
+	assert(onMidiClockStart != nullptr);
+	assert(onMidiClockContinue != nullptr);
+	assert(onMidiClockStop != nullptr);
+	assert(onMidiClockChangeBpm != nullptr);
 
-		if (midiTCframes_ % 2 == 0)
-		{
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTCframes_ & 0x0F) | 0x00, -1);
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTCframes_ >> 4) | 0x10, -1);
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTCseconds_ & 0x0F) | 0x20, -1);
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTCseconds_ >> 4) | 0x30, -1);
-		}
+	switch (status)
+	{
+	case MIDI_CLOCK:
+		recvMIDItick_(t);
+		break;
 
-		/* minutes low nibble
-		 * minutes high nibble
-		 * hours low nibble
-		 * hours high nibble SMPTE frame rate */
+	/* Ticks are counted from the start of the song, so that the tempo is
+	updated on the downbeats of the sender. */
 
-		else
-		{
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTCminutes_ & 0x0F) | 0x40, -1);
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTCminutes_ >> 4) | 0x50, -1);
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTChours_ & 0x0F) | 0x60, -1);
-			kernelMidi::send(MIDI_MTC_QUARTER, (midiTChours_ >> 4) | 0x70, -1);
-		}
+	case MIDI_START:
+		pllTicks_ = 0;
+		onMidiClockStart();
+		break;
 
-		midiTCframes_++;
+	case MIDI_CONTINUE:
+		onMidiClockContinue();
+		break;
 
-		/* check if total timecode frames are greater than timecode fps:
-		 * if so, a second has passed */
+	case MIDI_STOP:
+		onMidiClockStop();
+		break;
 
-		if (midiTCframes_ > conf::conf.midiTCfps)
-		{
-			midiTCframes_ = 0;
-			midiTCseconds_++;
-			if (midiTCseconds_ >= 60)
-			{
-				midiTCminutes_++;
-				midiTCseconds_ = 0;
-				if (midiTCminutes_ >= 60)
-				{
-					midiTChours_++;
-					midiTCminutes_ = 0;
-				}
-			}
-			//u::log::print("%d:%d:%d:%d\n", midiTChours_, midiTCminutes_, midiTCseconds_, midiTCframes_);
-		}
+	default:
+		break;
 	}
 }
 
@@ -151,10 +240,8 @@ void sendMIDIsync()
 
 void sendMIDIrewind()
 {
-	midiTCframes_  = 0;
-	midiTCseconds_ = 0;
-	midiTCminutes_ = 0;
-	midiTChours_   = 0;
+	mtcQuarter_ = 0;
+	mtcFrames_  = 0;
 
 	/* For cueing the slave to a particular start point, Quarter Frame messages 
     are not used. Instead, an MTC Full Frame message should be sent. The Full 
@@ -30,7 +30,10 @@
 #ifdef WITH_AUDIO_JACK
 #include "core/jackTransport.h"
 #endif
+#include "core/const.h"
 #include "types.h"
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 
 namespace giada::m::kernelAudio
@@ -41,10 +44,54 @@ namespace giada::m::sync
 {
 void init(int sampleRate, float midiTCfps);
 
-/* sendMIDIsync
-Generates MIDI sync output data. */
+/* forEachTick
+Calls 'f' with the local frame of each MIDI clock tick (G_MIDI_CLOCK_PPQN per
+beat) found in block [start, start + bufferSize), wrapping around 
+'framesInLoop'. Ticks are computed in closed form on the beat grid used by the
+sequencer, so they land on their exact frame and never drift from the beats. 
+The few frames past the last whole beat of the loop, if any, carry no tick. */
 
-void sendMIDIsync();
+template <typename F>
+void forEachTick(Frame start, Frame bufferSize, Frame framesInLoop, Frame framesInBeat, F f)
+{
+	const Frame ticksEnd = (framesInLoop / framesInBeat) * framesInBeat;
+
+	Frame global = start % framesInLoop;
+	Frame local  = 0;
+
+	while (local < bufferSize)
+	{
+		const Frame segmentEnd = global + std::min(bufferSize - local, framesInLoop - global);
+		const Frame end        = std::min(segmentEnd, ticksEnd);
+
+		for (int64_t k = (int64_t{global} * G_MIDI_CLOCK_PPQN + framesInBeat - 1) / framesInBeat;; k++)
+		{
+			const Frame tick = static_cast<Frame>(k * framesInBeat / G_MIDI_CLOCK_PPQN);
+			if (tick >= end)
+				break;
+			f(local + tick - global);
+		}
+
+		local += segmentEnd - global;
+		global = segmentEnd == framesInLoop ? 0 : segmentEnd;
+	}
+}
+
+/* advance
+Sends MIDI clock ticks or MTC quarter frames due in the next 'bufferSize' 
+frames, each one on its own frame through the midiScheduler. 'start' is the
+current frame of the loop. Called by the sequencer on each block while the 
+clock runs. */
+
+void advance(Frame start, Frame bufferSize, Frame framesInLoop, Frame framesInBeat);
+
+/* recvMIDIclock
+Receives a MIDI real-time message (clock, start, continue, stop) that arrived at
+time 't'. Acts only in MIDI_SYNC_CLOCK_S mode: the tempo is recovered from the
+ticks and passed to onMidiClockChangeBpm at most once per beat, the rest is 
+forwarded to the other onMidiClock[...] callbacks. */
+
+void recvMIDIclock(int status, Timestamp t);
 
 /* sendMIDIrewind
 Rewinds timecode to beat 0 and also send a MTC full frame to cue the slave. */
@@ -70,6 +117,15 @@ extern std::function<void()>      onJackStart;
 extern std::function<void()>      onJackStop;
 
 #endif
+
+/* onMidiClock[...]
+Callbacks called when something happens on the incoming MIDI clock. Invoked by
+the MIDI input thread. */
+
+extern std::function<void()>      onMidiClockStart;
+extern std::function<void()>      onMidiClockContinue;
+extern std::function<void()>      onMidiClockStop;
+extern std::function<void(float)> onMidiClockChangeBpm;
 } // namespace giada::m::sync
 
 #endif
@@ -27,11 +27,14 @@
 #ifndef G_TYPES_H
 #define G_TYPES_H
 
+#include <chrono>
+
 namespace giada
 {
-using ID    = int;
-using Pixel = int;
-using Frame = int;
+using ID        = int;
+using Pixel     = int;
+using Frame     = int;
+using Timestamp = std::chrono::steady_clock::time_point;
 
 enum class Thread
 {
@@ -99,6 +102,19 @@ enum class InputRecMode : int
 	FREE
 };
 
+enum class ProjectAudio : int
+{
+	WAV = 0, // 32-bit float
+	FLAC     // Lossless, at the source bit depth
+};
+
+enum class SampleFormat : int
+{
+	FLOAT = 0, // 32-bit float
+	INT16,     // 16-bit integer, lossless for 8 and 16-bit sources only
+	HALF       // 16-bit float
+};
+
 enum class EventType : int
 {
 	AUTO = 0,
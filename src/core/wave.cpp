@@ -26,43 +26,333 @@
 
 #include "wave.h"
 #include "const.h"
+#include "core/dsp.h"
+#include "core/mappedFile.h"
+#include "core/wavePeaks.h"
+#include "core/waveStream.h"
 #include "utils/fs.h"
 #include "utils/log.h"
 #include "utils/string.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 namespace giada::m
 {
+namespace
+{
+/* peaksJobs_
+Number of peak pyramids being computed in the background, across all Waves. */
+
+std::atomic<unsigned> peaksJobs_ = 0;
+
+/* -------------------------------------------------------------------------- */
+
+/* reservePeaksJob_
+Takes a slot for a background peak computation, one per core at most. Returns
+false if they are all taken. */
+
+bool reservePeaksJob_()
+{
+	const unsigned max  = std::max(1u, std::thread::hardware_concurrency());
+	unsigned       jobs = peaksJobs_.load();
+	while (jobs < max)
+		if (peaksJobs_.compare_exchange_weak(jobs, jobs + 1))
+			return true;
+	return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* makeView_
+Returns a buffer pointing to 'frames' frames of 'b' starting at 'offset', no
+copies involved. */
+
+mcl::AudioBuffer makeView_(const mcl::AudioBuffer& b, Frame offset, Frame frames)
+{
+	if (!b.isAllocd())
+		return {};
+	return mcl::AudioBuffer(b[offset], frames, b.countChannels());
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* makeStorage_
+Moves 'b' into a new shared storage. The data stays where it is in memory. */
+
+std::shared_ptr<mcl::AudioBuffer> makeStorage_(mcl::AudioBuffer&& b)
+{
+	return std::make_shared<mcl::AudioBuffer>(std::move(b));
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
 Wave::Wave(ID id)
 : id(id)
 , m_rate(0)
 , m_bits(0)
 , m_logical(false)
 , m_edited(false)
+, m_dirty(true)
+, m_hash(0)
+, m_mapped(false)
+, m_format(SampleFormat::FLOAT)
+, m_packed(nullptr)
+, m_packedFrames(0)
+, m_packedChannels(0)
 {
 }
 
 /* -------------------------------------------------------------------------- */
 
+/* Copies share audio data and peaks with the original Wave. Data is copied 
+later on, only if edited: see detach(). */
+
 Wave::Wave(const Wave& other)
 : id(other.id)
-, m_buffer(other.getBuffer())
+, m_buffer(makeView_(other.m_buffer, 0, other.m_buffer.countFrames()))
 , m_rate(other.m_rate)
 , m_bits(other.m_bits)
 , m_logical(false)
 , m_edited(false)
+, m_dirty(other.m_dirty)
+, m_hash(other.m_hash)
 , m_path(other.m_path)
+, m_stream(other.isStreamed() ? other.m_stream->reopen() : nullptr)
+, m_storage(other.m_storage)
+, m_mapped(other.m_mapped)
+, m_format(other.m_format)
+, m_packed(other.m_packed)
+, m_packedFrames(other.m_packedFrames)
+, m_packedChannels(other.m_packedChannels)
+, m_source(other.m_source)
+, m_peaks(other.getPeaks())
 {
 }
 
 /* -------------------------------------------------------------------------- */
 
+/* The background job only knows the address of the audio data and of the 
+cancel flag, both unaffected by a move. */
+
+Wave::Wave(Wave&& o) = default;
+
+/* -------------------------------------------------------------------------- */
+
+Wave::~Wave()
+{
+	cancelPeaks_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+Wave& Wave::operator=(Wave&& o)
+{
+	cancelPeaks_();
+
+	id               = o.id;
+	m_buffer         = std::move(o.m_buffer);
+	m_rate           = o.m_rate;
+	m_bits           = o.m_bits;
+	m_logical        = o.m_logical;
+	m_edited         = o.m_edited;
+	m_dirty          = o.m_dirty;
+	m_hash           = o.m_hash;
+	m_path           = std::move(o.m_path);
+	m_stream         = std::move(o.m_stream);
+	m_storage        = std::move(o.m_storage);
+	m_mapped         = o.m_mapped;
+	m_format         = o.m_format;
+	m_packed         = o.m_packed;
+	m_packedFrames   = o.m_packedFrames;
+	m_packedChannels = o.m_packedChannels;
+	m_source         = std::move(o.m_source);
+	m_peaks          = std::move(o.m_peaks);
+	m_peaksJob       = std::move(o.m_peaksJob);
+	m_peaksCancel    = std::move(o.m_peaksCancel);
+	return *this;
+}
+
+/* -------------------------------------------------------------------------- */
+
 void Wave::alloc(Frame size, int channels, int rate, int bits, const std::string& path)
 {
-	m_buffer.alloc(size, channels);
-	m_rate = rate;
-	m_bits = bits;
-	m_path = path;
+	cancelPeaks_();
+
+	std::shared_ptr<mcl::AudioBuffer> storage = makeStorage_(mcl::AudioBuffer(size, channels));
+
+	m_buffer  = makeView_(*storage, 0, size);
+	m_storage = storage;
+	m_mapped  = false;
+	m_rate    = rate;
+	m_bits    = bits;
+	m_path    = path;
+	m_dirty   = true;
+	clearPacked_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::map(std::shared_ptr<MappedFile> f, std::size_t offset, Frame size, int rate,
+    int bits, const std::string& path)
+{
+	cancelPeaks_();
+
+	float* data = reinterpret_cast<float*>(f->getData() + offset);
+
+	m_buffer  = mcl::AudioBuffer(data, size, G_MAX_IO_CHANS);
+	m_storage = f;
+	m_mapped  = true;
+	m_rate    = rate;
+	m_bits    = bits;
+	m_path    = path;
+	m_dirty   = true;
+	clearPacked_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::view(const Wave& src, Frame a, Frame b)
+{
+	assert(!src.isStreamed());
+	assert(a >= 0 && a <= b && b <= src.countFrames());
+
+	cancelPeaks_();
+	m_buffer         = makeView_(src.m_buffer, a, b - a);
+	m_storage        = src.m_storage;
+	m_mapped         = src.m_mapped;
+	m_rate           = src.m_rate;
+	m_bits           = src.m_bits;
+	m_path           = src.m_path;
+	m_dirty          = true;
+	m_format         = src.m_format;
+	m_packed         = src.isPacked() ? src.m_packed + a * src.m_packedChannels : nullptr;
+	m_packedFrames   = src.isPacked() ? b - a : 0;
+	m_packedChannels = src.m_packedChannels;
+	m_source         = a == 0 && b == src.countFrames() ? src.m_source : "";
+	m_peaks          = a == 0 && b == src.countFrames() ? src.getPeaks() : nullptr;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Wave::isShared() const
+{
+	return m_storage.use_count() > 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::detach()
+{
+	if (isPacked())
+	{
+		unpack_();
+		return;
+	}
+	if (!isShared() && !m_mapped)
+		return;
+
+	/* The background peaks job, if any, reads the shared data, which might go
+	away together with the other Waves. */
+
+	cancelPeaks_();
+
+	std::shared_ptr<mcl::AudioBuffer> storage = makeStorage_(mcl::AudioBuffer(m_buffer.countFrames(), m_buffer.countChannels()));
+	storage->set(m_buffer);
+
+	m_buffer  = makeView_(*storage, 0, storage->countFrames());
+	m_storage = storage;
+	m_mapped  = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Wave::pack(SampleFormat format)
+{
+	if (isStreamed())
+		return false;
+	if (format == m_format)
+		return true;
+	if (isPacked())
+		unpack_();
+	if (format == SampleFormat::FLOAT)
+		return true;
+	if (m_buffer.countFrames() == 0)
+		return false;
+
+	if (m_peaksJob.valid())
+	{
+		m_peaksJob.wait();
+		getPeaks();
+	}
+
+	const Frame frames   = m_buffer.countFrames();
+	const int   channels = m_buffer.countChannels();
+
+	auto storage = std::make_shared<std::vector<uint16_t>>(frames * channels);
+	if (!dsp::encode(storage->data(), m_buffer[0], frames * channels, format))
+		return false;
+
+	m_buffer.free();
+
+	m_storage        = storage;
+	m_mapped         = false;
+	m_format         = format;
+	m_packed         = storage->data();
+	m_packedFrames   = frames;
+	m_packedChannels = channels;
+
+	/* Takes and edited Waves don't match any file. */
+
+	if (format == SampleFormat::HALF && !m_logical && !m_edited && u::fs::fileExists(m_path))
+		m_source = m_path;
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::string Wave::getSource() const { return m_source; }
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::read(Frame start, float* out, Frame count) const
+{
+	assert(!isStreamed());
+	assert(start >= 0 && start + count <= countFrames());
+
+	if (isPacked())
+		dsp::decode(out, m_packed + start * m_packedChannels, count * m_packedChannels, m_format);
+	else
+		std::copy_n(m_buffer[start], count * m_buffer.countChannels(), out);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::unpack_()
+{
+	std::shared_ptr<mcl::AudioBuffer> storage = makeStorage_(mcl::AudioBuffer(m_packedFrames, m_packedChannels));
+	dsp::decode((*storage)[0], m_packed, m_packedFrames * m_packedChannels, m_format);
+
+	m_buffer  = makeView_(*storage, 0, m_packedFrames);
+	m_storage = storage;
+	m_mapped  = false;
+	clearPacked_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::clearPacked_()
+{
+	m_format         = SampleFormat::FLOAT;
+	m_packed         = nullptr;
+	m_packedFrames   = 0;
+	m_packedChannels = 0;
+	m_source.clear();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -74,22 +364,53 @@ std::string Wave::getBasename(bool ext) const
 
 /* -------------------------------------------------------------------------- */
 
-int         Wave::getRate() const { return m_rate; }
-std::string Wave::getPath() const { return m_path; }
-int         Wave::getBits() const { return m_bits; }
-bool        Wave::isLogical() const { return m_logical; }
-bool        Wave::isEdited() const { return m_edited; }
+int             Wave::getRate() const { return m_rate; }
+std::string     Wave::getPath() const { return m_path; }
+int             Wave::getBits() const { return m_bits; }
+bool            Wave::isLogical() const { return m_logical; }
+bool            Wave::isEdited() const { return m_edited; }
+bool            Wave::isDirty() const { return m_dirty; }
+uint64_t        Wave::getSavedHash() const { return m_hash; }
+bool            Wave::isStreamed() const { return m_stream != nullptr; }
+WaveStream*     Wave::getStream() const { return m_stream.get(); }
+SampleFormat    Wave::getFormat() const { return m_format; }
+bool            Wave::isPacked() const { return m_format != SampleFormat::FLOAT; }
+const uint16_t* Wave::getPacked() const { return m_packed; }
 
 /* -------------------------------------------------------------------------- */
 
-mcl::AudioBuffer&       Wave::getBuffer() { return m_buffer; }
-const mcl::AudioBuffer& Wave::getBuffer() const { return m_buffer; }
+mcl::AudioBuffer& Wave::getBuffer()
+{
+	assert(!isStreamed() && !isPacked());
+	return m_buffer;
+}
+
+const mcl::AudioBuffer& Wave::getBuffer() const
+{
+	return isStreamed() ? m_stream->getHead() : m_buffer;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Frame Wave::countFrames() const
+{
+	if (isStreamed())
+		return m_stream->countFrames();
+	return isPacked() ? m_packedFrames : m_buffer.countFrames();
+}
+
+int Wave::countChannels() const
+{
+	if (isStreamed())
+		return m_stream->getHead().countChannels();
+	return isPacked() ? m_packedChannels : m_buffer.countChannels();
+}
 
 /* -------------------------------------------------------------------------- */
 
 int Wave::getDuration() const
 {
-	return m_buffer.countFrames() / m_rate;
+	return countFrames() / m_rate;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -103,22 +424,149 @@ std::string Wave::getExtension() const
 
 void Wave::setRate(int v) { m_rate = v; }
 void Wave::setLogical(bool l) { m_logical = l; }
-void Wave::setEdited(bool e) { m_edited = e; }
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::setEdited(bool e)
+{
+	m_edited = e;
+	if (e)
+		m_dirty = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::setClean(uint64_t hash)
+{
+	m_dirty = false;
+	m_hash  = hash;
+}
 
 /* -------------------------------------------------------------------------- */
 
 void Wave::setPath(const std::string& p, int wid)
 {
-	if (wid == -1)
-		m_path = p;
-	else
-		m_path = u::fs::stripExt(p) + "-" + std::to_string(wid) + u::fs::getExt(p);
+	const std::string path = wid == -1 ? p : u::fs::stripExt(p) + "-" + std::to_string(wid) + u::fs::getExt(p);
+	if (path == m_path)
+		return;
+	m_path  = path;
+	m_dirty = true;
+	m_hash  = 0;
 }
 
 /* -------------------------------------------------------------------------- */
 
 void Wave::replaceData(mcl::AudioBuffer&& b)
 {
-	m_buffer = std::move(b);
+	cancelPeaks_();
+
+	std::shared_ptr<mcl::AudioBuffer> storage = makeStorage_(std::move(b));
+
+	m_buffer  = makeView_(*storage, 0, storage->countFrames());
+	m_storage = storage;
+	m_mapped  = false;
+	m_dirty   = true;
+	m_stream.reset();
+	clearPacked_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::setStream(std::unique_ptr<WaveStream> s)
+{
+	cancelPeaks_();
+	m_peaks.reset();
+	m_buffer.free();
+	m_storage.reset();
+	m_mapped = false;
+	clearPacked_();
+	m_rate   = s->getRate();
+	m_bits   = s->getSourceBits();
+	m_path   = s->getPath();
+	m_stream = std::move(s);
+	m_dirty  = false;
+	m_hash   = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::shared_ptr<const WavePeaks> Wave::getPeaks() const
+{
+	if (m_peaksJob.valid() && m_peaksJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		m_peaks = m_peaksJob.get();
+	return m_peaks;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::computePeaks()
+{
+	/* Packed data is never edited: peaks computed before packing still hold. */
+
+	if (isPacked())
+		return;
+
+	cancelPeaks_();
+	m_peaks.reset();
+
+	if (isStreamed() || m_buffer.countFrames() == 0)
+		return;
+
+	/* Too many Waves at once (e.g. a project being loaded): compute peaks here,
+	so that the calling thread does the job instead of yet another one. */
+
+	if (!reservePeaksJob_())
+	{
+		const std::atomic<bool> never = false;
+
+		auto peaks = std::make_shared<WavePeaks>();
+		peaks->build(m_buffer, never);
+		m_peaks = peaks;
+		return;
+	}
+
+	float*                   data     = m_buffer[0];
+	const Frame              frames   = m_buffer.countFrames();
+	const int                channels = m_buffer.countChannels();
+	const std::atomic<bool>& cancel   = *(m_peaksCancel = std::make_unique<std::atomic<bool>>(false));
+
+	m_peaksJob = std::async(std::launch::async, [data, frames, channels, &cancel]() {
+		auto       peaks = std::make_shared<WavePeaks>();
+		const bool done  = peaks->build(mcl::AudioBuffer(data, frames, channels), cancel);
+		peaksJobs_--;
+		return done ? std::shared_ptr<const WavePeaks>(peaks) : nullptr;
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::updatePeaks(Frame a, Frame b)
+{
+	assert(!isPacked());
+
+	std::shared_ptr<const WavePeaks> current = getPeaks();
+	if (current == nullptr)
+	{
+		computePeaks();
+		return;
+	}
+
+	/* Peaks might be shared with the Wave this one has been copied from: 
+	update a copy of them. */
+
+	auto peaks = std::make_shared<WavePeaks>(*current);
+	peaks->update(m_buffer, a, b);
+	m_peaks = peaks;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Wave::cancelPeaks_()
+{
+	if (!m_peaksJob.valid())
+		return;
+	m_peaksCancel->store(true);
+	m_peaksJob.wait();
+	m_peaksJob = {};
 }
 } // namespace giada::m
@@ -29,18 +29,26 @@
 
 #include "core/types.h"
 #include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
 #include <string>
 
 namespace giada::m
 {
+class MappedFile;
+class WaveStream;
+class WavePeaks;
 class Wave
 {
 public:
 	Wave(ID id);
 	Wave(const Wave& o);
-	Wave(Wave&& o) = default;
+	Wave(Wave&& o);
+	~Wave();
 
-	Wave& operator=(Wave&& o) = default;
+	Wave& operator=(Wave&& o);
 
 	std::string getBasename(bool ext = false) const;
 	std::string getExtension() const;
@@ -51,29 +59,157 @@ public:
 	bool        isLogical() const;
 	bool        isEdited() const;
 
+	/* isDirty, getSavedHash
+	A Wave is dirty when the file in its path doesn't hold its current audio 
+	data: it has never been saved, it has been edited or moved to another path.
+	getSavedHash() returns the content hash of the data last written to that 
+	file (see waveManager::hash()), 0 if unknown. */
+
+	bool     isDirty() const;
+	uint64_t getSavedHash() const;
+
+	/* isStreamed
+	True if audio data is read from disk during playback, see WaveStream. */
+
+	bool isStreamed() const;
+
+	/* countFrames
+	Returns the length of the Wave. Use this instead of 
+	getBuffer().countFrames(), which is only the preloaded part of a streamed
+	Wave. */
+
+	Frame countFrames() const;
+	int   countChannels() const;
+
+	/* getFormat, isPacked
+	Format audio data is kept in memory, see pack(). */
+
+	SampleFormat getFormat() const;
+	bool         isPacked() const;
+
 	/* getBuffer
-	Returns a (non-)const reference to the underlying audio buffer. */
+	Returns a (non-)const reference to the underlying audio buffer. For a 
+	streamed Wave this is the preloaded head only, and it's read-only. It's 
+	empty for a packed Wave: use read() instead. Data might be shared with other
+	Waves or packed: call detach() before writing to it. */
 
 	mcl::AudioBuffer&       getBuffer();
 	const mcl::AudioBuffer& getBuffer() const;
 
 	/* setPath
 	Sets new path 'p'. If 'id' != -1 inserts a numeric id next to the file 
-	extension, e.g. : /path/to/sample-[id].wav */
+	extension, e.g. : /path/to/sample-[id].wav . A new path makes the Wave 
+	dirty. */
 
 	void setPath(const std::string& p, int id = -1);
 
 	void setRate(int v);
 	void setLogical(bool l);
+
+	/* setEdited
+	Editing also makes the Wave dirty. */
+
 	void setEdited(bool e);
 
+	/* setClean
+	Marks the Wave as in sync with the file in its path, after audio data has
+	been read from or written to it. 'hash' is the content hash of the data, if
+	known. */
+
+	void setClean(uint64_t hash = 0);
+
 	/* replaceData
-	Replaces internal audio buffer with 'b' by moving it. */
+	Replaces internal audio buffer with 'b' by moving it. Like any other change
+	to audio data, it leaves the peak pyramid as it is: see updatePeaks(). */
 
 	void replaceData(mcl::AudioBuffer&& b);
 
+	/* getStream, setStream
+	Disk stream of a streamed Wave, null otherwise. setStream() drops any audio 
+	data in memory and takes rate, bit depth and path from the stream. */
+
+	WaveStream* getStream() const;
+	void        setStream(std::unique_ptr<WaveStream> s);
+
 	void alloc(Frame size, int channels, int rate, int bits, const std::string& path);
 
+	/* map
+	Like alloc(), but audio data is not allocated: the buffer points to 'size'
+	interleaved stereo frames found at 'offset' bytes into file 'f', which is 
+	kept alive as long as needed. The mapping is read-only: see detach(). */
+
+	void map(std::shared_ptr<MappedFile> f, std::size_t offset, Frame size, int rate,
+	    int bits, const std::string& path);
+
+	/* view
+	Like alloc(), but audio data is not allocated: the buffer points to frames
+	[a, b) of the data of 'src', which must not be streamed. Data is shared
+	until one of the two is edited, see detach(). Peaks are shared too if the
+	range covers the whole Wave. */
+
+	void view(const Wave& src, Frame a, Frame b);
+
+	/* pack
+	Converts audio data in memory to 'format'. A 16-bit format takes half the
+	memory of float data and is decoded on the fly by read(), see SampleFormat.
+	Returns false if the Wave is streamed or empty, or if INT16 can't hold its
+	data without loss: data is left in float then. The peak pyramid can't be 
+	built out of packed data: any background computation is waited for. HALF is
+	lossy: the file data comes from, if any, is remembered (see getSource()). */
+
+	bool pack(SampleFormat format);
+
+	/* getSource
+	File the data of a HALF-packed Wave was read from, still matching it at 
+	full quality. Saving copies it in place of the decoded data. Empty if not 
+	packed as HALF, or if there's no such file. */
+
+	std::string getSource() const;
+
+	/* read [realtime]
+	Copies 'count' interleaved frames starting from 'start' into 'out', decoding
+	them if packed. Not for streamed Waves. */
+
+	void read(Frame start, float* out, Frame count) const;
+
+	/* getPacked
+	Returns packed audio data, interleaved, or nullptr if not packed. */
+
+	const uint16_t* getPacked() const;
+
+	/* isShared
+	True if audio data is shared with other Waves, i.e. copies or views. */
+
+	bool isShared() const;
+
+	/* detach
+	Gives this Wave its own copy of audio data, if shared or mapped, unpacked to
+	float if packed. To be called before editing audio data in place: 
+	copy-on-write. */
+
+	void detach();
+
+	/* getPeaks
+	Returns the peak pyramid used to draw the waveform, or nullptr if it's not 
+	available (yet). To be called by the main thread only. */
+
+	std::shared_ptr<const WavePeaks> getPeaks() const;
+
+	/* computePeaks
+	Drops the current peak pyramid and computes a new one in the background. 
+	Background jobs are bounded to one per core across all Waves: past that, 
+	the pyramid is computed right away on the calling thread, e.g. by the 
+	workers loading a project. */
+
+	void computePeaks();
+
+	/* updatePeaks
+	Refreshes the peak pyramid after frames in range [a, b) have been edited, 
+	or after a change in length from frame 'a' onwards. Falls back to 
+	computePeaks() if there's nothing to update. */
+
+	void updatePeaks(Frame a, Frame b);
+
 	ID id;
 
 private:
@@ -82,7 +218,43 @@ private:
 	int              m_bits;
 	bool             m_logical; // memory only (a take)
 	bool             m_edited;  // edited via editor
+	bool             m_dirty;   // audio data not in sync with file in m_path
+	uint64_t         m_hash;    // Content hash of file in m_path, 0 if unknown
 	std::string      m_path;    // E.g. /path/to/my/sample.wav
+
+	/* m_storage
+	Owner of the memory m_buffer or m_packed look into: a heap buffer, packed 
+	data or a mapped file. Copies and views of this Wave share it, so it's never
+	written to while shared. */
+
+	std::unique_ptr<WaveStream> m_stream;
+	std::shared_ptr<void>       m_storage;
+	bool                        m_mapped; // m_storage is a read-only MappedFile
+
+	/* m_packed, m_packedFrames, m_packedChannels
+	Audio data in m_storage when m_format is not FLOAT, in place of m_buffer. */
+
+	SampleFormat    m_format;
+	const uint16_t* m_packed;
+	Frame           m_packedFrames;
+	int             m_packedChannels;
+	std::string     m_source; // See getSource()
+
+	/* unpack_
+	Decodes packed data into new float storage. */
+
+	void unpack_();
+	void clearPacked_();
+
+	/* cancelPeaks_
+	Stops the background computation of peaks, if any, and waits for it. Must 
+	be called before touching audio data. */
+
+	void cancelPeaks_();
+
+	mutable std::shared_ptr<const WavePeaks>              m_peaks;
+	mutable std::future<std::shared_ptr<const WavePeaks>> m_peaksJob;
+	std::unique_ptr<std::atomic<bool>>                    m_peaksCancel;
 };
 } // namespace giada::m
 
@@ -0,0 +1,380 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/waveCache.h"
+#include "core/const.h"
+#include "core/mappedFile.h"
+#include "core/wave.h"
+#include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
+#include "utils/log.h"
+#include "utils/string.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace stdfs = std::filesystem;
+
+namespace giada::m::waveCache
+{
+namespace
+{
+/* Header
+Fixed-size header of a cache entry, followed by interleaved float frames. */
+
+struct Header
+{
+	char     magic[4];
+	uint32_t version;
+	uint32_t channels;
+	uint32_t rate;
+	uint32_t bits;
+	uint32_t reserved0;
+	uint64_t frames;
+	uint8_t  reserved[32];
+};
+
+static_assert(sizeof(Header) == 64);
+
+/* Stamp
+Size and modification time of a source file when its content was hashed. */
+
+struct Stamp
+{
+	uintmax_t size;
+	int64_t   time;
+	uint64_t  hash;
+};
+
+constexpr char        MAGIC[4]   = {'G', 'W', 'C', 'F'};
+constexpr std::size_t HASH_CHUNK = 1 << 20; // Bytes
+constexpr const char* INDEX_FILE = "index";
+constexpr const char* ENTRY_EXT  = ".f32";
+
+/* dir_
+Cache directory. Empty if the cache is disabled. Written once by init(). */
+
+std::string dir_;
+
+/* index_
+Content hashes of source files by path, so that unchanged files are not read 
+again. Mirrored to INDEX_FILE in the cache directory, one line per update: the
+last line of a path wins. Guarded by indexMutex_. */
+
+std::unordered_map<std::string, Stamp> index_;
+std::mutex                             indexMutex_;
+
+/* -------------------------------------------------------------------------- */
+
+std::string getPath_(const std::string& key)
+{
+	return dir_ + G_SLASH + key;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* writeStamp_
+Appends the index line of 'path' to file 'f'. */
+
+void writeStamp_(std::FILE* f, const std::string& path, const Stamp& s)
+{
+	std::fprintf(f, "%016llx %llu %lld %s\n", static_cast<unsigned long long>(s.hash),
+	    static_cast<unsigned long long>(s.size), static_cast<long long>(s.time), path.c_str());
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* loadIndex_
+Reads the index from disk, then writes it back without stale lines. */
+
+void loadIndex_()
+{
+	const std::string indexPath = getPath_(INDEX_FILE);
+
+	std::scoped_lock lock(indexMutex_);
+	index_.clear();
+
+	if (std::FILE* f = std::fopen(indexPath.c_str(), "r"))
+	{
+		unsigned long long hash, size;
+		long long          time;
+		char               path[4096];
+		while (std::fscanf(f, "%llx %llu %lld %4095[^\n]", &hash, &size, &time, path) == 4)
+			index_[path] = {size, time, hash};
+		std::fclose(f);
+	}
+
+	if (std::FILE* f = std::fopen(indexPath.c_str(), "w"))
+	{
+		for (const auto& [path, stamp] : index_)
+			writeStamp_(f, path, stamp);
+		std::fclose(f);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getStamp_
+Returns size and modification time of file 'path', hash excluded. False if
+the file can't be accessed. */
+
+bool getStamp_(const std::string& path, Stamp& s)
+{
+	std::error_code ec;
+	s.size = stdfs::file_size(path, ec);
+	if (ec)
+		return false;
+	s.time = stdfs::last_write_time(path, ec).time_since_epoch().count();
+	return !ec;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* hash_
+64-bit FNV-1a variant working on 8-byte words, with an extra xor-shift to mix
+the high bits back in. Fast enough to be bound by disk speed. */
+
+uint64_t hash_(std::FILE* f)
+{
+	uint64_t              h = 0xcbf29ce484222325;
+	std::vector<uint64_t> buffer(HASH_CHUNK / sizeof(uint64_t));
+
+	std::size_t read;
+	while ((read = std::fread(buffer.data(), 1, HASH_CHUNK, f)) > 0)
+	{
+		const std::size_t words = (read + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+		std::memset(reinterpret_cast<char*>(buffer.data()) + read, 0, words * sizeof(uint64_t) - read);
+		for (std::size_t i = 0; i < words; i++)
+		{
+			h = (h ^ buffer[i]) * 0x100000001b3;
+			h ^= h >> 29;
+		}
+		h ^= read;
+	}
+	return h;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* trim_
+Deletes leftovers from interrupted writes, then least recently used entries 
+until the cache fits in 'maxBytes'. */
+
+void trim_(uintmax_t maxBytes)
+{
+	struct Entry
+	{
+		stdfs::path           path;
+		stdfs::file_time_type time;
+		uintmax_t             size;
+	};
+
+	std::error_code    ec;
+	std::vector<Entry> entries;
+	uintmax_t          total = 0;
+
+	for (const stdfs::directory_entry& e : stdfs::directory_iterator(dir_, ec))
+	{
+		if (!e.is_regular_file(ec))
+			continue;
+		if (e.path().extension() == ".tmp")
+		{
+			stdfs::remove(e.path(), ec);
+			continue;
+		}
+		if (e.path().extension() != ENTRY_EXT)
+			continue;
+		entries.push_back({e.path(), e.last_write_time(ec), e.file_size(ec)});
+		total += entries.back().size;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.time < b.time;
+	});
+
+	for (const Entry& e : entries)
+	{
+		if (total <= maxBytes)
+			break;
+		if (stdfs::remove(e.path, ec))
+			total -= e.size;
+	}
+
+	u::log::print("[waveCache::init] %d entries, %d MB\n", static_cast<int>(entries.size()),
+	    static_cast<int>(total / (1024 * 1024)));
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void init(const std::string& dir, int maxSize)
+{
+	dir_.clear();
+	if (dir.empty())
+		return;
+
+	std::error_code ec;
+	stdfs::create_directories(dir, ec);
+	if (ec)
+	{
+		u::log::print("[waveCache::init] unable to create cache directory %s, cache disabled\n", dir);
+		return;
+	}
+
+	dir_ = dir;
+	loadIndex_();
+	trim_(static_cast<uintmax_t>(std::max(0, maxSize)) * 1024 * 1024);
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::string makeKey(const std::string& path, int samplerate, int quality)
+{
+	if (dir_.empty())
+		return "";
+
+	Stamp stamp;
+	if (!getStamp_(path, stamp))
+		return "";
+
+	/* Hash file content only if the file is new or has changed since the last
+	time, as far as size and modification time can tell. */
+
+	std::unique_lock lock(indexMutex_);
+
+	const auto it = index_.find(path);
+	if (it != index_.end() && it->second.size == stamp.size && it->second.time == stamp.time)
+	{
+		stamp.hash = it->second.hash;
+	}
+	else
+	{
+		lock.unlock();
+
+		std::FILE* f = std::fopen(path.c_str(), "rb");
+		if (f == nullptr)
+			return "";
+		stamp.hash = hash_(f);
+		std::fclose(f);
+
+		lock.lock();
+		index_[path] = stamp;
+		if (std::FILE* index = std::fopen(getPath_(INDEX_FILE).c_str(), "a"))
+		{
+			writeStamp_(index, path, stamp);
+			std::fclose(index);
+		}
+	}
+
+	return u::string::format("%016llx-%d-%d%s", static_cast<unsigned long long>(stamp.hash),
+	    samplerate, quality, ENTRY_EXT);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool load(const std::string& key, Wave& w, const std::string& path)
+{
+	std::shared_ptr<MappedFile> file = MappedFile::open(getPath_(key));
+	if (file == nullptr)
+		return false;
+
+	Header header;
+	if (file->getSize() < sizeof(Header))
+		return false;
+	std::memcpy(&header, file->getData(), sizeof(Header));
+
+	const bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+	                   header.version == G_WAVE_CACHE_VERSION &&
+	                   header.channels == G_MAX_IO_CHANS &&
+	                   file->getSize() == sizeof(Header) + header.frames * header.channels * sizeof(float);
+	if (!valid)
+	{
+		u::log::print("[waveCache::load] invalid entry %s\n", key);
+		return false;
+	}
+
+	w.map(file, sizeof(Header), static_cast<Frame>(header.frames), header.rate, header.bits, path);
+
+	/* Refresh the entry for the LRU policy. */
+
+	std::error_code ec;
+	stdfs::last_write_time(getPath_(key), stdfs::file_time_type::clock::now(), ec);
+
+	u::log::print("[waveCache::load] %s mapped from cache, %d frames\n", path, static_cast<int>(header.frames));
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void store(const std::string& key, const Wave& w)
+{
+	if (dir_.empty() || key.empty())
+		return;
+
+	const mcl::AudioBuffer& buffer = w.getBuffer();
+
+	Header header   = {};
+	header.version  = G_WAVE_CACHE_VERSION;
+	header.channels = buffer.countChannels();
+	header.rate     = w.getRate();
+	header.bits     = w.getBits();
+	header.frames   = buffer.countFrames();
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+
+	/* Write to a temp file first, then rename it: a concurrent load() never 
+	sees a partial entry. */
+
+	const std::string path = getPath_(key);
+	const std::string temp = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+	std::FILE* f = std::fopen(temp.c_str(), "wb");
+	if (f == nullptr)
+		return;
+
+	const std::size_t samples = buffer.countSamples();
+
+	bool ok = std::fwrite(&header, sizeof(Header), 1, f) == 1;
+	ok      = ok && std::fwrite(buffer[0], sizeof(float), samples, f) == samples;
+	ok      = std::fclose(f) == 0 && ok;
+
+	std::error_code ec;
+	if (ok)
+		stdfs::rename(temp, path, ec);
+	if (!ok || ec)
+	{
+		u::log::print("[waveCache::store] unable to write entry %s\n", key);
+		stdfs::remove(temp, ec);
+	}
+}
+} // namespace giada::m::waveCache
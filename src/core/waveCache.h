@@ -0,0 +1,74 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_WAVE_CACHE_H
+#define G_WAVE_CACHE_H
+
+#include <cstddef>
+#include <string>
+
+/* giada::m::waveCache
+On-disk cache of audio files already decoded, converted to stereo and resampled
+to a given sample rate, stored as raw interleaved float32 frames. Cached files 
+are memory-mapped straight into Waves, so reloading a project skips decoding 
+altogether and its samples share memory pages across processes. Entries are
+keyed by file content, so renamed or moved files are still found while edited 
+ones are not. All functions are thread-safe. */
+
+namespace giada::m
+{
+class Wave;
+}
+namespace giada::m::waveCache
+{
+/* init
+Enables the cache in directory 'dir', creating it if necessary. Least recently
+used entries are deleted to keep the directory under 'maxSize' megabytes. An
+empty 'dir' disables the cache. */
+
+void init(const std::string& dir, int maxSize);
+
+/* makeKey
+Returns the key of audio file 'path' converted to 'samplerate' with 
+resampling 'quality', or an empty string if the cache is disabled or the file
+can't be read. Reads the whole file only if it's new or has changed since it
+was last seen: content hashes are indexed by path, size and modification time
+in the cache directory. */
+
+std::string makeKey(const std::string& path, int samplerate, int quality);
+
+/* load
+Maps entry 'key' into Wave 'w', if present. 'path' is the original file. */
+
+bool load(const std::string& key, Wave& w, const std::string& path);
+
+/* store
+Writes audio data of Wave 'w' as entry 'key'. */
+
+void store(const std::string& key, const Wave& w);
+} // namespace giada::m::waveCache
+
+#endif
@@ -72,11 +72,14 @@ void normalize(Wave& w, int a, int b)
 	if (peak == 0.0f || peak > 1.0f)
 		return;
 
+	w.detach();
+
 	for (int i = a; i < b; i++)
 	{
 		for (int j = 0; j < w.getBuffer().countChannels(); j++)
 			w.getBuffer()[i][j] = w.getBuffer()[i][j] * (1.0f / peak);
 	}
+	w.updatePeaks(a, b);
 	w.setEdited(true);
 }
 
@@ -94,6 +97,8 @@ int monoToStereo(Wave& w)
 		for (int j = 0; j < newData.countChannels(); j++)
 			newData[i][j] = w.getBuffer()[i][0];
 
+	/* No need to update peaks: the channel average is the same. */
+
 	w.replaceData(std::move(newData));
 
 	return G_RES_OK;
@@ -105,9 +110,12 @@ void silence(Wave& w, int a, int b)
 {
 	u::log::print("[wfx::silence] silencing from %d to %d\n", a, b);
 
+	w.detach();
+
 	for (int i = a; i < b; i++)
 		for (int j = 0; j < w.getBuffer().countChannels(); j++)
 			w.getBuffer()[i][j] = 0.0f;
+	w.updatePeaks(a, b);
 	w.setEdited(true);
 }
 
@@ -141,6 +149,7 @@ void cut(Wave& w, int a, int b)
 	}
 
 	w.replaceData(std::move(newData));
+	w.updatePeaks(a, w.getBuffer().countFrames());
 	w.setEdited(true);
 }
 
@@ -165,6 +174,7 @@ void trim(Wave& w, Frame a, Frame b)
 			newData[i][j] = w.getBuffer()[i + a][j];
 
 	w.replaceData(std::move(newData));
+	w.updatePeaks(0, w.getBuffer().countFrames());
 	w.setEdited(true);
 }
 
@@ -185,6 +195,7 @@ void paste(const Wave& src, Wave& des, Frame a)
 	newData.set(des.getBuffer(), des.getBuffer().countFrames() - a, src.getBuffer().countFrames() + a);
 
 	des.replaceData(std::move(newData));
+	des.updatePeaks(a, des.getBuffer().countFrames());
 	des.setEdited(true);
 }
 
@@ -197,6 +208,8 @@ void fade(Wave& w, int a, int b, Fade type)
 	float m = 0.0f;
 	float d = 1.0f / (float)(b - a);
 
+	w.detach();
+
 	if (type == Fade::IN)
 		for (int i = a; i <= b; i++, m += d)
 			fadeFrame_(w, i, m);
@@ -204,6 +217,7 @@ void fade(Wave& w, int a, int b, Fade type)
 		for (int i = b; i >= a; i--, m += d)
 			fadeFrame_(w, i, m);
 
+	w.updatePeaks(a, b + 1);
 	w.setEdited(true);
 }
 
@@ -231,10 +245,13 @@ void shift(Wave& w, Frame offset)
 	if (offset < 0)
 		offset = (w.getBuffer().countFrames() + w.getBuffer().countChannels()) + offset;
 
+	w.detach();
+
 	float* begin = w.getBuffer()[0];
 	float* end   = w.getBuffer()[0] + (w.getBuffer().countFrames() * w.getBuffer().countChannels());
 
 	std::rotate(begin, end - (offset * w.getBuffer().countChannels()), end);
+	w.updatePeaks(0, w.getBuffer().countFrames());
 	w.setEdited(true);
 }
 
@@ -242,12 +259,15 @@ void shift(Wave& w, Frame offset)
 
 void reverse(Wave& w, Frame a, Frame b)
 {
+	w.detach();
+
 	/* https://stackoverflow.com/questions/33201528/reversing-an-array-of-structures-in-c */
 	float* begin = w.getBuffer()[0] + (a * w.getBuffer().countChannels());
 	float* end   = w.getBuffer()[0] + (b * w.getBuffer().countChannels());
 
 	std::reverse(begin, end);
 
+	w.updatePeaks(a, b);
 	w.setEdited(true);
 }
 } // namespace giada::m::wfx
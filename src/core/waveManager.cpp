@@ -32,37 +32,228 @@
 #include "patch.h"
 #include "utils/fs.h"
 #include "utils/log.h"
+#include "utils/time.h"
 #include "wave.h"
+#include "waveCache.h"
 #include "waveFx.h"
+#include "waveStream.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
 #include <samplerate.h>
 #include <sndfile.h>
+#include <thread>
+#include <vector>
+
+namespace stdfs = std::filesystem;
 
 namespace giada::m::waveManager
 {
 namespace
 {
-IdManager waveId_;
+IdManager  waveId_;
+std::mutex waveIdMutex_; // Waves can be created concurrently, see model::load()
+
+/* saving_
+Raised from prepareSave() to finishSave(). Guards against overlapping saves, 
+which would write the same temporary files at the same time. */
+
+std::atomic<bool> saving_ = false;
+
+/* -------------------------------------------------------------------------- */
+
+/* generateId_
+Thread-safe ID generation. A valid 'id' is kept as-is and just recorded, so 
+that IDs generated later never clash with it. */
+
+ID generateId_(ID id = 0)
+{
+	std::scoped_lock lock(waveIdMutex_);
+	waveId_.set(id);
+	return id != 0 ? id : waveId_.generate();
+}
 
 /* -------------------------------------------------------------------------- */
 
+/* getBits_
+Subtypes are plain values, not flags: they must be compared as a whole. */
+
 int getBits_(const SF_INFO& header)
 {
-	if (header.format & SF_FORMAT_PCM_S8)
+	switch (header.format & SF_FORMAT_SUBMASK)
+	{
+	case SF_FORMAT_PCM_S8:
+	case SF_FORMAT_PCM_U8:
 		return 8;
-	else if (header.format & SF_FORMAT_PCM_16)
+	case SF_FORMAT_PCM_16:
 		return 16;
-	else if (header.format & SF_FORMAT_PCM_24)
+	case SF_FORMAT_PCM_24:
 		return 24;
-	else if (header.format & SF_FORMAT_PCM_32)
+	case SF_FORMAT_PCM_32:
+	case SF_FORMAT_FLOAT:
 		return 32;
-	else if (header.format & SF_FORMAT_PCM_U8)
-		return 8;
-	else if (header.format & SF_FORMAT_FLOAT)
-		return 32;
-	else if (header.format & SF_FORMAT_DOUBLE)
+	case SF_FORMAT_DOUBLE:
 		return 64;
-	return 0;
+	default:
+		return 0;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getFormat_
+Returns the libsndfile format for saving audio with 'bits' bit depth to 'path':
+FLAC at the same depth for .flac files, 32-bit float WAV otherwise. */
+
+int getFormat_(const std::string& path, int bits)
+{
+	if (u::fs::getExt(path) == ".flac")
+		switch (bits)
+		{
+		case 8:
+			return SF_FORMAT_FLAC | SF_FORMAT_PCM_S8;
+		case 16:
+			return SF_FORMAT_FLAC | SF_FORMAT_PCM_16;
+		case 24:
+			return SF_FORMAT_FLAC | SF_FORMAT_PCM_24;
+		}
+	return SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* openForWriting_
+Opens 'path' for writing. Float data beyond [-1.0, 1.0] (e.g. after an edit) 
+is clipped when converted to integers, rather than wrapped around. */
+
+SNDFILE* openForWriting_(const std::string& path, int format, int channels, int rate)
+{
+	SF_INFO header;
+	header.samplerate = rate;
+	header.channels   = channels;
+	header.format     = format;
+
+	SNDFILE* file = sf_open(path.c_str(), SFM_WRITE, &header);
+	if (file == nullptr)
+	{
+		u::log::print("[waveManager::save] unable to open %s for exporting: %s\n",
+		    path, sf_strerror(file));
+		return nullptr;
+	}
+	sf_command(file, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+	return file;
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr<Wave> loadFromCache_(const std::string& key, ID id, const std::string& path)
+{
+	if (key.empty())
+		return nullptr;
+
+	std::unique_ptr<Wave> wave = std::make_unique<Wave>(0);
+	if (!waveCache::load(key, *wave, path))
+		return nullptr;
+
+	wave->id = generateId_(id);
+
+	return wave;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* readChunks_
+Passes the audio data of an in-memory Wave to 'f' as chunks of interleaved 
+floats, f(data, frames): all at once, or decoded a chunk at a time if packed. */
+
+template <typename F>
+void readChunks_(const Wave& w, F f)
+{
+	if (!w.isPacked())
+	{
+		f(w.getBuffer()[0], w.getBuffer().countFrames());
+		return;
+	}
+
+	std::vector<float> chunk(G_WAVE_STREAM_CHUNK_FRAMES * w.countChannels());
+	for (Frame i = 0; i < w.countFrames(); i += G_WAVE_STREAM_CHUNK_FRAMES)
+	{
+		const Frame frames = std::min<Frame>(G_WAVE_STREAM_CHUNK_FRAMES, w.countFrames() - i);
+		w.read(i, chunk.data(), frames);
+		f(chunk.data(), frames);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* saveBuffer_
+Writes the audio data of an in-memory Wave to 'path' in 'format'. */
+
+int saveBuffer_(const Wave& w, const std::string& path, int format)
+{
+	SNDFILE* file = openForWriting_(path, format, w.countChannels(), w.getRate());
+	if (file == nullptr)
+		return G_RES_ERR_IO;
+
+	bool ok = true;
+	readChunks_(w, [file, &ok](const float* data, Frame frames) {
+		ok = ok && sf_writef_float(file, data, frames) == frames;
+	});
+	if (!ok)
+		u::log::print("[waveManager::save] incomplete write!\n");
+
+	sf_close(file);
+
+	return ok ? G_RES_OK : G_RES_ERR_IO;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* saveFile_
+Copies audio file 'source' to 'path' in 'format', chunk by chunk. Used for the
+Waves whose data in memory is a stand-in of a file: streamed and HALF-packed
+ones. */
+
+int saveFile_(const std::string& source, const std::string& path, int format)
+{
+	SF_INFO  headerIn;
+	SNDFILE* fileIn = sf_open(source.c_str(), SFM_READ, &headerIn);
+	if (fileIn == nullptr)
+	{
+		u::log::print("[waveManager::save] unable to read %s: %s\n", source, sf_strerror(fileIn));
+		return G_RES_ERR_IO;
+	}
+
+	SNDFILE* fileOut = openForWriting_(path, format, headerIn.channels, headerIn.samplerate);
+	if (fileOut == nullptr)
+	{
+		sf_close(fileIn);
+		return G_RES_ERR_IO;
+	}
+
+	std::vector<float> chunk(G_WAVE_STREAM_CHUNK_FRAMES * headerIn.channels);
+	sf_count_t         read;
+	while ((read = sf_readf_float(fileIn, chunk.data(), G_WAVE_STREAM_CHUNK_FRAMES)) > 0)
+		if (sf_writef_float(fileOut, chunk.data(), read) != read)
+			u::log::print("[waveManager::save] warning: incomplete write!\n");
+
+	sf_close(fileIn);
+	sf_close(fileOut);
+
+	return G_RES_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getSource_
+Returns the file to be copied in place of the data of Wave 'w', if any. */
+
+std::string getSource_(const Wave& w)
+{
+	return w.isStreamed() ? w.getStream()->getPath() : w.getSource();
 }
 } // namespace
 
@@ -77,7 +268,8 @@ void init()
 
 /* -------------------------------------------------------------------------- */
 
-Result createFromFile(const std::string& path, ID id, int samplerate, int quality)
+Result createFromFile(const std::string& path, ID id, int samplerate, int quality,
+    bool streamed)
 {
 	if (path == "" || u::fs::isDir(path))
 	{
@@ -88,6 +280,29 @@ Result createFromFile(const std::string& path, ID id, int samplerate, int qualit
 	if (path.size() > FILENAME_MAX)
 		return {G_RES_ERR_PATH_TOO_LONG};
 
+	if (streamed)
+	{
+		std::unique_ptr<WaveStream> stream = WaveStream::open(path, samplerate, quality);
+		if (stream == nullptr)
+			return {G_RES_ERR_IO};
+
+		std::unique_ptr<Wave> wave = std::make_unique<Wave>(generateId_(id));
+		wave->setStream(std::move(stream));
+
+		u::log::print("[waveManager::create] new streamed Wave created, %d frames\n", wave->countFrames());
+
+		return {G_RES_OK, std::move(wave)};
+	}
+
+	const std::string cacheKey = waveCache::makeKey(path, samplerate, quality);
+
+	if (std::unique_ptr<Wave> wave = loadFromCache_(cacheKey, id, path); wave != nullptr)
+	{
+		wave->setClean();
+		wave->computePeaks();
+		return {G_RES_OK, std::move(wave)};
+	}
+
 	SF_INFO  header;
 	SNDFILE* fileIn = sf_open(path.c_str(), SFM_READ, &header);
 
@@ -103,9 +318,7 @@ Result createFromFile(const std::string& path, ID id, int samplerate, int qualit
 		return {G_RES_ERR_WRONG_DATA};
 	}
 
-	waveId_.set(id);
-
-	std::unique_ptr<Wave> wave = std::make_unique<Wave>(waveId_.generate(id));
+	std::unique_ptr<Wave> wave = std::make_unique<Wave>(generateId_(id));
 	wave->alloc(header.frames, header.channels, header.samplerate, getBits_(header), path);
 
 	if (sf_readf_float(fileIn, wave->getBuffer()[0], header.frames) != header.frames)
@@ -126,6 +339,10 @@ Result createFromFile(const std::string& path, ID id, int samplerate, int qualit
 
 	u::log::print("[waveManager::create] new Wave created, %d frames\n", wave->getBuffer().countFrames());
 
+	waveCache::store(cacheKey, *wave);
+	wave->setClean();
+	wave->computePeaks();
+
 	return {G_RES_OK, std::move(wave)};
 }
 
@@ -134,7 +351,7 @@ Result createFromFile(const std::string& path, ID id, int samplerate, int qualit
 std::unique_ptr<Wave> createEmpty(int frames, int channels, int samplerate,
     const std::string& name)
 {
-	std::unique_ptr<Wave> wave = std::make_unique<Wave>(waveId_.generate());
+	std::unique_ptr<Wave> wave = std::make_unique<Wave>(generateId_());
 	wave->alloc(frames, channels, samplerate, G_DEFAULT_BIT_DEPTH, name);
 	wave->setLogical(true);
 
@@ -148,29 +365,65 @@ std::unique_ptr<Wave> createEmpty(int frames, int channels, int samplerate,
 
 std::unique_ptr<Wave> createFromWave(const Wave& src, int a, int b)
 {
-	int channels = src.getBuffer().countChannels();
-	int frames   = b - a;
+	if (src.isStreamed())
+	{
+		std::unique_ptr<WaveStream> stream = a == 0 && b == src.countFrames() ? src.getStream()->reopen() : nullptr;
+		if (stream == nullptr)
+			return createFromWave(*clone(src), a, b);
+
+		std::unique_ptr<Wave> wave = std::make_unique<Wave>(generateId_());
+		wave->setStream(std::move(stream));
+		return wave;
+	}
+
+	/* Peaks of a packed Wave can't be computed: only the whole one, which has
+	them already, can be viewed. */
+
+	if (src.isPacked() && (a != 0 || b != src.countFrames()))
+		return createFromWave(*clone(src), a, b);
 
-	std::unique_ptr<Wave> wave = std::make_unique<Wave>(waveId_.generate());
-	wave->alloc(frames, channels, src.getRate(), src.getBits(), src.getPath());
-	wave->getBuffer().set(src.getBuffer(), frames);
+	std::unique_ptr<Wave> wave = std::make_unique<Wave>(generateId_());
+	wave->view(src, a, b);
 	wave->setLogical(true);
+	wave->computePeaks();
 
-	u::log::print("[waveManager::createFromWave] new Wave created, %d frames\n", frames);
+	u::log::print("[waveManager::createFromWave] new Wave created, %d frames (shared)\n", b - a);
 
 	return wave;
 }
 
 /* -------------------------------------------------------------------------- */
 
+std::unique_ptr<Wave> clone(const Wave& src)
+{
+	if (src.isStreamed())
+	{
+		const WaveStream& stream = *src.getStream();
+
+		Result res = createFromFile(stream.getPath(), src.id, stream.getRate(), stream.getQuality());
+		if (res.wave != nullptr)
+			res.wave->setPath(src.getPath());
+		return std::move(res.wave);
+	}
+
+	std::unique_ptr<Wave> wave = std::make_unique<Wave>(src);
+	wave->setLogical(src.isLogical());
+	wave->setEdited(src.isEdited());
+	if (wave->isPacked())
+		wave->detach();
+	return wave;
+}
+
+/* -------------------------------------------------------------------------- */
+
 std::unique_ptr<Wave> deserializeWave(const patch::Wave& w, int samplerate, int quality)
 {
-	return createFromFile(w.path, w.id, samplerate, quality).wave;
+	return createFromFile(w.path, w.id, samplerate, quality, w.streamed).wave;
 }
 
 const patch::Wave serializeWave(const Wave& w)
 {
-	return {w.id, u::fs::basename(w.getPath())};
+	return {w.id, u::fs::basename(w.getPath()), w.isStreamed()};
 }
 
 /* -------------------------------------------------------------------------- */
@@ -214,26 +467,190 @@ int resample(Wave& w, int quality, int samplerate)
 
 /* -------------------------------------------------------------------------- */
 
+uint64_t hash(const Wave& w)
+{
+	if (w.isStreamed())
+		return 0;
+
+	/* Same FNV-1a variant on 8-byte words used by the wave cache. Chunks of
+	packed data hold an even number of floats, so words are the same. */
+
+	uint64_t    h     = 0xcbf29ce484222325;
+	std::size_t bytes = 0;
+
+	readChunks_(w, [&h, &bytes, channels = w.countChannels()](const float* samples, Frame frames) {
+		const std::size_t    size = frames * channels * sizeof(float);
+		const unsigned char* data = reinterpret_cast<const unsigned char*>(samples);
+		for (std::size_t i = 0; i < size; i += sizeof(uint64_t))
+		{
+			uint64_t word = 0;
+			std::memcpy(&word, data + i, std::min(sizeof(uint64_t), size - i));
+			h = (h ^ word) * 0x100000001b3;
+			h ^= h >> 29;
+		}
+		bytes += size;
+	});
+
+	return h ^ bytes ^ (static_cast<uint64_t>(w.getRate()) << 32);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool isFlacCompatible(const Wave& w)
+{
+	return w.getBits() == 8 || w.getBits() == 16 || w.getBits() == 24;
+}
+
+/* -------------------------------------------------------------------------- */
+
 int save(const Wave& w, const std::string& path)
 {
-	SF_INFO header;
-	header.samplerate = w.getRate();
-	header.channels   = w.getBuffer().countChannels();
-	header.format     = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+	const std::string source = getSource_(w);
 
-	SNDFILE* file = sf_open(path.c_str(), SFM_WRITE, &header);
-	if (file == nullptr)
+	if (source == path)
+		return G_RES_OK;
+
+	/* Write to a temp file first, then rename it: an existing file is never 
+	left half-written. The format comes from the final path. HALF-packed Waves 
+	are copied from their source file, as saving the decoded data would lose 
+	quality; the decoded data is the fallback if the source can't be read. */
+
+	const std::string temp   = path + ".tmp";
+	const int         format = getFormat_(path, w.getBits());
+
+	int res = source.empty() ? saveBuffer_(w, temp, format) : saveFile_(source, temp, format);
+	if (res != G_RES_OK && !w.isStreamed() && !source.empty())
 	{
-		u::log::print("[waveManager::save] unable to open %s for exporting: %s\n",
-		    path, sf_strerror(file));
+		u::log::print("[waveManager::save] warning: saving %s from lossy packed data\n", path);
+		res = saveBuffer_(w, temp, format);
+	}
+
+	std::error_code ec;
+	if (res == G_RES_OK)
+		stdfs::rename(temp, path, ec);
+	if (res != G_RES_OK || ec)
+	{
+		u::log::print("[waveManager::save] unable to save %s\n", path);
+		stdfs::remove(temp, ec);
 		return G_RES_ERR_IO;
 	}
+	return G_RES_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr<SaveBatch> prepareSave(const std::vector<Wave*>& waves)
+{
+	if (saving_.exchange(true))
+	{
+		u::log::print("[waveManager::prepareSave] already saving, skipped\n");
+		return nullptr;
+	}
 
-	if (sf_writef_float(file, w.getBuffer()[0], w.getBuffer().countFrames()) != w.getBuffer().countFrames())
-		u::log::print("[waveManager::save] warning: incomplete write!\n");
+	/* Wave flags belong to this thread: pick dirty Waves here, let the 
+	workers read their copies and hand back the results. */
 
-	sf_close(file);
+	auto batch   = std::make_unique<SaveBatch>();
+	batch->count = waves.size();
+	for (Wave* w : waves)
+		if (w->isDirty() || !u::fs::fileExists(w->getPath()))
+			batch->jobs.push_back({w, w->id, w->getPath(), std::make_unique<Wave>(*w)});
 
-	return G_RES_OK;
+	return batch;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool runSave(SaveBatch& batch, std::function<void(float)> onProgress)
+{
+	/* Progress is measured in frames. */
+
+	Frame total = 0;
+	for (const SaveBatch::Job& job : batch.jobs)
+		total += job.copy->countFrames();
+
+	std::atomic<std::size_t> next = 0;
+	std::atomic<Frame>       done = 0;
+
+	auto work = [&]() {
+		for (std::size_t i = next++; i < batch.jobs.size(); i = next++)
+		{
+			SaveBatch::Job& job = batch.jobs[i];
+			const Wave&     w   = *job.copy;
+
+			job.hash = hash(w);
+			if (job.hash != 0 && job.hash == w.getSavedHash() && u::fs::fileExists(job.path))
+				job.ok = true;
+			else
+				job.ok = save(w, job.path) == G_RES_OK;
+
+			done += w.countFrames();
+		}
+	};
+
+	/* Encoding FLAC is CPU-bound: use as many workers as cores. */
+
+	const std::size_t        count = std::min<std::size_t>(batch.jobs.size(), std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> workers;
+	for (std::size_t i = 0; i < count; i++)
+		workers.emplace_back(work);
+
+	while (done.load() < total)
+	{
+		if (onProgress != nullptr)
+			onProgress(done.load() / static_cast<float>(total));
+		u::time::sleep(G_PATCH_LOAD_PROGRESS_RATE_MS);
+	}
+
+	for (std::thread& w : workers)
+		w.join();
+
+	if (onProgress != nullptr)
+		onProgress(1.0f);
+
+	u::log::print("[waveManager::runSave] %d dirty Waves out of %d\n",
+	    static_cast<int>(batch.jobs.size()), static_cast<int>(batch.count));
+
+	return std::all_of(batch.jobs.begin(), batch.jobs.end(), [](const SaveBatch::Job& job) {
+		return job.ok;
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+
+void finishSave(const SaveBatch& batch, const std::vector<Wave*>& waves)
+{
+	/* A Wave might have been edited (i.e. replaced), moved or deleted while 
+	saving: only the ones untouched are in sync with what's been written. */
+
+	for (const SaveBatch::Job& job : batch.jobs)
+	{
+		if (!job.ok)
+			continue;
+		for (Wave* w : waves)
+			if (w == job.wave && w->id == job.waveId && w->getPath() == job.path)
+				w->setClean(job.hash);
+	}
+	saving_ = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool isSaving()
+{
+	return saving_.load();
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool saveDirty(const std::vector<Wave*>& waves, std::function<void(float)> onProgress)
+{
+	std::unique_ptr<SaveBatch> batch = prepareSave(waves);
+	if (batch == nullptr)
+		return false;
+
+	const bool ok = runSave(*batch, onProgress);
+	finishSave(*batch, waves);
+	return ok;
 }
 } // namespace giada::m::waveManager
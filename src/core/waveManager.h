@@ -28,8 +28,11 @@
 #define G_WAVE_MANAGER_H
 
 #include "core/types.h"
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace giada::m
 {
@@ -54,9 +57,12 @@ void init();
 /* create
 Creates a new Wave object with data read from file 'path'. Pass id = 0 to 
 auto-generate it. The function converts the Wave sample rate if it doesn't match
-the desired one as specified in 'samplerate'. */
+the desired one as specified in 'samplerate'. If 'streamed' only the beginning 
+of the file is loaded, the rest is read from disk during playback. Otherwise the
+result is taken from, or added to, the wave cache (see waveCache). */
 
-Result createFromFile(const std::string& path, ID id, int samplerate, int quality);
+Result createFromFile(const std::string& path, ID id, int samplerate, int quality,
+    bool streamed = false);
 
 /* createEmpty
 Creates a new silent Wave object. */
@@ -65,10 +71,21 @@ std::unique_ptr<Wave> createEmpty(int frames, int channels, int samplerate,
     const std::string& name);
 
 /* createFromWave
-Creates a new Wave from an existing one, copying the data in range a - b. */
+Creates a new Wave from an existing one, with the data in range a - b. No data 
+is copied: the new Wave is a view on the original data, until edited. A 
+streamed Wave taken as a whole gives a new streamed Wave on the same file. Parts
+of a packed Wave are unpacked. */
 
 std::unique_ptr<Wave> createFromWave(const Wave& src, int a, int b);
 
+/* clone
+Creates an exact copy of an existing Wave, ID and flags included. Used to edit
+a Wave without touching the one currently read by the audio thread: a streamed
+Wave is fully loaded into memory for the purpose, a packed one is unpacked. 
+Audio data is shared with the original one until edited, see Wave::detach(). */
+
+std::unique_ptr<Wave> clone(const Wave& src);
+
 /* (de)serializeWave
 Creates a new Wave given the patch raw data and vice versa. */
 
@@ -82,10 +99,82 @@ algorithm to use for the conversion. */
 
 int resample(Wave& w, int quality, int samplerate);
 
+/* hash
+Returns a 64-bit hash of the audio data of 'w', used to tell whether it has 
+actually changed since it was last saved. Streamed Waves can't be edited and are
+not hashed: returns 0. */
+
+uint64_t hash(const Wave& w);
+
+/* isFlacCompatible
+True if 'w' can be saved as FLAC at its source bit depth, i.e. 8, 16 or 24 
+bits. */
+
+bool isFlacCompatible(const Wave& w);
+
 /* save
-Writes Wave data to file 'path'. Only 'wav' format is supported for now. */
+Writes Wave data to file 'path'. If 'path' ends with .flac and the Wave is FLAC
+compatible, data is encoded as FLAC at the source bit depth. Otherwise it's 
+saved as 32-bit float WAV. A streamed Wave is copied over from its file, in its
+original sample rate, and so is a HALF-packed one, so that the lossy packing
+never reaches the project (see Wave::getSource()). The data goes to a temporary file first, renamed to 
+'path' when complete. */
 
 int save(const Wave& w, const std::string& path);
+
+/* SaveBatch
+Dirty Waves being saved by the functions below. Workers write copies of them,
+which share audio data with the originals, so that the originals are free to
+change or go away in the meantime. */
+
+struct SaveBatch
+{
+	struct Job
+	{
+		const Wave*           wave; // Original, compared only, never read
+		ID                    waveId;
+		std::string           path;
+		std::unique_ptr<Wave> copy;
+		uint64_t              hash = 0;
+		bool                  ok   = false;
+	};
+
+	std::vector<Job> jobs;
+	std::size_t      count; // Waves considered, dirty or not
+};
+
+/* prepareSave
+Picks the Waves in 'waves' not in sync with their file: dirty, or missing. To be
+called by the thread owning the Waves. Returns nullptr if another save is still
+in progress, i.e. until finishSave(). */
+
+std::unique_ptr<SaveBatch> prepareSave(const std::vector<Wave*>& waves);
+
+/* runSave
+Saves each Wave in 'batch' to its own path on a pool of background threads, one
+Wave per thread at a time, skipping the ones edited back to the content last 
+saved. Meanwhile the calling thread waits, reporting progress in [0.0, 1.0]
+through 'onProgress'. Can be called by any thread. Returns false if any Wave 
+failed to save. */
+
+bool runSave(SaveBatch& batch, std::function<void(float)> onProgress = nullptr);
+
+/* finishSave
+Marks as clean the saved Waves still found in 'waves' as they were, and allows
+the next save. To be called by the thread owning the Waves. */
+
+void finishSave(const SaveBatch& batch, const std::vector<Wave*>& waves);
+
+/* isSaving
+True between prepareSave() and finishSave(). */
+
+bool isSaving();
+
+/* saveDirty
+All of the above, in a row. Returns false if any Wave failed to save, or if 
+another save is still in progress. */
+
+bool saveDirty(const std::vector<Wave*>& waves, std::function<void(float)> onProgress = nullptr);
 } // namespace giada::m::waveManager
 
 #endif
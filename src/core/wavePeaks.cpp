@@ -0,0 +1,202 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/wavePeaks.h"
+#include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
+#include <algorithm>
+
+namespace giada::m
+{
+namespace
+{
+float average_(const mcl::AudioBuffer& b, Frame i)
+{
+	const float* frame = b[i];
+	float        sum   = 0.0f;
+	for (int j = 0; j < b.countChannels(); j++)
+		sum += frame[j];
+	return sum / b.countChannels();
+}
+
+/* -------------------------------------------------------------------------- */
+
+WavePeaks::Peak merge_(WavePeaks::Peak a, WavePeaks::Peak b)
+{
+	return {std::min(a.min, b.min), std::max(a.max, b.max)};
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+WavePeaks::Peak WavePeaks::scan(const mcl::AudioBuffer& b, Frame a, Frame z)
+{
+	const float first = average_(b, a);
+
+	Peak p{first, first};
+	for (Frame i = a + 1; i < z; i++)
+	{
+		const float avg = average_(b, i);
+		p.min           = std::min(p.min, avg);
+		p.max           = std::max(p.max, avg);
+	}
+	return p;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool WavePeaks::build(const mcl::AudioBuffer& b, const std::atomic<bool>& cancel)
+{
+	resize_(b.countFrames());
+
+	const std::size_t size = m_levels[0].size();
+	for (std::size_t i = 0; i < size; i += G_WAVE_PEAKS_CHUNK)
+	{
+		if (cancel.load())
+			return false;
+		computeBase_(b, i, std::min(i + G_WAVE_PEAKS_CHUNK, size));
+	}
+
+	for (std::size_t l = 1; l < m_levels.size(); l++)
+		computeLevel_(l, 0, m_levels[l].size());
+
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void WavePeaks::update(const mcl::AudioBuffer& b, Frame a, Frame z)
+{
+	const std::size_t oldLevels = m_levels.size();
+
+	if (b.countFrames() != m_frames)
+	{
+		resize_(b.countFrames());
+		z = m_frames;
+	}
+
+	a = std::clamp(a, 0, m_frames);
+	z = std::clamp(z, a, m_frames);
+	if (a == z)
+		return;
+
+	std::size_t first = a / BASE_FRAMES;
+	std::size_t last  = (z + BASE_FRAMES - 1) / BASE_FRAMES;
+
+	computeBase_(b, first, last);
+
+	for (std::size_t l = 1; l < m_levels.size(); l++)
+	{
+		first = first / 2;
+		last  = (last + 1) / 2;
+
+		/* Levels added by a change in length have never been computed. */
+
+		if (l >= oldLevels)
+			computeLevel_(l, 0, m_levels[l].size());
+		else
+			computeLevel_(l, first, last);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+WavePeaks::Peak WavePeaks::get(const mcl::AudioBuffer& b, Frame a, Frame z) const
+{
+	a = std::max(a, 0);
+	z = std::min(z, m_frames);
+	if (z <= a)
+		return {};
+	if (z - a < BASE_FRAMES)
+		return scan(b, a, z);
+
+	std::size_t l = 0;
+	while (l + 1 < m_levels.size() && (BASE_FRAMES << (l + 1)) <= z - a)
+		l++;
+
+	const Frame       size  = BASE_FRAMES << l;
+	const std::size_t first = a / size;
+	const std::size_t last  = (z - 1) / size;
+
+	Peak p = m_levels[l][first];
+	for (std::size_t i = first + 1; i <= last; i++)
+		p = merge_(p, m_levels[l][i]);
+	return p;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Frame WavePeaks::countFrames() const { return m_frames; }
+int   WavePeaks::countLevels() const { return m_levels.size(); }
+
+/* -------------------------------------------------------------------------- */
+
+void WavePeaks::resize_(Frame frames)
+{
+	m_frames = frames;
+
+	std::size_t levels = 0;
+	std::size_t size   = (frames + BASE_FRAMES - 1) / BASE_FRAMES;
+	while (true)
+	{
+		if (m_levels.size() <= levels)
+			m_levels.emplace_back();
+		m_levels[levels++].resize(size);
+		if (size <= 1)
+			break;
+		size = (size + 1) / 2;
+	}
+	m_levels.resize(levels);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void WavePeaks::computeBase_(const mcl::AudioBuffer& b, std::size_t first, std::size_t last)
+{
+	for (std::size_t i = first; i < last; i++)
+	{
+		const Frame a = i * BASE_FRAMES;
+		const Frame z = std::min(a + BASE_FRAMES, m_frames);
+		m_levels[0][i] = scan(b, a, z);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void WavePeaks::computeLevel_(std::size_t l, std::size_t first, std::size_t last)
+{
+	const std::vector<Peak>& below = m_levels[l - 1];
+
+	for (std::size_t i = first; i < last; i++)
+	{
+		Peak p = below[i * 2];
+		if (i * 2 + 1 < below.size())
+			p = merge_(p, below[i * 2 + 1]);
+		m_levels[l][i] = p;
+	}
+}
+} // namespace giada::m
@@ -0,0 +1,107 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_WAVE_PEAKS_H
+#define G_WAVE_PEAKS_H
+
+#include "core/const.h"
+#include "core/types.h"
+#include <atomic>
+#include <vector>
+
+namespace mcl
+{
+class AudioBuffer;
+}
+
+namespace giada::m
+{
+/* WavePeaks
+Multi-resolution min/max pyramid of the channel-averaged signal of a Wave, used 
+to draw waveforms. Level 0 holds one bucket every BASE_FRAMES frames, each level
+above merges pairs of buckets of the level below, i.e. level n covers 
+BASE_FRAMES * 2^n frames per bucket. Any range of frames can then be queried 
+in constant time. */
+
+class WavePeaks
+{
+public:
+	struct Peak
+	{
+		float min = 0.0f;
+		float max = 0.0f;
+	};
+
+	static constexpr Frame BASE_FRAMES = G_WAVE_PEAKS_BASE_FRAMES;
+
+	/* scan
+	Reads peaks of frames [a, z) straight from 'b', in linear time. The range 
+	must not be empty. */
+
+	static Peak scan(const mcl::AudioBuffer& b, Frame a, Frame z);
+
+	/* build
+	Computes the whole pyramid out of 'b'. Gives up and returns false as soon as
+	'cancel' is raised. */
+
+	bool build(const mcl::AudioBuffer& b, const std::atomic<bool>& cancel);
+
+	/* update
+	Recomputes the buckets covering frames [a, z) of 'b' on every level. If the
+	length of 'b' has changed since the last call, everything from 'a' to the 
+	end is recomputed instead. */
+
+	void update(const mcl::AudioBuffer& b, Frame a, Frame z);
+
+	/* get
+	Returns the peaks of frames [a, z) of 'b'. Ranges shorter than a level-0 
+	bucket are scanned directly, longer ones are read from the coarsest level 
+	that fits, with the range rounded out to its bucket edges. */
+
+	Peak get(const mcl::AudioBuffer& b, Frame a, Frame z) const;
+
+	Frame countFrames() const;
+	int   countLevels() const;
+
+private:
+	/* resize_
+	Resizes levels to fit 'frames' frames. */
+
+	void resize_(Frame frames);
+
+	/* computeBase_, computeLevel_
+	Compute buckets [first, last) of level 0 out of audio data and of level 
+	'l' out of level 'l' - 1, respectively. */
+
+	void computeBase_(const mcl::AudioBuffer& b, std::size_t first, std::size_t last);
+	void computeLevel_(std::size_t l, std::size_t first, std::size_t last);
+
+	std::vector<std::vector<Peak>> m_levels;
+	Frame                          m_frames = 0;
+};
+} // namespace giada::m
+
+#endif
@@ -0,0 +1,413 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/waveStream.h"
+#include "core/waveStreamer.h"
+#include "utils/log.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace giada::m
+{
+namespace
+{
+constexpr Frame RING_FRAMES  = G_WAVE_STREAM_RING_FRAMES;
+constexpr Frame CHUNK_FRAMES = G_WAVE_STREAM_CHUNK_FRAMES;
+
+static_assert((RING_FRAMES & (RING_FRAMES - 1)) == 0, "Ring size must be a power of 2");
+static_assert(RING_FRAMES >= CHUNK_FRAMES * 4);
+
+/* FILL_FRAMES
+Max frames decoded in a single fill() call, so that a stream can't hog the 
+streamer while others are waiting. */
+
+constexpr Frame FILL_FRAMES = RING_FRAMES / 4;
+
+/* -------------------------------------------------------------------------- */
+
+float* ringAt_(std::vector<float>& ring, uint64_t pos)
+{
+	return ring.data() + (pos & (RING_FRAMES - 1)) * G_MAX_IO_CHANS;
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr<WaveStream> WaveStream::open(const std::string& path, int samplerate,
+    int quality, Frame headFrames)
+{
+	SF_INFO  info;
+	SNDFILE* file = sf_open(path.c_str(), SFM_READ, &info);
+
+	if (file == nullptr)
+	{
+		u::log::print("[WaveStream::open] unable to read %s. %s\n", path, sf_strerror(file));
+		return nullptr;
+	}
+
+	if (info.channels > G_MAX_IO_CHANS || !info.seekable)
+	{
+		u::log::print("[WaveStream::open] unsupported file %s\n", path);
+		sf_close(file);
+		return nullptr;
+	}
+
+	return std::make_unique<WaveStream>(file, info, path, samplerate, quality, headFrames);
+}
+
+/* -------------------------------------------------------------------------- */
+
+WaveStream::WaveStream(SNDFILE* file, const SF_INFO& info, const std::string& path,
+    int samplerate, int quality, Frame headFrames)
+: m_file(file)
+, m_info(info)
+, m_src(nullptr)
+, m_path(path)
+, m_samplerate(samplerate)
+, m_quality(quality)
+, m_ratio(samplerate / static_cast<double>(info.samplerate))
+, m_frames(static_cast<Frame>(std::ceil(info.frames * m_ratio)))
+, m_source(CHUNK_FRAMES * G_MAX_IO_CHANS)
+, m_sourceStart(0)
+, m_sourceCount(0)
+, m_sourceEnd(false)
+, m_end(false)
+, m_servedRequest(0)
+, m_ring(RING_FRAMES * G_MAX_IO_CHANS)
+, m_readPos(0)
+, m_writePos(0)
+, m_basePos(0)
+, m_baseFrame(0)
+, m_baseRequest(0)
+, m_request(0)
+, m_requestFrame(0)
+, m_target(0)
+, m_syncedRequest(0)
+, m_syncedFrame(0)
+, m_syncedPos(0)
+, m_scratch(SCRATCH_FRAMES * G_MAX_IO_CHANS)
+{
+	if (info.samplerate != samplerate)
+	{
+		int error;
+		m_src = src_new(quality, G_MAX_IO_CHANS, &error);
+		if (m_src == nullptr)
+			u::log::print("[WaveStream] unable to allocate resampler: %s\n", src_strerror(error));
+	}
+
+	/* Preload the head. The decoder then just goes on from there, so the ring
+	buffer is initially positioned right after the head, ready for playback. */
+
+	headFrames = std::min(headFrames, m_frames);
+	m_head.alloc(headFrames, G_MAX_IO_CHANS);
+	m_head.clear();
+
+	for (Frame done = 0, got = 1; done < headFrames && got > 0; done += got)
+		got = decode_(m_head[done], headFrames - done);
+
+	m_baseFrame.store(headFrames);
+	m_requestFrame.store(headFrames);
+	m_target      = headFrames;
+	m_syncedFrame = headFrames;
+
+	waveStreamer::add(this);
+}
+
+/* -------------------------------------------------------------------------- */
+
+WaveStream::~WaveStream()
+{
+	waveStreamer::remove(this);
+	if (m_src != nullptr)
+		src_delete(m_src);
+	sf_close(m_file);
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr<WaveStream> WaveStream::reopen() const
+{
+	return open(m_path, m_samplerate, m_quality, m_head.countFrames());
+}
+
+/* -------------------------------------------------------------------------- */
+
+Frame                   WaveStream::countFrames() const { return m_frames; }
+const std::string&      WaveStream::getPath() const { return m_path; }
+int                     WaveStream::getRate() const { return m_samplerate; }
+int                     WaveStream::getQuality() const { return m_quality; }
+int                     WaveStream::getSourceRate() const { return m_info.samplerate; }
+const mcl::AudioBuffer& WaveStream::getHead() const { return m_head; }
+float*                  WaveStream::getScratch() { return m_scratch.data(); }
+Frame                   WaveStream::getScratchSize() const { return SCRATCH_FRAMES; }
+
+/* -------------------------------------------------------------------------- */
+
+int WaveStream::getSourceBits() const
+{
+	switch (m_info.format & SF_FORMAT_SUBMASK)
+	{
+	case SF_FORMAT_PCM_S8:
+	case SF_FORMAT_PCM_U8:
+		return 8;
+	case SF_FORMAT_PCM_16:
+		return 16;
+	case SF_FORMAT_PCM_24:
+		return 24;
+	case SF_FORMAT_DOUBLE:
+		return 64;
+	default:
+		return 32;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void WaveStream::read(Frame start, float* out, Frame count)
+{
+	assert(start >= 0);
+
+	const Frame headFrames = m_head.countFrames();
+
+	/* Head part: straight from memory. Meanwhile make sure the ring buffer 
+	is waiting right after the head: this is what makes loops restart without
+	gaps. */
+
+	if (start < headFrames)
+	{
+		const Frame n = std::min(count, headFrames - start);
+		std::memcpy(out, m_head[start], n * G_MAX_IO_CHANS * sizeof(float));
+		out += n * G_MAX_IO_CHANS;
+		start += n;
+		count -= n;
+
+		if (getRingFrame_() != headFrames)
+			requestSeek_(headFrames);
+	}
+
+	if (count == 0)
+		return;
+
+	/* Ring part. Anything not available yet is silenced. */
+
+	Frame n = 0;
+	if (start < m_frames)
+	{
+		if (getRingFrame_() != start)
+			requestSeek_(start);
+		else if (sync_())
+		{
+			const uint64_t readPos  = m_readPos.load(std::memory_order_relaxed);
+			const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+
+			n = static_cast<Frame>(std::min<uint64_t>(count, writePos - readPos));
+			for (Frame i = 0; i < n;)
+			{
+				const Frame contiguous = RING_FRAMES - static_cast<Frame>((readPos + i) & (RING_FRAMES - 1));
+				const Frame chunk      = std::min(n - i, contiguous);
+				std::memcpy(out + i * G_MAX_IO_CHANS, ringAt_(m_ring, readPos + i),
+				    chunk * G_MAX_IO_CHANS * sizeof(float));
+				i += chunk;
+			}
+			if (n < count && start + n < m_frames)
+				waveStreamer::notify(); // Underrun
+		}
+	}
+
+	std::fill(out + n * G_MAX_IO_CHANS, out + count * G_MAX_IO_CHANS, 0.0f);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void WaveStream::consume(Frame start, Frame count)
+{
+	const Frame headFrames = m_head.countFrames();
+
+	if (start + count <= headFrames || getRingFrame_() != std::max(start, headFrames) || !sync_())
+		return;
+
+	count -= std::max(0, headFrames - start);
+
+	const uint64_t readPos  = m_readPos.load(std::memory_order_relaxed);
+	const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+	const uint64_t consumed = std::min<uint64_t>(count, writePos - readPos);
+
+	m_readPos.store(readPos + consumed, std::memory_order_release);
+
+	if (writePos - (readPos + consumed) < RING_FRAMES / 2)
+		waveStreamer::notify();
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool WaveStream::fill()
+{
+	const uint64_t request = m_request.load(std::memory_order_acquire);
+	if (request != m_servedRequest)
+	{
+		const Frame    frame    = m_requestFrame.load(std::memory_order_relaxed);
+		const uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+
+		seek_(frame);
+
+		/* Data already in the ring is now stale: the reader jumps to the new
+		base as soon as it sees the request served. */
+
+		m_basePos.store(writePos, std::memory_order_relaxed);
+		m_baseFrame.store(frame, std::memory_order_relaxed);
+		m_baseRequest.store(request, std::memory_order_release);
+		m_servedRequest = request;
+	}
+
+	for (Frame filled = 0; filled < FILL_FRAMES;)
+	{
+		if (m_end)
+			return true;
+
+		const uint64_t readPos  = std::max(m_readPos.load(std::memory_order_acquire), m_basePos.load(std::memory_order_relaxed));
+		const uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+		const Frame    free     = RING_FRAMES - static_cast<Frame>(writePos - readPos);
+
+		if (free < CHUNK_FRAMES)
+			return true;
+
+		const Frame contiguous = RING_FRAMES - static_cast<Frame>(writePos & (RING_FRAMES - 1));
+		const Frame got        = decode_(ringAt_(m_ring, writePos), std::min(CHUNK_FRAMES, contiguous));
+
+		if (got == 0)
+			m_end = true;
+
+		m_writePos.store(writePos + got, std::memory_order_release);
+		filled += got;
+	}
+	return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Frame WaveStream::decode_(float* out, Frame frames)
+{
+	if (m_src == nullptr)
+		return readSource_(out, std::min(frames, CHUNK_FRAMES));
+
+	Frame produced = 0;
+	while (produced < frames)
+	{
+		if (m_sourceCount == 0 && !m_sourceEnd)
+		{
+			m_sourceStart = 0;
+			m_sourceCount = readSource_(m_source.data(), CHUNK_FRAMES);
+			m_sourceEnd   = m_sourceCount == 0;
+		}
+
+		SRC_DATA data;
+		data.data_in       = m_source.data() + m_sourceStart * G_MAX_IO_CHANS;
+		data.input_frames  = static_cast<long>(m_sourceCount);
+		data.data_out      = out + produced * G_MAX_IO_CHANS;
+		data.output_frames = frames - produced;
+		data.end_of_input  = m_sourceEnd ? 1 : 0;
+		data.src_ratio     = m_ratio;
+
+		if (src_process(m_src, &data) != 0)
+			break;
+
+		m_sourceStart += data.input_frames_used;
+		m_sourceCount -= data.input_frames_used;
+		produced += data.output_frames_gen;
+
+		if (data.output_frames_gen == 0 && data.input_frames_used == 0)
+			break;
+	}
+	return produced;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Frame WaveStream::readSource_(float* out, Frame frames)
+{
+	if (m_info.channels == G_MAX_IO_CHANS)
+		return static_cast<Frame>(sf_readf_float(m_file, out, frames));
+
+	/* Mono: read, then spread to stereo in place starting from the end. */
+
+	const Frame got = static_cast<Frame>(sf_readf_float(m_file, out, frames));
+	for (Frame i = got - 1; i >= 0; i--)
+		out[i * 2] = out[i * 2 + 1] = out[i];
+	return got;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void WaveStream::seek_(Frame frame)
+{
+	sf_seek(m_file, static_cast<sf_count_t>(frame / m_ratio), SEEK_SET);
+	if (m_src != nullptr)
+		src_reset(m_src);
+	m_sourceCount = 0;
+	m_sourceEnd   = false;
+	m_end         = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool WaveStream::sync_()
+{
+	const uint64_t request = m_request.load(std::memory_order_relaxed);
+	if (m_syncedRequest == request)
+		return true;
+	if (m_baseRequest.load(std::memory_order_acquire) != request)
+		return false;
+
+	m_syncedRequest = request;
+	m_syncedFrame   = m_baseFrame.load(std::memory_order_relaxed);
+	m_syncedPos     = m_basePos.load(std::memory_order_relaxed);
+	m_readPos.store(m_syncedPos, std::memory_order_release);
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void WaveStream::requestSeek_(Frame frame)
+{
+	m_target = frame;
+	m_requestFrame.store(frame, std::memory_order_relaxed);
+	m_request.store(m_request.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	waveStreamer::notify();
+}
+
+/* -------------------------------------------------------------------------- */
+
+Frame WaveStream::getRingFrame_() const
+{
+	if (m_syncedRequest != m_request.load(std::memory_order_relaxed))
+		return m_target;
+	return m_syncedFrame + static_cast<Frame>(m_readPos.load(std::memory_order_relaxed) - m_syncedPos);
+}
+} // namespace giada::m
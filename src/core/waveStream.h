@@ -0,0 +1,186 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_WAVE_STREAM_H
+#define G_WAVE_STREAM_H
+
+#include "core/const.h"
+#include "core/types.h"
+#include "deps/mcl-audio-buffer/src/audioBuffer.hpp"
+#include <atomic>
+#include <memory>
+#include <samplerate.h>
+#include <sndfile.h>
+#include <string>
+#include <vector>
+
+namespace giada::m
+{
+/* WaveStream
+Disk-backed audio data for Waves too long to be kept in memory. The first part
+of the file (the head) is preloaded, the rest is decoded ahead of playback by
+the waveStreamer thread into a lock-free ring buffer, converted to stereo and to
+the project sample rate on the fly.
+
+The realtime side (read(), consume()) is meant for a single reader, the channel
+that plays the Wave. When it asks for data the ring doesn't hold (a jump, or 
+disk too slow) it gets silence and a seek request is sent to the streamer, 
+which refills the ring from the new position. */
+
+class WaveStream
+{
+public:
+	/* open
+	Opens file 'path' for streaming at 'samplerate'. Returns nullptr if the file
+	can't be read or has too many channels. */
+
+	static std::unique_ptr<WaveStream> open(const std::string& path, int samplerate,
+	    int quality, Frame headFrames = G_WAVE_STREAM_HEAD_FRAMES);
+
+	WaveStream(SNDFILE* file, const SF_INFO& info, const std::string& path,
+	    int samplerate, int quality, Frame headFrames);
+	WaveStream(const WaveStream&) = delete;
+	~WaveStream();
+
+	/* reopen
+	Returns a new stream on the same file, with the same settings. */
+
+	std::unique_ptr<WaveStream> reopen() const;
+
+	/* countFrames, getRate
+	Length and sample rate of the stream, i.e. the project sample rate the file
+	is converted to. */
+
+	Frame countFrames() const;
+
+	const std::string&      getPath() const;
+	int                     getRate() const;
+	int                     getQuality() const;
+	int                     getSourceRate() const;
+	int                     getSourceBits() const;
+	const mcl::AudioBuffer& getHead() const;
+
+	/* read [realtime]
+	Copies 'count' stereo frames starting at 'start' into 'out'. Frames not
+	available yet are silenced. Doesn't move the stream forward: call consume()
+	afterwards with the number of frames actually used. */
+
+	void read(Frame start, float* out, Frame count);
+
+	/* consume [realtime]
+	Releases frames in range [start, start + count) from the ring buffer. */
+
+	void consume(Frame start, Frame count);
+
+	/* getScratch [realtime]
+	Linear buffer for resampled playback: the resampler needs contiguous input 
+	data, which the ring buffer can't provide. */
+
+	float* getScratch();
+	Frame  getScratchSize() const;
+
+	/* SCRATCH_FRAMES
+	Enough input for a full block at maximum pitch, plus what the resampler
+	keeps buffered internally. */
+
+	static constexpr Frame SCRATCH_FRAMES = G_MAX_BUF_SIZE * static_cast<int>(G_MAX_PITCH) * 2;
+
+	/* fill [streamer thread]
+	Serves pending seek requests and tops up the ring buffer. Returns true if 
+	the ring is full or the end of file has been reached. */
+
+	bool fill();
+
+private:
+	/* decode_
+	Reads up to 'frames' stereo frames from the current file position, 
+	converting them to stereo and resampling them if needed. Returns the number
+	of frames produced. */
+
+	Frame decode_(float* out, Frame frames);
+	Frame readSource_(float* out, Frame frames);
+	void  seek_(Frame frame);
+
+	/* sync_ [realtime]
+	True if the ring is positioned on the latest seek request. */
+
+	bool sync_();
+	void requestSeek_(Frame frame);
+
+	/* getRingFrame_ [realtime]
+	Returns the stream frame the ring buffer is positioned on, or the one it 
+	will be once the pending seek request is served. */
+
+	Frame getRingFrame_() const;
+
+	SNDFILE*    m_file;
+	SF_INFO     m_info;
+	SRC_STATE*  m_src; // Null if no sample rate conversion is needed
+	std::string m_path;
+	int         m_samplerate;
+	int         m_quality;
+	double      m_ratio;
+	Frame       m_frames;
+
+	mcl::AudioBuffer m_head;
+
+	/* Decoder state, streamer thread only. */
+
+	std::vector<float> m_source;      // Stereo source frames, before resampling
+	std::size_t        m_sourceStart; // First pending frame in m_source
+	std::size_t        m_sourceCount; // Pending frames in m_source
+	bool               m_sourceEnd;
+	bool               m_end;
+	uint64_t           m_servedRequest;
+
+	/* Ring buffer. Positions grow forever and are wrapped on access. The 
+	streamer publishes, for each seek request served, the ring position 
+	(m_basePos) holding frame m_baseFrame of the stream. */
+
+	std::vector<float>    m_ring;
+	std::atomic<uint64_t> m_readPos;
+	std::atomic<uint64_t> m_writePos;
+	std::atomic<uint64_t> m_basePos;
+	std::atomic<Frame>    m_baseFrame;
+	std::atomic<uint64_t> m_baseRequest;
+
+	/* Seek requests, realtime thread to streamer. */
+
+	std::atomic<uint64_t> m_request;
+	std::atomic<Frame>    m_requestFrame;
+
+	/* Realtime thread state. m_target is the frame of the latest seek request,
+	m_syncedFrame and m_syncedPos the ring base once the request is served. */
+
+	Frame              m_target;
+	uint64_t           m_syncedRequest;
+	Frame              m_syncedFrame;
+	uint64_t           m_syncedPos;
+	std::vector<float> m_scratch;
+};
+} // namespace giada::m
+
+#endif
@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#include "core/waveStreamer.h"
+#include "core/const.h"
+#include "core/waveStream.h"
+#include "core/worker.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace giada::m::waveStreamer
+{
+namespace
+{
+Worker                   worker_;
+std::mutex               mutex_;
+std::vector<WaveStream*> streams_;
+
+/* -------------------------------------------------------------------------- */
+
+/* fill_
+Tops up all streams, a slice at a time each so that a long refill doesn't 
+starve the others, until they are all done. */
+
+void fill_()
+{
+	std::scoped_lock lock(mutex_);
+
+	bool done = false;
+	while (!done)
+	{
+		done = true;
+		for (WaveStream* s : streams_)
+			done &= s->fill();
+	}
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void init()
+{
+	worker_.startOnNotify(fill_, /*timeout=*/G_WAVE_STREAM_RATE_MS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void close()
+{
+	worker_.stop();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void add(WaveStream* s)
+{
+	std::scoped_lock lock(mutex_);
+	streams_.push_back(s);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void remove(WaveStream* s)
+{
+	std::scoped_lock lock(mutex_);
+	streams_.erase(std::remove(streams_.begin(), streams_.end(), s), streams_.end());
+}
+
+/* -------------------------------------------------------------------------- */
+
+void notify()
+{
+	worker_.notify();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void fill()
+{
+	fill_();
+}
+} // namespace giada::m::waveStreamer
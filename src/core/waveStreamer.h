@@ -0,0 +1,65 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+#ifndef G_WAVE_STREAMER_H
+#define G_WAVE_STREAMER_H
+
+/* giada::m::waveStreamer
+Background thread that keeps the ring buffers of all WaveStreams topped up 
+with audio data read from disk. It wakes up every G_WAVE_STREAM_RATE_MS 
+milliseconds, or earlier when a stream asks for it. */
+
+namespace giada::m
+{
+class WaveStream;
+}
+namespace giada::m::waveStreamer
+{
+void init();
+void close();
+
+/* add, remove
+Registers/unregisters a WaveStream. Called by the WaveStream itself on 
+construction and destruction. remove() waits for the stream to be released by 
+the streamer thread, if busy. Not realtime-safe. */
+
+void add(WaveStream*);
+void remove(WaveStream*);
+
+/* notify
+Wakes up the streamer thread. Lock-free, realtime-safe. */
+
+void notify();
+
+/* fill
+Tops up all streams on the calling thread and returns when they are full. Used
+by the offline renderer, which consumes audio faster than the streamer thread 
+would refill it. Not realtime-safe. */
+
+void fill();
+} // namespace giada::m::waveStreamer
+
+#endif
@@ -57,9 +57,31 @@ void Worker::start(std::function<void()> f, int sleep)
 
 /* -------------------------------------------------------------------------- */
 
+void Worker::startOnNotify(std::function<void()> f, int timeout)
+{
+	m_running.store(true);
+	m_thread = std::thread([this, f, timeout]() {
+		while (m_running.load() == true)
+		{
+			m_notifier.wait(timeout);
+			f();
+		}
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Worker::notify()
+{
+	m_notifier.notify();
+}
+
+/* -------------------------------------------------------------------------- */
+
 void Worker::stop()
 {
 	m_running.store(false);
+	m_notifier.notify();
 	if (m_thread.joinable())
 		m_thread.join();
 }
@@ -27,6 +27,7 @@
 #ifndef G_WORKER_H
 #define G_WORKER_H
 
+#include "core/notifier.h"
 #include <atomic>
 #include <functional>
 #include <thread>
@@ -39,12 +40,30 @@ public:
 	Worker();
 	~Worker();
 
+	/* start
+	Calls 'f' in a loop on a separate thread, sleeping 'sleep' milliseconds 
+	between each call. */
+
 	void start(std::function<void()> f, int sleep);
+
+	/* startOnNotify
+	Calls 'f' on a separate thread every time notify() is invoked, or when
+	'timeout' milliseconds have passed without notifications. */
+
+	void startOnNotify(std::function<void()> f, int timeout);
+
+	/* notify
+	Wakes up a worker started with startOnNotify(). Lock-free and non-blocking,
+	see Notifier. */
+
+	void notify();
+
 	void stop();
 
   private:
 	std::thread       m_thread;
 	std::atomic<bool> m_running;
+	Notifier          m_notifier;
 };
 } // namespace giada
 
@@ -61,6 +61,7 @@
 #include <cassert>
 #include <cmath>
 #include <functional>
+#include <utility>
 
 extern giada::v::gdMainWindow* G_MainWin;
 
@@ -102,6 +103,18 @@ Frame SampleData::getEnd() const { return m_channel->samplePlayer->end; }
 bool  SampleData::getInputMonitor() const { return m_channel->audioReceiver->inputMonitor; }
 bool  SampleData::getOverdubProtection() const { return m_channel->audioReceiver->overdubProtection; }
 
+bool SampleData::getStreamed() const
+{
+	const m::Wave* w = m_channel->samplePlayer->getWave();
+	return w != nullptr && w->isStreamed();
+}
+
+bool SampleData::canStream() const
+{
+	const m::Wave* w = m_channel->samplePlayer->getWave();
+	return w != nullptr && !w->isLogical() && !w->isEdited();
+}
+
 /* -------------------------------------------------------------------------- */
 
 MidiData::MidiData(const m::channel::Data& m)
@@ -158,7 +171,7 @@ Data getData(ID channelId)
 std::vector<Data> getChannels()
 {
 	std::vector<Data> out;
-	for (const m::channel::Data& ch : m::model::get().channels)
+	for (const m::channel::Data& ch : std::as_const(m::model::get().channels))
 		if (!ch.isInternal())
 			out.push_back(Data(ch));
 	return out;
@@ -253,6 +266,15 @@ void setOverdubProtection(ID channelId, bool value)
 
 /* -------------------------------------------------------------------------- */
 
+void setStreamed(ID channelId, bool value)
+{
+	int res = m::mh::setWaveStreamed(channelId, value);
+	if (res != G_RES_OK)
+		printLoadError_(res);
+}
+
+/* -------------------------------------------------------------------------- */
+
 void cloneChannel(ID channelId)
 {
 	m::mh::cloneChannel(channelId);
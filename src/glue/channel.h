@@ -50,6 +50,12 @@ struct SampleData
 	Frame getEnd() const;
 	bool  getInputMonitor() const;
 	bool  getOverdubProtection() const;
+	bool  getStreamed() const;
+
+	/* canStream
+	True if the sample is backed by an unedited file on disk. */
+
+	bool canStream() const;
 
 	ID               waveId;
 	SamplePlayerMode mode;
@@ -155,6 +161,7 @@ Sets several channel properties. */
 
 void setInputMonitor(ID channelId, bool value);
 void setOverdubProtection(ID channelId, bool value);
+void setStreamed(ID channelId, bool value);
 void setName(ID channelId, const std::string& name);
 void setHeight(ID channelId, Pixel p);
 
@@ -28,6 +28,7 @@
 #include "core/conf.h"
 #include "core/const.h"
 #include "core/kernelAudio.h"
+#include "core/model/model.h"
 #include "deps/rtaudio/RtAudio.h"
 
 namespace giada::c::config
@@ -146,6 +147,8 @@ AudioData getAudioData()
 	audioData.limitOutput     = m::conf::conf.limitOutput;
 	audioData.recTriggerLevel = m::conf::conf.recTriggerLevel;
 	audioData.resampleQuality = m::conf::conf.rsmpQuality;
+	audioData.sampleFormat    = m::model::get().sampleFormat;
+	audioData.projectAudio    = m::conf::conf.projectAudio;
 	audioData.outputDevice    = getAudioDeviceData_(DeviceType::OUTPUT,
         m::conf::conf.soundDeviceOut, m::conf::conf.channelsOutCount,
         m::conf::conf.channelsOutStart);
@@ -172,5 +175,12 @@ void save(const AudioData& data)
 	m::conf::conf.buffersize       = data.bufferSize;
 	m::conf::conf.recTriggerLevel  = data.recTriggerLevel;
 	m::conf::conf.samplerate       = data.sampleRate;
+	m::conf::conf.projectAudio     = data.projectAudio;
+
+	/* The sample format belongs to the project: it is applied to Waves loaded 
+	from now on and saved in the patch, so that a reload packs them all. */
+
+	m::model::get().sampleFormat = data.sampleFormat;
+	m::model::swap(m::model::SwapType::NONE);
 }
 } // namespace giada::c::config
\ No newline at end of file
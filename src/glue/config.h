@@ -80,6 +80,8 @@ struct AudioData
 	bool            limitOutput;
 	float           recTriggerLevel;
 	int             resampleQuality;
+	SampleFormat    sampleFormat; // Per project, stored in the patch
+	ProjectAudio    projectAudio;
 };
 
 /* getAudioData
@@ -61,18 +61,20 @@ namespace giada::c::events
 {
 namespace
 {
-void pushEvent_(m::eventDispatcher::Event e, Thread t)
+void pushEvent_(m::eventDispatcher::Event e, Thread t, Timestamp time = {})
 {
+	e.timestamp = time;
+
 	bool res = true;
 	if (t == Thread::MAIN)
-		res = m::eventDispatcher::UIevents.push(e);
+		res = m::eventDispatcher::pumpUIevent(e);
 	else if (t == Thread::MIDI)
-		res = m::eventDispatcher::MidiEvents.push(e);
+		res = m::eventDispatcher::pumpMidiEvent(e);
 	else
 		assert(false);
 
 	if (!res)
-		G_DEBUG("[events] Queue full!\n");
+		u::log::printAsync(u::log::Subsystem::EVENTS, u::log::Level::WARNING, "[events] Queue full!\n");
 }
 } // namespace
 
@@ -80,21 +82,19 @@ void pushEvent_(m::eventDispatcher::Event e, Thread t)
 /* -------------------------------------------------------------------------- */
 /* -------------------------------------------------------------------------- */
 
-void pressChannel(ID channelId, int velocity, Thread t)
+void pressChannel(ID channelId, int velocity, Thread t, Timestamp time)
 {
-	m::MidiEvent e;
-	e.setVelocity(velocity);
-	pushEvent_({m::eventDispatcher::EventType::KEY_PRESS, 0, channelId, velocity}, t);
+	pushEvent_({m::eventDispatcher::EventType::KEY_PRESS, 0, channelId, velocity}, t, time);
 }
 
-void releaseChannel(ID channelId, Thread t)
+void releaseChannel(ID channelId, Thread t, Timestamp time)
 {
-	pushEvent_({m::eventDispatcher::EventType::KEY_RELEASE, 0, channelId, {}}, t);
+	pushEvent_({m::eventDispatcher::EventType::KEY_RELEASE, 0, channelId, {}}, t, time);
 }
 
-void killChannel(ID channelId, Thread t)
+void killChannel(ID channelId, Thread t, Timestamp time)
 {
-	pushEvent_({m::eventDispatcher::EventType::KEY_KILL, 0, channelId, {}}, t);
+	pushEvent_({m::eventDispatcher::EventType::KEY_KILL, 0, channelId, {}}, t, time);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -169,9 +169,9 @@ void killReadActionsChannel(ID channelId, Thread t)
 
 /* -------------------------------------------------------------------------- */
 
-void sendMidiToChannel(ID channelId, m::MidiEvent e, Thread t)
+void sendMidiToChannel(ID channelId, m::MidiEvent e, Thread t, Timestamp time)
 {
-	pushEvent_({m::eventDispatcher::EventType::MIDI, 0, channelId, m::Action{0, channelId, 0, e}}, t);
+	pushEvent_({m::eventDispatcher::EventType::MIDI, 0, channelId, m::Action{0, channelId, 0, e}}, t, time);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -242,6 +242,11 @@ void rewindSequencer(Thread t)
 	pushEvent_({m::eventDispatcher::EventType::SEQUENCER_REWIND, 0, 0, {}}, t);
 }
 
+void setSequencerBpm(float bpm, Thread t)
+{
+	pushEvent_({m::eventDispatcher::EventType::SEQUENCER_BPM, 0, 0, bpm}, t);
+}
+
 /* -------------------------------------------------------------------------- */
 
 void toggleActionRecording()
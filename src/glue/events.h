@@ -41,11 +41,13 @@ class MidiEvent;
 namespace giada::c::events
 {
 /* Channel*
-Channel-related events. */
+Channel-related events. The optional 'time' parameter is when the gesture took
+place, if known (e.g. the timestamp of a MIDI message): it is used to play the
+event at the exact frame. Defaults to now. */
 
-void pressChannel(ID channelId, int velocity, Thread t);
-void releaseChannel(ID channelId, Thread t);
-void killChannel(ID channelId, Thread t);
+void pressChannel(ID channelId, int velocity, Thread t, Timestamp time = {});
+void releaseChannel(ID channelId, Thread t, Timestamp time = {});
+void killChannel(ID channelId, Thread t, Timestamp time = {});
 void setChannelVolume(ID channelId, float v, Thread t);
 void setChannelPitch(ID channelId, float v, Thread t);
 void sendChannelPan(ID channelId, float v); // FIXME typo: should be setChannelPan
@@ -54,7 +56,7 @@ void toggleSoloChannel(ID channelId, Thread t);
 void toggleArmChannel(ID channelId, Thread t);
 void toggleReadActionsChannel(ID channelId, Thread t);
 void killReadActionsChannel(ID channelId, Thread t);
-void sendMidiToChannel(ID channelId, m::MidiEvent e, Thread t);
+void sendMidiToChannel(ID channelId, m::MidiEvent e, Thread t, Timestamp time = {});
 
 /* Main*
 Master I/O, transport and other engine-related events. */
@@ -68,6 +70,7 @@ void startSequencer(Thread t);
 void stopSequencer(Thread t);
 void toggleSequencer(Thread t);
 void rewindSequencer(Thread t);
+void setSequencerBpm(float bpm, Thread t);
 void toggleActionRecording();
 void toggleInputRecording();
 
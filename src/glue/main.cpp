@@ -39,6 +39,7 @@
 #include "core/recManager.h"
 #include "core/recorder.h"
 #include "core/recorderHandler.h"
+#include "core/waveManager.h"
 #include "gui/dialogs/mainWindow.h"
 #include "gui/dialogs/warnings.h"
 #include "gui/elems/mainWindow/keyboard/keyboard.h"
@@ -238,6 +239,11 @@ void toggleFreeInputRec()
 
 void closeProject()
 {
+	if (m::waveManager::isSaving())
+	{
+		v::gdAlert("The project is being saved, please wait.");
+		return;
+	}
 	if (!v::gdConfirmWin("Warning", "Close project: are you sure?"))
 		return;
 	m::init::reset();
@@ -50,6 +50,7 @@
 #include "utils/log.h"
 #include <FL/Fl.H>
 #include <cassert>
+#include <memory>
 
 extern giada::v::gdMainWindow* G_MainWin;
 
@@ -83,6 +84,23 @@ Frame previewTracker_ = 0;
 
 /* -------------------------------------------------------------------------- */
 
+/* editWave_
+Applies 'f' to a copy of the channel's Wave, then replaces the original one 
+with it, in the preview channel too. The audio thread keeps playing the 
+original Wave until the swap; it is destroyed afterwards. */
+
+template <typename F>
+void editWave_(ID channelId, F f)
+{
+	std::unique_ptr<m::Wave> wave = m::waveManager::clone(getWave_(channelId));
+
+	f(*wave);
+
+	m::mh::replaceWave(channelId, std::move(wave));
+}
+
+/* -------------------------------------------------------------------------- */
+
 /* resetBeginEnd_
 Resets begin/end points to 0/max. */
 
@@ -107,7 +125,7 @@ Data::Data(const m::channel::Data& c)
 , begin(c.samplePlayer->begin)
 , end(c.samplePlayer->end)
 , shift(c.samplePlayer->shift)
-, waveSize(c.samplePlayer->getWave()->getBuffer().countFrames())
+, waveSize(c.samplePlayer->getWave()->countFrames())
 , waveBits(c.samplePlayer->getWave()->getBits())
 , waveDuration(c.samplePlayer->getWave()->getDuration())
 , waveRate(c.samplePlayer->getWave()->getRate())
@@ -138,6 +156,12 @@ const m::Wave& Data::getWaveRef() const
 
 Data getData(ID channelId)
 {
+	/* The editor works on float data: replace a packed Wave with an unpacked
+	copy (see m::waveManager::clone()). */
+
+	if (getWave_(channelId).isPacked())
+		editWave_(channelId, [](m::Wave&) {});
+
 	/* Prepare the preview channel first, then return Data object. */
 	m::samplePlayer::loadWave(getChannel_(m::mixer::PREVIEW_CHANNEL_ID), &getWave_(channelId));
 	m::model::swap(m::model::SwapType::SOFT);
@@ -195,8 +219,7 @@ void setBeginEnd(ID channelId, Frame b, Frame e)
 void cut(ID channelId, Frame a, Frame b)
 {
 	copy(channelId, a, b);
-	m::model::DataLock lock;
-	m::wfx::cut(getWave_(channelId), a, b);
+	editWave_(channelId, [a, b](m::Wave& w) { m::wfx::cut(w, a, b); });
 	resetBeginEnd_(channelId);
 }
 
@@ -217,22 +240,10 @@ void paste(ID channelId, Frame a)
 		return;
 	}
 
-	/* Get the existing wave in channel. */
-
-	m::Wave& wave = getWave_(channelId);
-
-	/* Temporary disable wave reading in channel. From now on, the audio thread
-	won't be reading any wave, so editing it is safe.  */
-
-	m::model::DataLock lock;
+	/* Paste copied data to a copy of the destination wave, which then replaces
+	the original one in channel. */
 
-	/* Paste copied data to destination wave. */
-
-	m::wfx::paste(*waveBuffer_, wave, a);
-
-	/* Pass the old wave that contains the pasted data to channel. */
-
-	m::samplePlayer::setWave(getChannel_(channelId), &wave, 1.0f);
+	editWave_(channelId, [a](m::Wave& w) { m::wfx::paste(*waveBuffer_, w, a); });
 
 	/* In the meantime, shift begin/end points to keep the previous position. */
 
@@ -252,48 +263,42 @@ void paste(ID channelId, Frame a)
 
 void silence(ID channelId, int a, int b)
 {
-	m::model::DataLock lock;
-	m::wfx::silence(getWave_(channelId), a, b);
+	editWave_(channelId, [a, b](m::Wave& w) { m::wfx::silence(w, a, b); });
 }
 
 /* -------------------------------------------------------------------------- */
 
 void fade(ID channelId, int a, int b, m::wfx::Fade type)
 {
-	m::model::DataLock lock;
-	m::wfx::fade(getWave_(channelId), a, b, type);
+	editWave_(channelId, [a, b, type](m::Wave& w) { m::wfx::fade(w, a, b, type); });
 }
 
 /* -------------------------------------------------------------------------- */
 
 void smoothEdges(ID channelId, int a, int b)
 {
-	m::model::DataLock lock;
-	m::wfx::smooth(getWave_(channelId), a, b);
+	editWave_(channelId, [a, b](m::Wave& w) { m::wfx::smooth(w, a, b); });
 }
 
 /* -------------------------------------------------------------------------- */
 
 void reverse(ID channelId, Frame a, Frame b)
 {
-	m::model::DataLock lock;
-	m::wfx::reverse(getWave_(channelId), a, b);
+	editWave_(channelId, [a, b](m::Wave& w) { m::wfx::reverse(w, a, b); });
 }
 
 /* -------------------------------------------------------------------------- */
 
 void normalize(ID channelId, int a, int b)
 {
-	m::model::DataLock lock;
-	m::wfx::normalize(getWave_(channelId), a, b);
+	editWave_(channelId, [a, b](m::Wave& w) { m::wfx::normalize(w, a, b); });
 }
 
 /* -------------------------------------------------------------------------- */
 
 void trim(ID channelId, int a, int b)
 {
-	m::model::DataLock lock;
-	m::wfx::trim(getWave_(channelId), a, b);
+	editWave_(channelId, [a, b](m::Wave& w) { m::wfx::trim(w, a, b); });
 	resetBeginEnd_(channelId);
 }
 
@@ -378,9 +383,9 @@ void shift(ID channelId, Frame offset)
 
 	Frame shift = getSamplePlayer_(channelId).shift;
 
-	mm::DataLock lock();
-	m::wfx::shift(getWave_(channelId), offset - shift);
+	editWave_(channelId, [offset, shift](m::Wave& w) { m::wfx::shift(w, offset - shift); });
 	getSamplePlayer_(channelId).shift = offset;
+	mm::swap(mm::SwapType::SOFT);
 
 	getSampleEditorWindow()->shiftTool->update(offset);
 }
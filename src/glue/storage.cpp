@@ -53,7 +53,13 @@
 #include "utils/gui.h"
 #include "utils/log.h"
 #include "utils/string.h"
+#include "utils/time.h"
+#include <FL/Fl.H>
+#include <atomic>
 #include <cassert>
+#include <memory>
+#include <thread>
+#include <vector>
 
 extern giada::v::gdMainWindow* G_MainWin;
 
@@ -65,9 +71,22 @@ namespace storage
 {
 namespace
 {
+/* getProjectExtension_
+Waves are saved as FLAC if the project audio format says so and their bit depth
+allows it. Otherwise they keep their own extension, unless it's .flac: the file
+is going to hold float WAV data. */
+
+std::string getProjectExtension_(const m::Wave& w)
+{
+	const bool flac = m::conf::conf.projectAudio == ProjectAudio::FLAC && m::waveManager::isFlacCompatible(w);
+	if (flac)
+		return ".flac";
+	return w.getExtension() == ".flac" ? ".wav" : w.getExtension();
+}
+
 std::string makeWavePath_(const std::string& base, const m::Wave& w, int k)
 {
-	return base + G_SLASH + w.getBasename(/*ext=*/false) + "-" + std::to_string(k) + w.getExtension();
+	return base + G_SLASH + w.getBasename(/*ext=*/false) + "-" + std::to_string(k) + getProjectExtension_(w);
 }
 
 bool isWavePathUnique_(const m::Wave& skip, const std::string& path)
@@ -80,7 +99,7 @@ bool isWavePathUnique_(const m::Wave& skip, const std::string& path)
 
 std::string makeUniqueWavePath_(const std::string& base, const m::Wave& w)
 {
-	std::string path = base + G_SLASH + w.getBasename(/*ext=*/true);
+	std::string path = base + G_SLASH + w.getBasename(/*ext=*/false) + getProjectExtension_(w);
 	if (isWavePathUnique_(w, path))
 		return path;
 
@@ -114,14 +133,159 @@ bool savePatch_(const std::string& path, const std::string& name)
 
 /* -------------------------------------------------------------------------- */
 
-void saveWavesToProject_(const std::string& basePath)
+/* ProjectSave_
+A project being saved. Audio goes first, in background: the patch is written 
+only when all Waves are safely on disk, so that it never refers to missing or
+partial files. Shared with the thread running the save. */
+
+struct ProjectSave_
+{
+	v::gdBrowserSave*                          browser;
+	std::string                                path; // Project folder
+	std::string                                gptcPath;
+	std::string                                name;
+	std::unique_ptr<m::waveManager::SaveBatch> batch;
+	std::atomic<float>                         progress = 0.0f;
+	std::atomic<bool>                          ok       = false;
+	float                                      shown    = 0.0f; // Progress on screen
+};
+
+/* projectSave_
+The project save in progress, if any. Main thread only. */
+
+std::shared_ptr<ProjectSave_> projectSave_;
+
+/* -------------------------------------------------------------------------- */
+
+/* getBrowser_
+Returns the browser the project save was started from, or nullptr if it has 
+been closed in the meantime. */
+
+v::gdBrowserSave* getBrowser_(const ProjectSave_& save)
+{
+	v::gdWindow* w = u::gui::getSubwindow(G_MainWin, WID_FILE_BROWSER);
+	return w != nullptr && w == save.browser ? save.browser : nullptr;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* getWaves_
+Returns all Waves in the model. */
+
+std::vector<m::Wave*> getWaves_()
 {
+	std::vector<m::Wave*> waves;
 	for (const std::unique_ptr<m::Wave>& w : m::model::getAll<m::model::WavePtrs>())
+		waves.push_back(w.get());
+	return waves;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void saveWavesToProject_();
+
+/* onSaveProgress_, onSaveDone_
+Fl::awake() callbacks, invoked on the main thread by the thread saving Waves. 
+When done, Waves are saved again if they have changed or new ones have been 
+loaded meanwhile. */
+
+void onSaveProgress_(void* /*data*/)
+{
+	if (projectSave_ == nullptr)
+		return;
+	if (v::gdBrowserSave* browser = getBrowser_(*projectSave_); browser != nullptr)
 	{
-		w->setPath(makeUniqueWavePath_(basePath, *w));
-		m::waveManager::save(*w, w->getPath()); // TODO - error checking
+		const float progress = projectSave_->progress.load();
+		browser->setStatusBar(progress - projectSave_->shown);
+		projectSave_->shown = progress;
 	}
 }
+
+void onSaveDone_(void* /*data*/)
+{
+	const bool ok = projectSave_->ok.load(); // Acquire the saving thread's writes
+
+	m::waveManager::finishSave(*projectSave_->batch, getWaves_());
+
+	if (!ok)
+	{
+		if (v::gdBrowserSave* browser = getBrowser_(*projectSave_); browser != nullptr)
+			browser->hideStatusBar();
+		projectSave_ = nullptr;
+		v::gdAlert("Unable to save the project audio files!");
+		return;
+	}
+
+	saveWavesToProject_();
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* savePatchToProject_
+Last step of a project save: the patch, then the browser goes away. */
+
+void savePatchToProject_()
+{
+	const std::shared_ptr<ProjectSave_> save    = std::move(projectSave_);
+	v::gdBrowserSave*                   browser = getBrowser_(*save);
+
+	if (browser != nullptr)
+		browser->hideStatusBar();
+
+	if (!savePatch_(save->gptcPath, save->name))
+		v::gdAlert("Unable to save the project!");
+	else if (browser != nullptr)
+		browser->do_callback();
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* saveWavesToProject_
+Moves all Waves to the project folder and writes the ones not already there, 
+or changed since the last save, on a separate thread. The UI keeps running 
+meanwhile: progress and completion come back through Fl::awake(). Writes the
+patch straight away if there's nothing to save. */
+
+void saveWavesToProject_()
+{
+	ProjectSave_& save = *projectSave_;
+
+	std::vector<m::Wave*> waves = getWaves_();
+	for (m::Wave* w : waves)
+		w->setPath(makeUniqueWavePath_(save.path, *w));
+
+	std::unique_ptr<m::waveManager::SaveBatch> batch = m::waveManager::prepareSave(waves);
+	assert(batch != nullptr);
+
+	if (batch->jobs.empty())
+	{
+		m::waveManager::finishSave(*batch, waves);
+		savePatchToProject_();
+		return;
+	}
+
+	if (v::gdBrowserSave* browser = getBrowser_(save); browser != nullptr)
+	{
+		browser->showStatusBar();
+		browser->setStatusBar(-save.shown);
+	}
+
+	save.batch    = std::move(batch);
+	save.progress = 0.0f;
+	save.shown    = 0.0f;
+
+	std::thread([save = projectSave_]() {
+		save->ok = m::waveManager::runSave(*save->batch, [&save](float p) {
+			save->progress = p;
+			Fl::awake(onSaveProgress_, nullptr);
+		});
+
+		/* The awake queue might be full: completion must not get lost. */
+
+		while (Fl::awake(onSaveDone_, nullptr) != 0)
+			u::time::sleep(G_PATCH_LOAD_PROGRESS_RATE_MS);
+	}).detach();
+}
 } // namespace
 
 /* -------------------------------------------------------------------------- */
@@ -133,6 +297,12 @@ void loadProject(void* data)
 	v::gdBrowserLoad* browser  = static_cast<v::gdBrowserLoad*>(data);
 	std::string       fullPath = browser->getSelectedItem();
 
+	if (m::waveManager::isSaving())
+	{
+		v::gdAlert("The project is being saved, please wait.");
+		return;
+	}
+
 	browser->showStatusBar();
 
 	u::log::print("[loadProject] load from %s\n", fullPath);
@@ -160,7 +330,12 @@ void loadProject(void* data)
 
 	m::init::reset();
 	v::model::load(m::patch::patch);
-	m::model::load(m::patch::patch);
+
+	float progress = 0.0f;
+	m::model::load(m::patch::patch, [browser, &progress](float p) {
+		browser->setStatusBar(p - progress);
+		progress = p;
+	});
 
 	/* Prepare the engine. Recorder has to recompute the actions positions if 
 	the current samplerate != patch samplerate. Clock needs to update frames
@@ -207,6 +382,12 @@ void saveProject(void* data)
 		return;
 	}
 
+	if (m::waveManager::isSaving())
+	{
+		v::gdAlert("The project is being saved, please wait.");
+		return;
+	}
+
 	if (u::fs::dirExists(fullPath) && !v::gdConfirmWin("Warning", "Project exists: overwrite?"))
 		return;
 
@@ -218,12 +399,14 @@ void saveProject(void* data)
 
 	u::log::print("[saveProject] Project dir created: %s\n", fullPath);
 
-	saveWavesToProject_(fullPath);
+	projectSave_ = std::make_shared<ProjectSave_>();
 
-	if (savePatch_(gptcPath, name))
-		browser->do_callback();
-	else
-		v::gdAlert("Unable to save the project!");
+	projectSave_->browser  = browser;
+	projectSave_->path     = fullPath;
+	projectSave_->gptcPath = gptcPath;
+	projectSave_->name     = name;
+
+	saveWavesToProject_();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -283,11 +466,12 @@ void saveSample(void* data)
 
 	m::conf::conf.samplePath = u::fs::dirname(filePath);
 
-	/* Update logical and edited states in Wave. */
+	/* Update logical and edited states in Wave. These flags are never read by
+	the audio thread. */
 
-	m::model::DataLock lock;
 	wave->setLogical(false);
 	wave->setEdited(false);
+	m::model::swap(m::model::SwapType::HARD);
 
 	/* Finally close the browser. */
 
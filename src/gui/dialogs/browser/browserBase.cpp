@@ -136,7 +136,8 @@ void gdBrowserBase::cb_toggleHiddenFiles()
 void gdBrowserBase::setStatusBar(float v)
 {
 	status->value(status->value() + v);
-	Fl::wait(0);
+	status->redraw();
+	Fl::flush();
 }
 
 /* -------------------------------------------------------------------------- */
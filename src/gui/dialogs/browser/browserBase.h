@@ -62,7 +62,9 @@ public:
 	void        fireCallback() const;
 
 	/* setStatusBar
-	Increments status bar for progress tracking. */
+	Increments status bar for progress tracking. The bar is redrawn straight 
+	away, but no events are dispatched: callers are in the middle of loading or 
+	saving, and must not be re-entered by other UI actions. */
 
 	void setStatusBar(float v);
 
@@ -126,7 +126,9 @@ geTabAudio::geTabAudio(int X, int Y, int W, int H)
 	channelsIn      = new geChannelMenu(x() + 114, y() + 149, 55, 20, "Input channels", m_data.inputDevice);
 	recTriggerLevel = new geInput(x() + 309, y() + 149, 55, 20, "Rec threshold (dB)");
 	rsmpQuality     = new geChoice(x() + 114, y() + 177, 250, 20, "Resampling");
-	new geBox(x(), rsmpQuality->y() + rsmpQuality->h() + 8, w(), 92, "Restart Giada for the changes to take effect.");
+	sampleFormat    = new geChoice(x() + 114, y() + 205, 250, 20, "Sample memory");
+	projectAudio    = new geChoice(x() + 114, y() + 233, 250, 20, "Project audio");
+	new geBox(x(), projectAudio->y() + projectAudio->h() + 8, w(), 36, "Restart Giada for the changes to take effect.");
 	end();
 
 	labelsize(G_GUI_FONT_SIZE_BASE);
@@ -180,9 +182,25 @@ geTabAudio::geTabAudio(int X, int Y, int W, int H)
 	rsmpQuality->addItem("Sinc basic quality (medium)", 2);
 	rsmpQuality->addItem("Zero Order Hold (fast)", 3);
 	rsmpQuality->addItem("Linear (very fast)", 4);
+	rsmpQuality->addItem("Built-in cubic (very fast)", 5);
+	rsmpQuality->addItem("Built-in polyphase basic (fast)", 6);
+	rsmpQuality->addItem("Built-in polyphase best (medium)", 7);
 	rsmpQuality->showItem(m_data.resampleQuality);
 	rsmpQuality->onChange = [this](ID id) { m_data.resampleQuality = id; };
 
+	sampleFormat->addItem("Float 32-bit (default)", static_cast<ID>(SampleFormat::FLOAT));
+	sampleFormat->addItem("Integer 16-bit (lossless up to 16-bit)", static_cast<ID>(SampleFormat::INT16));
+	sampleFormat->addItem("Float 16-bit (lossy)", static_cast<ID>(SampleFormat::HALF));
+	sampleFormat->showItem(static_cast<ID>(m_data.sampleFormat));
+	sampleFormat->copy_tooltip("In-memory format of the samples in this project");
+	sampleFormat->onChange = [this](ID id) { m_data.sampleFormat = static_cast<SampleFormat>(id); };
+
+	projectAudio->addItem("WAV, 32-bit float", static_cast<ID>(ProjectAudio::WAV));
+	projectAudio->addItem("FLAC where possible, lossless", static_cast<ID>(ProjectAudio::FLAC));
+	projectAudio->showItem(static_cast<ID>(m_data.projectAudio));
+	projectAudio->copy_tooltip("Format of the audio files in saved projects");
+	projectAudio->onChange = [this](ID id) { m_data.projectAudio = static_cast<ProjectAudio>(id); };
+
 	recTriggerLevel->value(u::string::fToString(m_data.recTriggerLevel, 1).c_str());
 	recTriggerLevel->onChange = [this](const std::string& s) { m_data.recTriggerLevel = std::stof(s); };
 
@@ -75,6 +75,8 @@ public:
 	geChannelMenu* channelsIn;
 	geInput*       recTriggerLevel;
 	geChoice*      rsmpQuality;
+	geChoice*      sampleFormat;
+	geChoice*      projectAudio;
 
 private:
 	void invalidate();
@@ -65,12 +65,15 @@ geTabMidi::geTabMidi(int X, int Y, int W, int H)
 	sync->add("(disabled)");
 	sync->add("MIDI Clock (master)");
 	sync->add("MTC (master)");
+	sync->add("MIDI Clock (slave)");
 	if (m::conf::conf.midiSync == MIDI_SYNC_NONE)
 		sync->value(0);
 	else if (m::conf::conf.midiSync == MIDI_SYNC_CLOCK_M)
 		sync->value(1);
 	else if (m::conf::conf.midiSync == MIDI_SYNC_MTC_M)
 		sync->value(2);
+	else if (m::conf::conf.midiSync == MIDI_SYNC_CLOCK_S)
+		sync->value(3);
 
 	systemInitValue = system->value();
 }
@@ -170,6 +173,8 @@ void geTabMidi::save()
 		m::conf::conf.midiSync = MIDI_SYNC_CLOCK_M;
 	else if (sync->value() == 2)
 		m::conf::conf.midiSync = MIDI_SYNC_MTC_M;
+	else if (sync->value() == 3)
+		m::conf::conf.midiSync = MIDI_SYNC_CLOCK_S;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -77,6 +77,7 @@ enum class Menu
 	OVERDUB_PROTECTION,
 	LOAD_SAMPLE,
 	EXPORT_SAMPLE,
+	STREAM_SAMPLE,
 	SETUP_KEYBOARD_INPUT,
 	SETUP_MIDI_INPUT,
 	SETUP_MIDI_OUTPUT,
@@ -126,6 +127,11 @@ void menuCallback(Fl_Widget* w, void* v)
 		u::gui::openSubWindow(G_MainWin, w, WID_FILE_BROWSER);
 		break;
 	}
+	case Menu::STREAM_SAMPLE:
+	{
+		c::channel::setStreamed(data.id, !data.sample->getStreamed());
+		break;
+	}
 	case Menu::SETUP_KEYBOARD_INPUT:
 	{
 		u::gui::openSubWindow(G_MainWin, new gdKeyGrabber(data),
@@ -305,6 +311,8 @@ void geSampleChannel::cb_openMenu()
 	        FL_MENU_TOGGLE | FL_MENU_DIVIDER | (m_channel.sample->getOverdubProtection() ? FL_MENU_VALUE : 0)},
 	    {"Load new sample...", 0, menuCallback, (void*)Menu::LOAD_SAMPLE},
 	    {"Export sample to file...", 0, menuCallback, (void*)Menu::EXPORT_SAMPLE},
+	    {"Stream from disk", 0, menuCallback, (void*)Menu::STREAM_SAMPLE,
+	        FL_MENU_TOGGLE | (m_channel.sample->getStreamed() ? FL_MENU_VALUE : 0)},
 	    {"Setup keyboard input...", 0, menuCallback, (void*)Menu::SETUP_KEYBOARD_INPUT},
 	    {"Setup MIDI input...", 0, menuCallback, (void*)Menu::SETUP_MIDI_INPUT},
 	    {"Setup MIDI output...", 0, menuCallback, (void*)Menu::SETUP_MIDI_OUTPUT},
@@ -324,11 +332,20 @@ void geSampleChannel::cb_openMenu()
 	if (m_channel.sample->waveId == 0)
 	{
 		rclick_menu[(int)Menu::EXPORT_SAMPLE].deactivate();
+		rclick_menu[(int)Menu::STREAM_SAMPLE].deactivate();
 		rclick_menu[(int)Menu::EDIT_SAMPLE].deactivate();
 		rclick_menu[(int)Menu::FREE_CHANNEL].deactivate();
 		rclick_menu[(int)Menu::RENAME_CHANNEL].deactivate();
 	}
 
+	if (!m_channel.sample->canStream())
+		rclick_menu[(int)Menu::STREAM_SAMPLE].deactivate();
+
+	/* Streamed samples are not in memory: they can't be edited. */
+
+	if (m_channel.sample->getStreamed())
+		rclick_menu[(int)Menu::EDIT_SAMPLE].deactivate();
+
 	if (!m_channel.hasActions)
 		rclick_menu[(int)Menu::CLEAR_ACTIONS].deactivate();
 
@@ -31,6 +31,7 @@
 #include "core/model/model.h"
 #include "core/wave.h"
 #include "core/waveFx.h"
+#include "core/wavePeaks.h"
 #include "glue/channel.h"
 #include "glue/sampleEditor.h"
 #include "gui/dialogs/sampleEditor.h"
@@ -39,8 +40,10 @@
 #include "waveTools.h"
 #include <FL/Fl_Menu_Button.H>
 #include <FL/fl_draw.H>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <memory>
 
 namespace giada
 {
@@ -111,46 +114,30 @@ int geWaveform::alloc(int datasize, bool force)
 
 	int gridFreq = m_grid.level != 0 ? wave.getBuffer().countFrames() / m_grid.level : 0;
 
-	/* Resampling the waveform, hardcore way. Many thanks to 
-	http://fourier.eng.hmc.edu/e161/lectures/resize/node3.html */
+	if (gridFreq != 0)
+		for (Frame k = gridFreq; k < wave.getBuffer().countFrames(); k += gridFreq)
+			m_grid.points.push_back(k);
 
-	for (int i = 0; i < m_waveform.size; i++)
-	{
-
-		/* Scan the original waveform in chunks [pc, pn]. */
-
-		int pc = i * m_ratio;       // current point TODO - int until we switch to uint32_t for Wave size...
-		int pn = (i + 1) * m_ratio; // next point    TODO - int until we switch to uint32_t for Wave size...
-
-		float peaksup = 0.0f;
-		float peakinf = 0.0f;
-
-		for (int k = pc; k < pn; k++)
-		{ // TODO - int until we switch to uint32_t for Wave size...
+	/* Read peaks from the Wave's peak pyramid, so that each pixel costs the 
+	same at any zoom level. Fall back to scanning audio data if the pyramid 
+	is still being computed. */
 
-			if (k >= wave.getBuffer().countFrames())
-				continue;
+	const mcl::AudioBuffer&             buffer = wave.getBuffer();
+	std::shared_ptr<const m::WavePeaks> peaks  = wave.getPeaks();
+	if (peaks != nullptr && peaks->countFrames() != buffer.countFrames())
+		peaks = nullptr;
 
-			/* Compute average of stereo signal. */
-
-			float  avg   = 0.0f;
-			float* frame = wave.getBuffer()[k];
-			for (int j = 0; j < wave.getBuffer().countChannels(); j++)
-				avg += frame[j];
-			avg /= wave.getBuffer().countChannels();
-
-			/* Find peaks (greater and lower). */
-
-			if (avg > peaksup)
-				peaksup = avg;
-			else if (avg <= peakinf)
-				peakinf = avg;
+	for (int i = 0; i < m_waveform.size; i++)
+	{
+		Frame pc = i * m_ratio;
+		Frame pn = std::min<Frame>((i + 1) * m_ratio, buffer.countFrames());
 
-			/* Fill up grid vector. */
+		m::WavePeaks::Peak peak;
+		if (pc < pn)
+			peak = peaks != nullptr ? peaks->get(buffer, pc, pn) : m::WavePeaks::scan(buffer, pc, pn);
 
-			if (gridFreq != 0 && (int)k % gridFreq == 0 && k != 0)
-				m_grid.points.push_back(k);
-		}
+		float peaksup = std::max(peak.max, 0.0f);
+		float peakinf = std::min(peak.min, 0.0f);
 
 		m_waveform.sup[i] = zero - (peaksup * offset);
 		m_waveform.inf[i] = zero - (peakinf * offset);
@@ -27,13 +27,25 @@
 #include "core/init.h"
 #include "gui/dialogs/mainWindow.h"
 #include <FL/Fl.H>
+#include <cstring>
 #ifdef WITH_TESTS
 #define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "tests/channelTable.cpp"
+#include "tests/dsp.cpp"
+#include "tests/midiScheduler.cpp"
+#include "tests/mixerHandler.cpp"
+#include "tests/ramp.cpp"
 #include "tests/recorder.cpp"
+#include "tests/renderPool.cpp"
+#include "tests/resampler.cpp"
+#include "tests/sequencer.cpp"
+#include "tests/sync.cpp"
 #include "tests/utils.cpp"
 #include "tests/wave.cpp"
 #include "tests/waveFx.cpp"
 #include "tests/waveManager.cpp"
+#include "tests/worker.cpp"
 #include <catch2/catch.hpp>
 #include <string>
 #include <vector>
@@ -49,6 +61,9 @@ int main(int argc, char** argv)
 		return Catch::Session().run(args.size() - 1, &args[1]);
 #endif
 
+	if (argc > 1 && strcmp(argv[1], "--render") == 0)
+		return giada::m::init::render(argc, argv);
+
 	giada::m::init::startup(argc, argv);
 
 	Fl::lock(); // Enable multithreading in FLTK
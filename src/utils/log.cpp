@@ -27,11 +27,83 @@
  * -------------------------------------------------------------------------- */
 
 #include "log.h"
+#include "core/worker.h"
 #include <cstdio>
 #include <string>
 
 namespace giada::u::log
 {
+namespace
+{
+/* Cell
+A slot of the async queue. The sequence number tells producers and consumer 
+whether the slot is free or holds a record (bounded MPMC queue by D. Vyukov). */
+
+struct Cell
+{
+	std::atomic<std::size_t> sequence;
+	Record                   record;
+};
+
+static_assert((G_LOG_QUEUE_SIZE & (G_LOG_QUEUE_SIZE - 1)) == 0, "G_LOG_QUEUE_SIZE must be a power of 2");
+
+std::array<Cell, G_LOG_QUEUE_SIZE> cells_;
+std::atomic<std::size_t>           enqueuePos_ = 0;
+std::atomic<std::size_t>           dequeuePos_ = 0;
+std::atomic<std::size_t>           dropped_    = 0;
+
+Worker worker_;
+
+/* -------------------------------------------------------------------------- */
+
+void initQueue_()
+{
+	for (std::size_t i = 0; i < cells_.size(); i++)
+		cells_[i].sequence.store(i, std::memory_order_relaxed);
+	enqueuePos_.store(0);
+	dequeuePos_.store(0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* pop_
+Single consumer: called by the logger thread only. */
+
+bool pop_(Record& r)
+{
+	const std::size_t pos  = dequeuePos_.load(std::memory_order_relaxed);
+	Cell&             cell = cells_[pos & (cells_.size() - 1)];
+
+	if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+		return false;
+
+	r = cell.record;
+	dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+	cell.sequence.store(pos + cells_.size(), std::memory_order_release);
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void drain_()
+{
+	char   line[G_LOG_LINE_SIZE];
+	Record r;
+	while (pop_(r))
+	{
+		r.formatter(line, sizeof(line), r);
+		print("%s", line);
+	}
+
+	if (std::size_t dropped = dropped_.exchange(0); dropped > 0)
+		print("[log] %d records dropped\n", static_cast<int>(dropped));
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
 int init(int m)
 {
 	mode = m;
@@ -41,19 +113,70 @@ int init(int m)
 		std::string fpath = fs::getHomePath() + G_SLASH + "giada.log";
 		f                 = std::fopen(fpath.c_str(), "a");
 		if (!f)
-		{
 			stat = false;
-			return 0;
-		}
 	}
-	return 1;
+
+#ifdef G_DEBUG_MODE
+	const Level defaultLevel = Level::VERBOSE;
+#else
+	const Level defaultLevel = Level::INFO;
+#endif
+	for (std::atomic<Level>& l : levels)
+		l.store(defaultLevel);
+
+	initQueue_();
+	worker_.start(drain_, G_LOG_DRAIN_RATE_MS);
+
+	return stat ? 1 : 0;
 }
 
 /* -------------------------------------------------------------------------- */
 
 void close()
 {
-	if (mode == LOG_MODE_FILE)
+	worker_.stop();
+	drain_();
+
+	if (mode == LOG_MODE_FILE && stat == true)
 		std::fclose(f);
 }
+
+/* -------------------------------------------------------------------------- */
+
+void setLevel(Subsystem s, Level l)
+{
+	levels[static_cast<int>(s)].store(l);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool push(const Record& r)
+{
+	std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+	Cell*       cell;
+
+	while (true)
+	{
+		cell                 = &cells_[pos & (cells_.size() - 1)];
+		const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+		const auto        diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+		if (diff == 0)
+		{
+			if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0) // Queue full
+		{
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+			pos = enqueuePos_.load(std::memory_order_relaxed);
+	}
+
+	cell->record = r;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
 } // namespace giada::u::log
@@ -31,6 +31,9 @@
 
 #include "core/const.h"
 #include "utils/fs.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <string>
 #include <type_traits>
@@ -38,18 +41,135 @@
 
 namespace giada::u::log
 {
+/* Subsystem, Level
+Each async log record belongs to a subsystem, which has its own verbosity 
+level. Records below the current level of their subsystem are discarded on the
+spot, before touching the queue. */
+
+enum class Subsystem : int
+{
+	GENERIC = 0,
+	AUDIO,
+	MIDI,
+	EVENTS,
+	COUNT
+};
+
+enum class Level : int
+{
+	VERBOSE = 0,
+	INFO,
+	WARNING,
+	SILENT
+};
+
+/* Record
+A fixed-size entry of the async log queue. Formatting is deferred to the 
+logger thread: a record stores the format string, the raw arguments and a 
+function that knows how to read them back. */
+
+struct Record
+{
+	union Arg
+	{
+		long long          i;
+		unsigned long long u;
+		double             d;
+		const void*        p;
+	};
+
+	using Formatter = int (*)(char* out, std::size_t size, const Record& r);
+
+	Formatter                          formatter = nullptr;
+	const char*                        format    = nullptr;
+	std::array<Arg, G_LOG_MAX_ARGS>    args      = {};
+};
+
 inline FILE* f;
 inline int   mode;
 inline bool  stat;
 
+inline std::array<std::atomic<Level>, static_cast<int>(Subsystem::COUNT)> levels;
+
 /* init
-Initializes logger. Mode defines where to write the output: LOG_MODE_STDOUT,
-LOG_MODE_FILE and LOG_MODE_MUTE. */
+Initializes logger and starts the async logger thread. Mode defines where to
+write the output: LOG_MODE_STDOUT, LOG_MODE_FILE and LOG_MODE_MUTE. */
 
 int init(int mode);
 
+/* close
+Stops the async logger thread, flushing pending records. */
+
 void close();
 
+/* setLevel, isEnabled
+Set and query the verbosity level of a subsystem. isEnabled() is lock-free and
+cheap, use it to skip expensive argument preparation. */
+
+void setLevel(Subsystem s, Level l);
+
+inline bool isEnabled(Subsystem s, Level l)
+{
+	return mode != LOG_MODE_MUTE && l >= levels[static_cast<int>(s)].load(std::memory_order_relaxed);
+}
+
+/* push
+Internal function: pushes a record into the async queue. Lock-free and 
+wait-free for the caller, safe from any thread. Returns false and drops the
+record if the queue is full. */
+
+bool push(const Record& r);
+
+/* toArg, fromArg
+Internal utility functions for storing arguments into a Record::Arg. */
+
+template <typename T>
+Record::Arg toArg(T v)
+{
+	Record::Arg a{};
+	if constexpr (std::is_floating_point_v<T>)
+		a.d = v;
+	else if constexpr (std::is_pointer_v<T>)
+		a.p = v;
+	else if constexpr (std::is_enum_v<T> || std::is_signed_v<T>)
+		a.i = static_cast<long long>(v);
+	else
+		a.u = v;
+	return a;
+}
+
+template <typename T>
+T fromArg(Record::Arg a)
+{
+	if constexpr (std::is_floating_point_v<T>)
+		return static_cast<T>(a.d);
+	else if constexpr (std::is_pointer_v<T>)
+		return static_cast<T>(a.p);
+	else if constexpr (std::is_enum_v<T> || std::is_signed_v<T>)
+		return static_cast<T>(a.i);
+	else
+		return static_cast<T>(a.u);
+}
+
+/* formatRecord
+Internal utility function, invoked by the logger thread to turn a Record 
+created by printAsync<Args...>() into text. */
+
+template <typename... Args, std::size_t... I>
+int formatRecord(char* out, std::size_t size, const Record& r, std::index_sequence<I...>)
+{
+	if constexpr (sizeof...(Args) == 0)
+		return std::snprintf(out, size, "%s", r.format);
+	else
+		return std::snprintf(out, size, r.format, fromArg<Args>(r.args[I])...);
+}
+
+template <typename... Args>
+int formatRecord(char* out, std::size_t size, const Record& r)
+{
+	return formatRecord<Args...>(out, size, r, std::index_sequence_for<Args...>{});
+}
+
 /* string_to_c_str
 Internal utility function for string transformation. Uses forwarding references
 (&&) to avoid useless string copy. */
@@ -89,6 +209,29 @@ static void print(const char* format, Args&&... args)
 	else
 		std::printf(format, string_to_c_str(std::forward<Args>(args))...);
 }
+
+/* printAsync
+A non-blocking, allocation-free variant of print(), for latency-sensitive 
+threads (audio, MIDI, event dispatcher). The record is queued and formatted 
+later by the logger thread. Only numbers and pointers are allowed as 
+arguments: strings must be literals or otherwise outlive the record. */
+
+template <typename... Args>
+void printAsync(Subsystem s, Level l, const char* format, Args... args)
+{
+	static_assert(sizeof...(Args) <= G_LOG_MAX_ARGS, "Too many arguments");
+	static_assert(((std::is_arithmetic_v<Args> || std::is_enum_v<Args> || std::is_pointer_v<Args>)&&...),
+	    "Only numbers and pointers can be logged asynchronously");
+
+	if (!isEnabled(s, l))
+		return;
+
+	Record r;
+	r.formatter = &formatRecord<Args...>;
+	r.format    = format;
+	r.args      = {toArg(args)...};
+	push(r);
+}
 } // namespace giada::u::log
 
 #endif
@@ -0,0 +1,124 @@
+#include "../src/core/model/channelTable.h"
+#include "../src/core/channels/channel.h"
+#include "../src/core/const.h"
+#include "../src/core/model/model.h"
+#include "../src/core/swapper.h"
+#include "../src/core/types.h"
+#include <catch2/catch.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST_CASE("ChannelTable")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	channel::State  state;
+	channel::Buffer buffer(G_DEFAULT_BUFSIZE);
+
+	model::ChannelTable src;
+	for (ID id = 1; id <= 4; id++)
+		src.push_back(channel::Data(ChannelType::MIDI, id, /*columnId=*/1, state, buffer));
+
+	model::ChannelTable dst;
+	dst = src;
+
+	REQUIRE(dst.size() == 4);
+
+	SECTION("Test versioned copy")
+	{
+		src[2].volume = 0.5f;
+		src[2].name   = "changed";
+
+		/* Alter dst behind the table's back: a channel that didn't change in
+		src must not be copied again. */
+
+		const_cast<channel::Data&>(std::as_const(dst)[1]).name = "untouched";
+
+		dst = src;
+
+		REQUIRE(std::as_const(dst)[2].volume == 0.5f);
+		REQUIRE(std::as_const(dst)[2].name == "changed");
+		REQUIRE(std::as_const(dst)[1].name == "untouched");
+	}
+
+	SECTION("Test structural changes")
+	{
+		const uint64_t structureVersion = src.getStructureVersion();
+
+		src[0].volume = 0.1f;
+		REQUIRE(src.getStructureVersion() == structureVersion);
+
+		src.removeIf([](const channel::Data& c) { return c.id == 2; });
+		src.push_back(channel::Data(ChannelType::MIDI, 5, /*columnId=*/1, state, buffer));
+
+		dst = src;
+
+		REQUIRE(src.getStructureVersion() != structureVersion);
+		REQUIRE(dst.getStructureVersion() == src.getStructureVersion());
+		REQUIRE(dst.size() == 4);
+		REQUIRE(std::as_const(dst)[1].id == 3);
+		REQUIRE(std::as_const(dst)[3].id == 5);
+		REQUIRE(dst.indexOf(4) == 2);
+	}
+
+	SECTION("Test clear and refill with same IDs")
+	{
+		src.clear();
+		for (ID id = 1; id <= 4; id++)
+		{
+			src.push_back(channel::Data(ChannelType::MIDI, id, /*columnId=*/1, state, buffer));
+			src.back().name = "new";
+		}
+
+		dst = src;
+
+		for (std::size_t i = 0; i < dst.size(); i++)
+			REQUIRE(std::as_const(dst)[i].name == "new");
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("Layout swap cost", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	channel::State  state;
+	channel::Buffer buffer(G_DEFAULT_BUFSIZE);
+
+	for (int count : {16, 64, 256, 1024})
+	{
+		Swapper<model::Layout>     swapper;
+		std::vector<channel::Data> plain;
+
+		for (ID id = 1; id <= count; id++)
+		{
+			channel::Data ch(ChannelType::MIDI, id, /*columnId=*/1, state, buffer);
+			ch.name = "Channel " + std::to_string(id);
+			swapper.get().channels.push_back(ch);
+			plain.push_back(ch);
+		}
+		swapper.swap();
+
+		const std::string suffix = " (" + std::to_string(count) + " channels)";
+
+		/* Full copy of the channel vector: what every swap used to cost. */
+
+		BENCHMARK("full copy" + suffix)
+		{
+			return std::vector<channel::Data>(plain);
+		};
+
+		/* Versioned swap, with one channel changed (e.g. a fader sweep). */
+
+		BENCHMARK("swap, one channel changed" + suffix)
+		{
+			swapper.get().channels[count / 2].volume = 0.5f;
+			swapper.swap();
+			return swapper.get().channels.size();
+		};
+	}
+}
@@ -0,0 +1,288 @@
+#include "../src/core/dsp.h"
+#include "../src/core/const.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+void fill_(mcl::AudioBuffer& b, float seed)
+{
+	for (int i = 0; i < b.countFrames(); i++)
+		for (int j = 0; j < b.countChannels(); j++)
+			b[i][j] = std::sin((i * b.countChannels() + j) * seed) * 1.5f;
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("dsp")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* An odd number of frames, so that SIMD kernels have leftovers to deal 
+	with. */
+
+	constexpr int FRAMES = 1001;
+
+	for (dsp::Isa isa : {dsp::Isa::SCALAR, dsp::Isa::SSE2, dsp::Isa::AVX2, dsp::Isa::NEON})
+	{
+		if (!dsp::setIsa(isa))
+			continue;
+
+		mcl::AudioBuffer a(FRAMES, 2);
+		mcl::AudioBuffer b(FRAMES, 2);
+		fill_(a, 0.1f);
+		fill_(b, 0.7f);
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " sum")
+		{
+			mcl::AudioBuffer mono(FRAMES, 1);
+			fill_(mono, 0.3f);
+
+			mcl::AudioBuffer expected(FRAMES, 2);
+			for (int i = 0; i < FRAMES; i++)
+			{
+				expected[i][0] = a[i][0] + b[i][0] * 0.5f * 0.2f + mono[i][0] * 0.8f;
+				expected[i][1] = a[i][1] + b[i][1] * 0.5f * 0.8f + mono[i][0] * 0.8f;
+			}
+
+			dsp::sum(a, b, 0.5f, {0.2f, 0.8f});
+			dsp::sum(a, mono, 0.8f);
+
+			for (int i = 0; i < FRAMES; i++)
+				for (int j = 0; j < 2; j++)
+					REQUIRE(a[i][j] == Approx(expected[i][j]));
+		}
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " sum with ramp")
+		{
+			constexpr Frame RAMP = 333;
+
+			mcl::AudioBuffer expected(FRAMES, 2);
+			for (int i = 0; i < FRAMES; i++)
+			{
+				const float t = std::min(i, RAMP) / static_cast<float>(RAMP);
+				expected[i][0] = a[i][0] + b[i][0] * (0.2f + (1.0f - 0.2f) * t);
+				expected[i][1] = a[i][1] + b[i][1] * (0.9f + (0.1f - 0.9f) * t);
+			}
+
+			dsp::sumRamp(a, b, RAMP, {0.2f, 0.9f}, {1.0f, 0.1f});
+
+			for (int i = 0; i < FRAMES; i++)
+				for (int j = 0; j < 2; j++)
+					REQUIRE(a[i][j] == Approx(expected[i][j]).margin(1e-5));
+		}
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " sum with ramp longer than buffer")
+		{
+			/* The ramp is squeezed into the buffer, with no frames left at the
+			target gain. */
+
+			mcl::AudioBuffer expected(FRAMES, 2);
+			for (int i = 0; i < FRAMES; i++)
+			{
+				const float t = i / static_cast<float>(FRAMES);
+				expected[i][0] = a[i][0] + b[i][0] * (0.2f + (1.0f - 0.2f) * t);
+				expected[i][1] = a[i][1] + b[i][1] * (0.9f + (0.1f - 0.9f) * t);
+			}
+
+			dsp::sumRamp(a, b, G_PARAM_RAMP_FRAMES, {0.2f, 0.9f}, {1.0f, 0.1f});
+
+			for (int i = 0; i < FRAMES; i++)
+				for (int j = 0; j < 2; j++)
+					REQUIRE(a[i][j] == Approx(expected[i][j]).margin(1e-5));
+		}
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " sum mono with offset")
+		{
+			const float click[] = {0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f};
+
+			a.clear();
+			dsp::sumMono(a, click, 3, 9);
+
+			for (int i = 0; i < FRAMES; i++)
+				for (int j = 0; j < 2; j++)
+					REQUIRE(a[i][j] == (i >= 3 && i < 12 ? click[i - 3] : 0.0f));
+		}
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " gain and clamp")
+		{
+			dsp::applyGain(b, 0.5f);
+			dsp::clamp(a, -1.0f, 1.0f);
+
+			for (int i = 0; i < FRAMES; i++)
+				for (int j = 0; j < 2; j++)
+				{
+					REQUIRE(b[i][j] == std::sin((i * 2 + j) * 0.7f) * 1.5f * 0.5f);
+					REQUIRE(a[i][j] == std::clamp(std::sin((i * 2 + j) * 0.1f) * 1.5f, -1.0f, 1.0f));
+				}
+		}
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " peak")
+		{
+			a.clear();
+			a[FRAMES - 1][0] = -0.9f; // In the leftovers
+			a[17][1]         = 0.4f;
+			a[18][1]         = -0.3f;
+
+			const Peak peak = dsp::getPeak(a);
+
+			REQUIRE(peak.left == 0.9f);
+			REQUIRE(peak.right == 0.4f);
+		}
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " decode")
+		{
+			/* Every 16-bit value, in both formats. */
+
+			std::vector<uint16_t> packed(65536);
+			std::vector<uint16_t> repacked(65536);
+			std::vector<float>    floats(65536);
+			std::iota(packed.begin(), packed.end(), 0);
+
+			dsp::decode(floats.data(), packed.data(), 65536, SampleFormat::INT16);
+
+			for (int i = 0; i < 65536; i++)
+				REQUIRE(floats[i] == static_cast<int16_t>(i) / 32768.0f);
+			REQUIRE(dsp::encode(repacked.data(), floats.data(), 65536, SampleFormat::INT16));
+			REQUIRE(repacked == packed);
+
+			/* Half floats survive a round trip, infinities and NaNs apart. */
+
+			dsp::decode(floats.data(), packed.data(), 65536, SampleFormat::HALF);
+			dsp::encode(repacked.data(), floats.data(), 65536, SampleFormat::HALF);
+
+			REQUIRE(floats[0x3C00] == 1.0f);
+			REQUIRE(floats[0xC000] == -2.0f);
+			REQUIRE(floats[0x0001] == std::ldexp(1.0f, -24)); // Smallest subnormal
+			for (int i = 0; i < 65536; i++)
+				if ((i & 0x7C00) != 0x7C00)
+					REQUIRE(repacked[i] == packed[i]);
+		}
+
+		DYNAMIC_SECTION("Test " << dsp::toString(isa) << " interpolate")
+		{
+			std::vector<float> ca(32), cb(32);
+			for (int i = 0; i < 32; i++)
+			{
+				ca[i] = std::sin(i * 0.4f);
+				cb[i] = std::cos(i * 0.9f);
+			}
+
+			for (int taps : {4, 8, 12, 32})
+			{
+				double left = 0.0, right = 0.0;
+				for (int i = 0; i < taps; i++)
+				{
+					const double c = ca[i] + (cb[i] - ca[i]) * 0.3;
+					left += a[i][0] * c;
+					right += a[i][1] * c;
+				}
+
+				float l, r;
+				dsp::interpolate(a[0], ca.data(), cb.data(), 0.3f, taps, l, r);
+
+				REQUIRE(l == Approx(left).margin(1e-5));
+				REQUIRE(r == Approx(right).margin(1e-5));
+			}
+		}
+	}
+
+	dsp::init();
+}
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("DSP kernels", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Per-sample loops as found in the mixer before the kernel layer, against
+	each kernel set supported by this CPU. */
+
+	mcl::AudioBuffer in(G_DEFAULT_BUFSIZE, G_MAX_IO_CHANS);
+	mcl::AudioBuffer out(G_DEFAULT_BUFSIZE, G_MAX_IO_CHANS);
+	fill_(in, 0.1f);
+	fill_(out, 0.3f);
+
+	BENCHMARK("loops: sum, gain, limit, peak")
+	{
+		out.sum(in, 0.5f, {0.3f, 0.7f});
+		out.applyGain(0.9f);
+		for (int i = 0; i < out.countFrames(); i++)
+			for (int j = 0; j < out.countChannels(); j++)
+				out[i][j] = std::max(-1.0f, std::min(out[i][j], 1.0f));
+		return Peak{out.getPeak(0), out.getPeak(1)};
+	};
+
+	for (dsp::Isa isa : {dsp::Isa::SCALAR, dsp::Isa::SSE2, dsp::Isa::AVX2, dsp::Isa::NEON})
+	{
+		if (!dsp::setIsa(isa))
+			continue;
+
+		BENCHMARK(std::string(dsp::toString(isa)) + ": sum, gain, limit, peak")
+		{
+			dsp::sum(out, in, 0.5f, {0.3f, 0.7f});
+			dsp::applyGain(out, 0.9f);
+			dsp::clamp(out, -1.0f, 1.0f);
+			return dsp::getPeak(out);
+		};
+	}
+
+	dsp::init();
+}
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("Sample decoding", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Cost of reading one block of one channel out of a Wave: plain copy of 
+	float data, against decoding of packed data. */
+
+	mcl::AudioBuffer in(G_DEFAULT_BUFSIZE, G_MAX_IO_CHANS);
+	mcl::AudioBuffer out(G_DEFAULT_BUFSIZE, G_MAX_IO_CHANS);
+	fill_(in, 0.1f);
+	dsp::clamp(in, -1.0f, 0.99f);
+
+	const int             samples = in.countSamples();
+	std::vector<uint16_t> int16(samples);
+	std::vector<uint16_t> half(samples);
+	dsp::encode(half.data(), in[0], samples, SampleFormat::HALF);
+	for (int i = 0; i < samples; i++)
+		int16[i] = static_cast<uint16_t>(static_cast<int16_t>(in[0][i] * 32768.0f));
+
+	BENCHMARK("float: copy")
+	{
+		out.set(in, in.countFrames());
+		return out[0][0];
+	};
+
+	for (dsp::Isa isa : {dsp::Isa::SCALAR, dsp::Isa::SSE2, dsp::Isa::AVX2, dsp::Isa::NEON})
+	{
+		if (!dsp::setIsa(isa))
+			continue;
+
+		BENCHMARK(std::string(dsp::toString(isa)) + ": decode int16")
+		{
+			dsp::decode(out[0], int16.data(), samples, SampleFormat::INT16);
+			return out[0][0];
+		};
+
+		BENCHMARK(std::string(dsp::toString(isa)) + ": decode half")
+		{
+			dsp::decode(out[0], half.data(), samples, SampleFormat::HALF);
+			return out[0][0];
+		};
+	}
+
+	dsp::init();
+}
@@ -0,0 +1,69 @@
+#include "../src/core/midiScheduler.h"
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_CASE("midiScheduler")
+{
+	using namespace giada;
+	using namespace std::chrono;
+
+	struct Sent
+	{
+		uint32_t  raw;
+		Timestamp time;
+	};
+
+	constexpr Frame BUFFER_SIZE = 256;
+	constexpr int   SAMPLE_RATE = 44100;
+
+	std::mutex        mutex;
+	std::vector<Sent> sent;
+
+	m::midiScheduler::init([&](uint32_t raw) {
+		std::scoped_lock lock(mutex);
+		sent.push_back({raw, steady_clock::now()});
+	});
+
+	SECTION("Test timing")
+	{
+		/* Two consecutive blocks, with messages out of order in the first 
+		one. */
+
+		const Timestamp block1 = steady_clock::now();
+		const Timestamp block2 = block1 + microseconds(5805);
+
+		m::midiScheduler::startBlock(block1, BUFFER_SIZE, SAMPLE_RATE);
+		m::midiScheduler::schedule(0x90400000, 200);
+		m::midiScheduler::schedule(0x90410000, 10);
+		m::midiScheduler::startBlock(block2, BUFFER_SIZE, SAMPLE_RATE);
+		m::midiScheduler::schedule(0x80400000, 0);
+
+		while (steady_clock::now() - block1 < seconds(5))
+		{
+			std::scoped_lock lock(mutex);
+			if (sent.size() == 3)
+				break;
+		}
+
+		/* Messages leave in time order, one block after their frame and never
+		earlier. */
+
+		auto getTime = [](Timestamp block, Frame frame) {
+			return block + duration_cast<steady_clock::duration>(duration<double>((BUFFER_SIZE + frame) / double(SAMPLE_RATE)));
+		};
+
+		std::scoped_lock lock(mutex);
+		REQUIRE(sent.size() == 3);
+		REQUIRE(sent[0].raw == 0x90410000);
+		REQUIRE(sent[1].raw == 0x90400000);
+		REQUIRE(sent[2].raw == 0x80400000);
+		REQUIRE(sent[0].time >= getTime(block1, 10));
+		REQUIRE(sent[1].time >= getTime(block1, 200));
+		REQUIRE(sent[2].time >= getTime(block2, 0));
+	}
+
+	m::midiScheduler::close();
+}
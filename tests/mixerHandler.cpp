@@ -0,0 +1,63 @@
+#include "../src/core/mixerHandler.h"
+#include "../src/core/channels/channel.h"
+#include "../src/core/channels/samplePlayer.h"
+#include "../src/core/const.h"
+#include "../src/core/mixer.h"
+#include "../src/core/model/model.h"
+#include "../src/core/wave.h"
+#include "../src/core/waveManager.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("mixerHandler")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	constexpr ID CHANNEL_ID = 100;
+
+	channel::State  state;
+	channel::Buffer buffer(G_DEFAULT_BUFSIZE);
+	state.resampler = Resampler(Resampler::Quality::CUBIC, G_MAX_IO_CHANS);
+
+	model::get().channels.clear();
+	model::get().channels.push_back(channel::Data(ChannelType::SAMPLE, CHANNEL_ID, /*columnId=*/1, state, buffer));
+	model::get().channels.push_back(channel::Data(ChannelType::PREVIEW, mixer::PREVIEW_CHANNEL_ID, /*columnId=*/0, state, buffer));
+
+	model::add(waveManager::createEmpty(1024, G_MAX_IO_CHANS, G_DEFAULT_SAMPLERATE, "test.wav"));
+	Wave& wave = model::back<Wave>();
+
+	samplePlayer::loadWave(model::get().getChannel(CHANNEL_ID), &wave);
+	model::swap(model::SwapType::NONE);
+
+	SECTION("Test replace Wave while previewed")
+	{
+		/* The Sample Editor shows the Wave in the preview channel, then edits
+		it: the preview channel must not be left with the retired Wave. */
+
+		samplePlayer::loadWave(model::get().getChannel(mixer::PREVIEW_CHANNEL_ID), &wave);
+		model::swap(model::SwapType::SOFT);
+
+		mh::replaceWave(CHANNEL_ID, waveManager::clone(wave));
+
+		const Wave* edited = model::get().getChannel(CHANNEL_ID).samplePlayer->getWave();
+
+		REQUIRE(model::getAll<model::WavePtrs>().size() == 1);
+		REQUIRE(model::getAll<model::WavePtrs>()[0].get() == edited);
+		REQUIRE(model::get().getChannel(mixer::PREVIEW_CHANNEL_ID).samplePlayer->getWave() == edited);
+	}
+
+	SECTION("Test free channel while previewed")
+	{
+		samplePlayer::loadWave(model::get().getChannel(mixer::PREVIEW_CHANNEL_ID), &wave);
+		model::swap(model::SwapType::SOFT);
+
+		mh::freeChannel(CHANNEL_ID);
+
+		REQUIRE(model::getAll<model::WavePtrs>().empty());
+		REQUIRE(model::get().getChannel(mixer::PREVIEW_CHANNEL_ID).samplePlayer->getWave() == nullptr);
+	}
+
+	model::get().channels.clear();
+	model::clear<model::WavePtrs>();
+	model::swap(model::SwapType::NONE);
+}
@@ -0,0 +1,65 @@
+#include "../src/core/ramp.h"
+#include "../src/core/const.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("Ramp")
+{
+	using namespace giada;
+
+	constexpr Frame BLOCK = G_PARAM_RAMP_FRAMES / 4;
+
+	Ramp ramp(0.0f);
+
+	SECTION("Test still")
+	{
+		const Ramp::Block b = ramp.advance(BLOCK);
+
+		REQUIRE(b.frames == 0);
+		REQUIRE(b.start == 0.0f);
+		REQUIRE(b.end == 0.0f);
+	}
+
+	SECTION("Test glide")
+	{
+		ramp.setTarget(1.0f);
+
+		for (int i = 0; i < 4; i++)
+		{
+			const Ramp::Block b = ramp.advance(BLOCK);
+
+			REQUIRE(b.frames == BLOCK);
+			REQUIRE(b.start == Approx(i * 0.25f));
+			REQUIRE(b.end == Approx((i + 1) * 0.25f));
+		}
+
+		REQUIRE(ramp.advance(BLOCK).frames == 0);
+		REQUIRE(ramp.advance(BLOCK).end == 1.0f);
+	}
+
+	SECTION("Test new target while gliding")
+	{
+		ramp.setTarget(1.0f);
+		ramp.advance(G_PARAM_RAMP_FRAMES / 2);
+		ramp.setTarget(0.0f);
+
+		/* Glides back from 0.5 over a full ramp. */
+
+		const Ramp::Block b = ramp.advance(G_PARAM_RAMP_FRAMES * 2);
+
+		REQUIRE(b.start == Approx(0.5f));
+		REQUIRE(b.end == 0.0f);
+		REQUIRE(b.frames == G_PARAM_RAMP_FRAMES);
+	}
+
+	SECTION("Test jump")
+	{
+		ramp.setTarget(1.0f);
+		ramp.advance(BLOCK);
+		ramp.jump(0.7f);
+
+		const Ramp::Block b = ramp.advance(BLOCK);
+
+		REQUIRE(b.frames == 0);
+		REQUIRE(b.end == 0.7f);
+	}
+}
@@ -1,6 +1,8 @@
 #include "../src/core/recorder.h"
 #include "../src/core/action.h"
+#include "../src/core/actionTimeline.h"
 #include "../src/core/const.h"
+#include "../src/core/model/model.h"
 #include "../src/core/types.h"
 #include <catch2/catch.hpp>
 
@@ -62,5 +64,50 @@ TEST_CASE("recorder")
 			recorder::clearAll();
 			REQUIRE(recorder::hasActions(/*channel=*/0) == false);
 		}
+
+		SECTION("Test timeline")
+		{
+			recorder::rec(ch, f1, e2);     // Same frame as a1
+			recorder::rec(ch + 1, f1, e1); // Same frame, another channel
+
+			ActionTimeline timeline;
+			timeline.build(model::getAll<model::Actions>());
+
+			REQUIRE(timeline.size() == 2);
+			REQUIRE(timeline[0].frame == f1);
+			REQUIRE(timeline[0].actions->size() == 3);
+			REQUIRE(timeline[1].frame == f2);
+			REQUIRE(timeline[1].actions->size() == 1);
+
+			/* Actions bucketed by channel, in recording order. */
+
+			REQUIRE(timeline[0].getActions(ch).size() == 2);
+			REQUIRE(timeline[0].getActions(ch).begin()->event.getStatus() == MidiEvent::NOTE_ON);
+			REQUIRE(timeline[0].getActions(ch + 1).size() == 1);
+			REQUIRE(timeline[0].getActions(ch + 1).begin()->channelId == ch + 1);
+			REQUIRE(timeline[1].getActions(ch).size() == 1);
+			REQUIRE(timeline[1].getActions(ch + 1).empty());
+
+			REQUIRE(timeline.find(0) == 0);
+			REQUIRE(timeline.find(f1) == 0);
+			REQUIRE(timeline.find(f1 + 1) == 1);
+			REQUIRE(timeline.find(f2 + 1) == 2);
+			REQUIRE(timeline.find(f1 + 1, /*hint=*/1) == 1);
+			REQUIRE(timeline.find(f1 + 1, /*hint=*/2) == 1); // Wrong hint
+		}
+
+		SECTION("Test snapshot publication")
+		{
+			const ActionTimeline* old = model::get().timeline;
+
+			recorder::rec(ch, f1, e2);
+
+			/* A new snapshot is published on every change, and the layout
+			points to its timeline. */
+
+			REQUIRE(model::get().timeline != old);
+			REQUIRE(model::get().timeline == &model::getAll<ActionTimeline>());
+			REQUIRE(model::get().timeline->size() == 2);
+		}
 	}
 }
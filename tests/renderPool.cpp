@@ -0,0 +1,94 @@
+#include "../src/core/renderPool.h"
+#include "../src/core/const.h"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <string>
+#include <vector>
+
+TEST_CASE("RenderPool")
+{
+	using namespace giada;
+
+	SECTION("Test serial pool")
+	{
+		RenderPool pool;
+		pool.start(/*threads=*/1);
+
+		std::vector<int> calls(16, 0);
+		auto             job = [&calls](std::size_t i) { calls[i]++; };
+		pool.run(calls.size(), job);
+
+		REQUIRE(pool.countThreads() == 1);
+		REQUIRE(calls == std::vector<int>(16, 1));
+	}
+
+	SECTION("Test each job runs once per batch")
+	{
+		constexpr int BATCHES = 1000;
+
+		RenderPool pool;
+		pool.start(/*threads=*/4);
+
+		std::vector<std::atomic<int>> calls(64);
+		auto                          job = [&calls](std::size_t i) { calls[i]++; };
+
+		/* Odd batches are shorter: leftovers from a previous batch must never be
+		picked up again. */
+
+		for (int b = 0; b < BATCHES; b++)
+			pool.run(b % 2 == 0 ? calls.size() : calls.size() / 2, job);
+
+		REQUIRE(pool.countThreads() <= 4);
+		for (std::size_t i = 0; i < calls.size(); i++)
+			REQUIRE(calls[i].load() == (i < calls.size() / 2 ? BATCHES : BATCHES / 2));
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("Parallel channel rendering", "[.][benchmark]")
+{
+	using namespace giada;
+
+	/* Each fake channel runs a one-pole filter a few times over its own stereo
+	buffer, roughly the cost of a resampled sample channel, then all buffers are
+	summed serially into the output as mixer::processChannels_() does. */
+
+	constexpr int FRAMES = G_DEFAULT_BUFSIZE * G_MAX_IO_CHANS;
+	constexpr int PASSES = 8;
+
+	for (int count : {8, 32, 128})
+	{
+		std::vector<std::vector<float>> buffers(count, std::vector<float>(FRAMES));
+		std::vector<float>              out(FRAMES);
+
+		auto renderChannel = [&buffers](std::size_t c) {
+			std::vector<float>& buf = buffers[c];
+			float               z   = 0.0f;
+			for (int p = 0; p < PASSES; p++)
+				for (int i = 0; i < FRAMES; i++)
+				{
+					z      = z * 0.99f + std::sin(static_cast<float>(i + c)) * 0.01f;
+					buf[i] = z;
+				}
+		};
+
+		for (int threads : {1, 2, 4, 8})
+		{
+			RenderPool pool;
+			pool.start(threads);
+
+			BENCHMARK(std::to_string(count) + " channels, " + std::to_string(threads) + " threads")
+			{
+				pool.run(buffers.size(), renderChannel);
+				std::fill(out.begin(), out.end(), 0.0f);
+				for (const std::vector<float>& buf : buffers)
+					for (int i = 0; i < FRAMES; i++)
+						out[i] += buf[i];
+				return out[0];
+			};
+		}
+	}
+}
@@ -0,0 +1,204 @@
+#include "../src/core/resampler.h"
+#include "../src/core/const.h"
+#include "../src/core/dsp.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+/* makeSine_
+Interleaved stereo sine wave, 'freq' cycles per frame. The right channel is at
+half the amplitude of the left one. */
+
+std::vector<float> makeSine_(int frames, double freq)
+{
+	std::vector<float> out(frames * 2);
+	for (int i = 0; i < frames; i++)
+	{
+		out[i * 2]     = static_cast<float>(std::sin(2.0 * 3.14159265358979 * freq * i) * 0.8);
+		out[i * 2 + 1] = out[i * 2] * 0.5f;
+	}
+	return out;
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("Resampler")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static_assert(std::is_trivially_copyable_v<Interpolator>);
+
+	constexpr int FRAMES = 4096;
+
+	std::vector<float> input = makeSine_(FRAMES, 0.01);
+	std::vector<float> output(FRAMES * 2 * 2);
+
+	for (Resampler::Quality q : {Resampler::Quality::CUBIC, Resampler::Quality::POLYPHASE_FAST,
+	         Resampler::Quality::POLYPHASE_BEST})
+	{
+		Resampler r(q, G_MAX_IO_CHANS);
+
+		DYNAMIC_SECTION("Test built-in quality " << static_cast<int>(q) << " at unity ratio")
+		{
+			const Resampler::Result res = r.process(input.data(), 0, FRAMES, output.data(), FRAMES, 1.0f);
+
+			/* The last few frames are held back as lookahead. */
+
+			REQUIRE(res.used == FRAMES);
+			REQUIRE(res.generated < FRAMES);
+			REQUIRE(res.generated >= FRAMES - 32);
+			for (long i = 0; i < res.generated * 2; i++)
+				REQUIRE(output[i] == Approx(input[i]).margin(1e-5));
+		}
+
+		DYNAMIC_SECTION("Test built-in quality " << static_cast<int>(q) << " accuracy")
+		{
+			const Resampler::Result res = r.process(input.data(), 0, FRAMES, output.data(), FRAMES * 2, 0.5f);
+
+			REQUIRE(res.generated > FRAMES);
+			for (long i = 64; i < res.generated; i++)
+			{
+				const float expected = static_cast<float>(std::sin(2.0 * 3.14159265358979 * 0.01 * i * 0.5) * 0.8);
+				REQUIRE(output[i * 2] == Approx(expected).margin(1e-3));
+				REQUIRE(output[i * 2 + 1] == Approx(expected * 0.5f).margin(1e-3));
+			}
+		}
+
+		DYNAMIC_SECTION("Test built-in quality " << static_cast<int>(q) << " block by block")
+		{
+			/* Small input and output blocks, and a copy of the resampler made 
+			half-way, must give the same result as a single call. */
+
+			std::vector<float>      expected(FRAMES * 2);
+			Resampler               single(q, G_MAX_IO_CHANS);
+			const Resampler::Result all = single.process(input.data(), 0, FRAMES, expected.data(), FRAMES, 0.7f);
+
+			Resampler  copy(q, G_MAX_IO_CHANS);
+			Resampler* current   = &r;
+			long       used      = 0;
+			long       generated = 0;
+			while (generated < all.generated)
+			{
+				if (current == &r && generated > FRAMES / 4)
+				{
+					copy    = r;
+					current = &copy;
+				}
+				const Resampler::Result res = current->process(input.data(), used,
+				    std::min<long>(used + 100, FRAMES), output.data() + generated * 2,
+				    std::min<long>(64, all.generated - generated), 0.7f);
+				used += res.used;
+				generated += res.generated;
+			}
+
+			REQUIRE(current == &copy);
+			for (long i = 0; i < all.generated * 2; i++)
+				REQUIRE(output[i] == expected[i]);
+		}
+
+		DYNAMIC_SECTION("Test built-in quality " << static_cast<int>(q) << " packed")
+		{
+			std::vector<uint16_t> packed(FRAMES * 2);
+			std::vector<float>    decoded(FRAMES * 2);
+			std::vector<float>    expected(FRAMES * 2);
+			dsp::encode(packed.data(), input.data(), FRAMES * 2, SampleFormat::HALF);
+			dsp::decode(decoded.data(), packed.data(), FRAMES * 2, SampleFormat::HALF);
+
+			Resampler               other(q, G_MAX_IO_CHANS);
+			const Resampler::Result a = r.process(packed.data(), SampleFormat::HALF, 0, FRAMES, output.data(), FRAMES, 1.3f);
+			const Resampler::Result b = other.process(decoded.data(), 0, FRAMES, expected.data(), FRAMES, 1.3f);
+
+			REQUIRE(a.used == b.used);
+			REQUIRE(a.generated == b.generated);
+			for (long i = 0; i < a.generated * 2; i++)
+				REQUIRE(output[i] == expected[i]);
+		}
+
+		DYNAMIC_SECTION("Test built-in quality " << static_cast<int>(q) << " last")
+		{
+			std::vector<float> expected(FRAMES * 2);
+
+			r.process(input.data(), 0, FRAMES, expected.data(), 1000, 1.5f);
+			r.last();
+			r.process(input.data(), 0, FRAMES, output.data(), 1000, 1.5f);
+			r.last();
+			r.process(input.data(), 0, FRAMES, output.data(), 1000, 1.5f);
+
+			for (long i = 0; i < 2000; i++)
+				REQUIRE(output[i] == expected[i]);
+		}
+	}
+
+	SECTION("Test anti-aliasing")
+	{
+		/* A tone close to Nyquist, pitched up one octave. It would fold back
+		into the audible range: it must be filtered out instead. */
+
+		std::vector<float>      high = makeSine_(FRAMES, 0.45);
+		Resampler               r(Resampler::Quality::POLYPHASE_BEST, G_MAX_IO_CHANS);
+		const Resampler::Result res = r.process(high.data(), 0, FRAMES, output.data(), FRAMES, 2.0f);
+
+		double energy = 0.0;
+		for (long i = 32; i < res.generated; i++)
+			energy += output[i * 2] * output[i * 2];
+
+		REQUIRE(std::sqrt(energy / (res.generated - 32)) < 1e-3);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("Resampling qualities", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* One block of pitched playback, libsamplerate against the built-in 
+	interpolators. The read position wraps around a 10-second stereo sample. */
+
+	dsp::init();
+
+	const std::vector<std::pair<Resampler::Quality, std::string>> qualities = {
+	    {Resampler::Quality::SINC_BEST, "libsamplerate: sinc best"},
+	    {Resampler::Quality::SINC_MEDIUM, "libsamplerate: sinc medium"},
+	    {Resampler::Quality::SINC_FASTEST, "libsamplerate: sinc fastest"},
+	    {Resampler::Quality::ZERO_ORDER_HOLD, "libsamplerate: zero order hold"},
+	    {Resampler::Quality::LINEAR, "libsamplerate: linear"},
+	    {Resampler::Quality::CUBIC, "built-in: cubic"},
+	    {Resampler::Quality::POLYPHASE_FAST, "built-in: polyphase fast"},
+	    {Resampler::Quality::POLYPHASE_BEST, "built-in: polyphase best"}};
+
+	constexpr int FRAMES = G_DEFAULT_SAMPLERATE * 10;
+
+	std::vector<float> input = makeSine_(FRAMES, 0.01);
+	std::vector<float> output(G_DEFAULT_BUFSIZE * 2);
+
+	for (float pitch : {0.7f, 1.5f})
+	{
+		for (const auto& [quality, name] : qualities)
+		{
+			Resampler r(quality, G_MAX_IO_CHANS);
+			long      pos = 0;
+
+			BENCHMARK(name + ", pitch " + std::to_string(pitch).substr(0, 3))
+			{
+				const Resampler::Result res = r.process(input.data(), pos, FRAMES, output.data(),
+				    G_DEFAULT_BUFSIZE, pitch);
+				pos += res.used;
+				if (res.generated < G_DEFAULT_BUFSIZE)
+				{
+					r.last();
+					pos = 0;
+				}
+				return output[0];
+			};
+		}
+	}
+}
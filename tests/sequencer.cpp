@@ -0,0 +1,122 @@
+#include "../src/core/sequencer.h"
+#include "../src/core/action.h"
+#include "../src/core/actionTimeline.h"
+#include "../src/core/const.h"
+#include "../src/core/recorder.h"
+#include "../src/core/types.h"
+#include <catch2/catch.hpp>
+#include <random>
+
+namespace
+{
+using namespace giada;
+using namespace giada::m;
+
+/* parsePerFrame_
+Reference implementation: walks every frame of the block, looking for bars,
+beats and actions. */
+
+void parsePerFrame_(sequencer::EventBuffer& out, Frame start, Frame bufferSize,
+    Frame framesInLoop, Frame framesInBar, const recorder::ActionMap& actions,
+    const ActionTimeline& timeline)
+{
+	for (Frame i = start, local = 0; i < start + bufferSize; i++, local++)
+	{
+		Frame global = i % framesInLoop;
+
+		if (global == 0)
+			out.push_back({sequencer::EventType::FIRST_BEAT, global, local});
+		else if (global % framesInBar == 0)
+			out.push_back({sequencer::EventType::BAR, global, local});
+
+		if (actions.count(global) > 0)
+			out.push_back({sequencer::EventType::ACTIONS, global, local, &timeline[timeline.find(global)]});
+	}
+}
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+
+TEST_CASE("sequencer")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	SECTION("Test parse vs. per-frame parsing")
+	{
+		std::mt19937 rng(1234);
+
+		auto rand = [&rng](int min, int max) {
+			return std::uniform_int_distribution<int>(min, max)(rng);
+		};
+
+		for (int run = 0; run < 500; run++)
+		{
+			const int   samplerate   = G_DEFAULT_SAMPLERATE;
+			const float bpm          = std::uniform_real_distribution<float>(G_MIN_BPM, G_MAX_BPM)(rng);
+			const int   beats        = rand(1, G_MAX_BEATS);
+			const int   bars         = rand(1, beats);
+			const Frame bufferSize   = rand(G_MIN_BUF_SIZE, G_MAX_BUF_SIZE);
+			const Frame framesInLoop = static_cast<int>((samplerate * (60.0f / bpm)) * beats);
+			const Frame framesInBar  = static_cast<int>(framesInLoop / (float)bars);
+			const Frame framesInBeat = static_cast<int>(framesInLoop / (float)beats);
+
+			/* Random actions, some of them on beats, bars and loop boundaries. */
+
+			recorder::ActionMap actions;
+			const int           numActions = rand(0, 32);
+			for (int i = 0; i < numActions; i++)
+			{
+				Frame f;
+				switch (rand(0, 3))
+				{
+				case 0:
+					f = 0;
+					break;
+				case 1:
+					f = framesInBar * rand(0, bars - 1);
+					break;
+				case 2:
+					f = framesInLoop - 1;
+					break;
+				default:
+					f = rand(0, framesInLoop - 1);
+					break;
+				}
+				actions[f].push_back(Action{i + 1, /*channelId=*/1, f, MidiEvent()});
+			}
+
+			ActionTimeline timeline;
+			timeline.build(actions);
+
+			/* Run several consecutive blocks, to exercise the cursor across 
+			blocks and loop wraps. */
+
+			Frame       start  = rand(0, framesInLoop - 1);
+			std::size_t cursor = 0;
+
+			for (int block = 0; block < 8; block++)
+			{
+				sequencer::EventBuffer expected;
+				sequencer::EventBuffer actual;
+
+				parsePerFrame_(expected, start, bufferSize, framesInLoop, framesInBar, actions, timeline);
+				sequencer::parse(actual, start, bufferSize, framesInLoop, framesInBar,
+				    framesInBeat, &timeline, cursor, /*metronome=*/nullptr);
+
+				REQUIRE(actual.size() == expected.size());
+				for (std::size_t i = 0; i < expected.size(); i++)
+				{
+					const sequencer::Event& e = *(expected.begin() + i);
+					const sequencer::Event& a = *(actual.begin() + i);
+					REQUIRE(a.type == e.type);
+					REQUIRE(a.global == e.global);
+					REQUIRE(a.delta == e.delta);
+					REQUIRE(a.entry == e.entry);
+				}
+
+				start = (start + bufferSize) % framesInLoop;
+			}
+		}
+	}
+}
@@ -0,0 +1,171 @@
+#include "../src/core/sync.h"
+#include "../src/core/clockPll.h"
+#include "../src/core/const.h"
+#include "../src/core/midiScheduler.h"
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST_CASE("sync")
+{
+	using namespace giada;
+	using namespace giada::m;
+	using namespace std::chrono;
+
+	SECTION("Test MIDI clock ticks")
+	{
+		std::mt19937 rng(1234);
+
+		auto rand = [&rng](int min, int max) {
+			return std::uniform_int_distribution<int>(min, max)(rng);
+		};
+
+		for (int run = 0; run < 100; run++)
+		{
+			const float bpm          = std::uniform_real_distribution<float>(G_MIN_BPM, G_MAX_BPM)(rng);
+			const int   beats        = rand(1, G_MAX_BEATS);
+			const Frame bufferSize   = rand(G_MIN_BUF_SIZE, G_MAX_BUF_SIZE);
+			const Frame framesInLoop = static_cast<int>((G_DEFAULT_SAMPLERATE * (60.0f / bpm)) * beats);
+			const Frame framesInBeat = static_cast<int>(framesInLoop / (float)beats);
+
+			/* Reference: the tick grid of the whole loop. */
+
+			std::set<Frame> grid;
+			for (int k = 0; k < beats * G_MIDI_CLOCK_PPQN; k++)
+				grid.insert(static_cast<Frame>(int64_t{k} * framesInBeat / G_MIDI_CLOCK_PPQN));
+
+			/* Walk two loops, block by block. Each tick must be on the grid and 
+			each loop must contain exactly PPQN ticks per beat. */
+
+			std::size_t ticks = 0;
+			for (Frame start = 0; start < framesInLoop * 2; start += bufferSize)
+				sync::forEachTick(start, bufferSize, framesInLoop, framesInBeat, [&](Frame f) {
+					REQUIRE(f >= 0);
+					REQUIRE(f < bufferSize);
+					REQUIRE(grid.count((start + f) % framesInLoop) == 1);
+					if (start + f < framesInLoop * 2)
+						ticks++;
+				});
+
+			REQUIRE(ticks == grid.size() * 2);
+		}
+	}
+
+	SECTION("Test PLL with jittery ticks")
+	{
+		std::mt19937                           rng(1234);
+		std::uniform_real_distribution<double> jitter(-0.001, 0.001); // +/- 1 ms
+
+		ClockPll  pll;
+		Timestamp t = steady_clock::now();
+
+		auto feed = [&](float bpm, int ticks) {
+			const double period = 60.0 / (bpm * G_MIDI_CLOCK_PPQN);
+			double       time   = 0.0;
+			for (int i = 0; i < ticks; i++, time += period)
+				pll.tick(t + duration_cast<steady_clock::duration>(duration<double>(time + jitter(rng))));
+			t += duration_cast<steady_clock::duration>(duration<double>(time));
+		};
+
+		feed(120.0f, G_MIDI_CLOCK_PPQN);
+		REQUIRE(pll.isLocked() == false);
+
+		feed(120.0f, G_MIDI_CLOCK_PPQN * 16);
+		REQUIRE(pll.isLocked() == true);
+		REQUIRE(pll.getBpm() == Approx(120.0f).margin(0.05f));
+
+		/* Follows a tempo change within a few beats. */
+
+		feed(132.5f, G_MIDI_CLOCK_PPQN * 16);
+		REQUIRE(pll.getBpm() == Approx(132.5f).margin(0.05f));
+
+		/* A long pause restarts the lock. */
+
+		t += seconds(2);
+		feed(90.0f, G_MIDI_CLOCK_PPQN);
+		REQUIRE(pll.isLocked() == false);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* MIDI clock loopback
+Runs a fake audio thread that generates clock ticks at 120 BPM through the 
+midiScheduler, then sends them back to a ClockPll, as an external slave would
+do. Prints the timing error of the ticks against their ideal time and the tempo
+recovered on the other side. Run it with the "[jitter]" tag. */
+
+TEST_CASE("MIDI clock loopback", "[.][jitter]")
+{
+	using namespace giada;
+	using namespace giada::m;
+	using namespace std::chrono;
+
+	constexpr float BPM         = 120.0f;
+	constexpr int   SAMPLE_RATE = 44100;
+	constexpr Frame BUFFER_SIZE = 256;
+	constexpr int   BLOCKS      = SAMPLE_RATE * 4 / BUFFER_SIZE; // About 4 seconds
+
+	const Frame framesInBeat = static_cast<Frame>(SAMPLE_RATE * (60.0f / BPM));
+	const Frame framesInLoop = framesInBeat * 4;
+
+	std::mutex             mutex;
+	std::vector<Timestamp> received;
+	ClockPll               pll;
+
+	midiScheduler::init([&](uint32_t) {
+		const Timestamp now = steady_clock::now();
+		std::scoped_lock lock(mutex);
+		received.push_back(now);
+		pll.tick(now);
+	});
+
+	auto toDuration = [](double seconds) {
+		return duration_cast<steady_clock::duration>(duration<double>(seconds));
+	};
+
+	const Timestamp        start = steady_clock::now();
+	std::vector<Timestamp> expected;
+
+	for (int block = 0; block < BLOCKS; block++)
+	{
+		const Frame     frame     = block * BUFFER_SIZE;
+		const Timestamp blockTime = start + toDuration(frame / double(SAMPLE_RATE));
+
+		std::this_thread::sleep_until(blockTime);
+
+		midiScheduler::startBlock(blockTime, BUFFER_SIZE, SAMPLE_RATE);
+		sync::forEachTick(frame, BUFFER_SIZE, framesInLoop, framesInBeat, [&](Frame f) {
+			midiScheduler::schedule(0xF8000000, f);
+			expected.push_back(blockTime + toDuration((BUFFER_SIZE + f) / double(SAMPLE_RATE)));
+		});
+	}
+
+	std::this_thread::sleep_for(milliseconds(100));
+	midiScheduler::close();
+
+	std::scoped_lock lock(mutex);
+	REQUIRE(received.size() == expected.size());
+
+	double sum = 0.0, sumSq = 0.0, max = 0.0;
+	for (std::size_t i = 0; i < received.size(); i++)
+	{
+		const double error = duration<double, std::micro>(received[i] - expected[i]).count();
+		sum += error;
+		sumSq += error * error;
+		max = std::max(max, std::abs(error));
+	}
+	const double mean   = sum / received.size();
+	const double stddev = std::sqrt(sumSq / received.size() - mean * mean);
+
+	WARN("ticks: " << received.size() << ", error mean: " << mean << " us, std dev: "
+	               << stddev << " us, max: " << max << " us, recovered tempo: "
+	               << pll.getBpm() << " BPM");
+
+	REQUIRE(pll.getBpm() == Approx(BPM).margin(0.1f));
+}
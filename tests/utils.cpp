@@ -1,4 +1,5 @@
 #include "../src/utils/fs.h"
+#include "../src/utils/log.h"
 #include "../src/utils/math.h"
 #include "../src/utils/string.h"
 #include <catch2/catch.hpp>
@@ -62,3 +63,40 @@ TEST_CASE("::math")
 	REQUIRE(math::map(30.0f, 30.0f, 1.0f) == 1.0f);
 	REQUIRE(math::map(15.0f, 30.0f, 1.0f) == Approx(0.5f));
 }
+
+TEST_CASE("u::log")
+{
+	using namespace giada::u;
+
+	SECTION("Test deferred formatting")
+	{
+		log::Record r;
+		r.format    = "ch=%d, value=%f, raw=0x%X, str=%s";
+		r.formatter = &log::formatRecord<int, float, uint32_t, const char*>;
+		r.args      = {log::toArg(-3), log::toArg(0.5f), log::toArg(0xB0102Fu), log::toArg("ok")};
+
+		char line[G_LOG_LINE_SIZE];
+		r.formatter(line, sizeof(line), r);
+
+		REQUIRE(std::string(line) == "ch=-3, value=0.500000, raw=0xB0102F, str=ok");
+	}
+
+	SECTION("Test level filtering")
+	{
+		const int        mode  = log::mode;
+		const log::Level level = log::levels[static_cast<int>(log::Subsystem::MIDI)].load();
+
+		log::mode = LOG_MODE_STDOUT;
+		log::setLevel(log::Subsystem::MIDI, log::Level::WARNING);
+
+		REQUIRE(log::isEnabled(log::Subsystem::MIDI, log::Level::INFO) == false);
+		REQUIRE(log::isEnabled(log::Subsystem::MIDI, log::Level::WARNING) == true);
+
+		log::mode = LOG_MODE_MUTE;
+
+		REQUIRE(log::isEnabled(log::Subsystem::MIDI, log::Level::WARNING) == false);
+
+		log::mode = mode;
+		log::setLevel(log::Subsystem::MIDI, level);
+	}
+}
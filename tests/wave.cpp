@@ -1,6 +1,10 @@
+#include "../src/core/mappedFile.h"
 #include "../src/core/wave.h"
+#include "../src/core/wavePeaks.h"
 #include <catch2/catch.hpp>
 #include <memory>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Wave")
 {
@@ -43,5 +47,104 @@ TEST_CASE("Wave")
 			REQUIRE(wave.getBasename() == "sample");
 			REQUIRE(wave.getBasename(true) == "sample.wav");
 		}
+
+		SECTION("test shared data")
+		{
+			m::Wave copy(wave);
+			m::Wave slice(2);
+			slice.view(wave, 10, 20);
+
+			REQUIRE(wave.isShared());
+			REQUIRE(copy.getBuffer()[0] == wave.getBuffer()[0]);
+			REQUIRE(slice.getBuffer()[0] == wave.getBuffer()[10]);
+			REQUIRE(slice.getBuffer().countFrames() == 10);
+
+			/* Copy on write: edits don't show up in the other Waves. */
+
+			slice.detach();
+			slice.getBuffer()[0][0] = 1.0f;
+
+			REQUIRE(!slice.isShared());
+			REQUIRE(wave.getBuffer()[10][0] == 0.0f);
+			REQUIRE(copy.getBuffer()[10][0] == 0.0f);
+		}
+
+		SECTION("test packing")
+		{
+			/* Data as read from a 16-bit file. */
+
+			for (int i = 0; i < BUFFER_SIZE; i++)
+				for (int j = 0; j < CHANNELS; j++)
+					wave.getBuffer()[i][j] = ((i * 37 + j) % 65536 - 32768) / 32768.0f;
+
+			const m::Wave original(wave);
+
+			REQUIRE(wave.pack(SampleFormat::INT16));
+			REQUIRE(wave.isPacked());
+			REQUIRE(wave.countFrames() == BUFFER_SIZE);
+
+			std::vector<float> out(BUFFER_SIZE * CHANNELS);
+			wave.read(0, out.data(), BUFFER_SIZE);
+			for (int i = 0; i < BUFFER_SIZE; i++)
+				for (int j = 0; j < CHANNELS; j++)
+					REQUIRE(out[i * CHANNELS + j] == original.getBuffer()[i][j]);
+
+			wave.detach();
+
+			REQUIRE(!wave.isPacked());
+			REQUIRE(wave.getBuffer()[100][1] == original.getBuffer()[100][1]);
+
+			/* Anything else is lossy: fits half floats only. */
+
+			wave.getBuffer()[0][0] = 0.1f;
+
+			REQUIRE(!wave.pack(SampleFormat::INT16));
+			REQUIRE(wave.pack(SampleFormat::HALF));
+
+			wave.read(0, out.data(), 1);
+
+			REQUIRE(out[0] == Approx(0.1f).epsilon(1.0 / 2048));
+		}
+	}
+
+	SECTION("test mapped data")
+	{
+		/* Any file will do: its bytes are taken as float frames. The mapping is 
+		read-only, so detach() must copy data even if not shared. */
+
+		std::shared_ptr<m::MappedFile> file = m::MappedFile::open(TEST_RESOURCES_DIR "test.wav");
+
+		REQUIRE(file != nullptr);
+
+		m::Wave wave(1);
+		wave.map(std::move(file), 0, BUFFER_SIZE, SAMPLE_RATE, BIT_DEPTH, "path/to/sample.wav");
+
+		REQUIRE(!wave.isShared());
+
+		wave.detach();
+		wave.getBuffer()[0][0] = 1.0f;
+
+		REQUIRE(wave.getBuffer()[0][0] == 1.0f);
+	}
+
+	SECTION("test peaks")
+	{
+		/* More Waves than background jobs allowed: the excess ones get peaks 
+		computed on the spot. All of them get peaks anyway. */
+
+		std::vector<std::unique_ptr<m::Wave>> waves;
+		for (unsigned i = 0; i < std::thread::hardware_concurrency() * 2 + 1; i++)
+		{
+			waves.push_back(std::make_unique<m::Wave>(i + 1));
+			waves.back()->alloc(BUFFER_SIZE, CHANNELS, SAMPLE_RATE, BIT_DEPTH, "path/to/sample.wav");
+			waves.back()->computePeaks();
+		}
+
+		for (const std::unique_ptr<m::Wave>& w : waves)
+		{
+			while (w->getPeaks() == nullptr)
+				std::this_thread::yield();
+			REQUIRE(w->getPeaks()->countFrames() == BUFFER_SIZE);
+		}
 	}
 }
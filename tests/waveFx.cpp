@@ -2,8 +2,12 @@
 #include "../src/core/const.h"
 #include "../src/core/types.h"
 #include "../src/core/wave.h"
+#include "../src/core/wavePeaks.h"
+#include <atomic>
 #include <catch2/catch.hpp>
+#include <cmath>
 #include <memory>
+#include <thread>
 
 using namespace giada;
 using namespace giada::m;
@@ -99,4 +103,46 @@ TEST_CASE("waveFx")
 		REQUIRE(waveStereo.getBuffer()[b][0] == 0.0f);
 		REQUIRE(waveStereo.getBuffer()[b][1] == 0.0f);
 	}
+
+	SECTION("test peaks update")
+	{
+		mcl::AudioBuffer& buffer = waveStereo.getBuffer();
+		for (int i = 0; i < buffer.countFrames(); i++)
+		{
+			buffer[i][0] = std::sin(i * 0.01f) * (i % 7) / 7.0f;
+			buffer[i][1] = std::cos(i * 0.03f) * 0.5f;
+		}
+
+		waveStereo.computePeaks();
+		while (waveStereo.getPeaks() == nullptr)
+			std::this_thread::yield();
+
+		/* Peaks updated after each edit must match those computed from 
+		scratch. */
+
+		wfx::cut(waveStereo, 100, 1337);
+		wfx::reverse(waveStereo, 300, 900);
+		wfx::silence(waveStereo, 1500, 1600);
+
+		std::atomic<bool> cancel = false;
+		WavePeaks         fresh;
+		REQUIRE(fresh.build(buffer, cancel));
+
+		const WavePeaks& updated = *waveStereo.getPeaks();
+		REQUIRE(updated.countFrames() == buffer.countFrames());
+		REQUIRE(updated.countLevels() == fresh.countLevels());
+
+		const Frame ranges[][2] = {{0, 10}, {5, 200}, {64, 128}, {100, 2000}, {1500, 1600}, {0, buffer.countFrames()}};
+		for (const auto& [a, z] : ranges)
+		{
+			REQUIRE(updated.get(buffer, a, z).min == fresh.get(buffer, a, z).min);
+			REQUIRE(updated.get(buffer, a, z).max == fresh.get(buffer, a, z).max);
+		}
+
+		/* The whole range is made of whole buckets: no approximation. */
+
+		const Frame frames = buffer.countFrames();
+		REQUIRE(updated.get(buffer, 0, frames).min == WavePeaks::scan(buffer, 0, frames).min);
+		REQUIRE(updated.get(buffer, 0, frames).max == WavePeaks::scan(buffer, 0, frames).max);
+	}
 }
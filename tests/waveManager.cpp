@@ -1,11 +1,19 @@
 #include "../src/core/waveManager.h"
 #include "../src/core/const.h"
 #include "../src/core/wave.h"
+#include "../src/core/waveCache.h"
+#include "../src/core/waveStream.h"
+#include <algorithm>
 #include <catch2/catch.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <samplerate.h>
+#include <vector>
 
 using std::string;
+using namespace giada;
 using namespace giada::m;
 
 #define G_SAMPLE_RATE 44100
@@ -55,4 +63,265 @@ TEST_CASE("waveManager")
 		REQUIRE(res.wave->isLogical() == false);
 		REQUIRE(res.wave->isEdited() == false);
 	}
+
+	SECTION("test streaming")
+	{
+		waveManager::Result res = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+		    /*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		std::unique_ptr<WaveStream> stream = WaveStream::open(TEST_RESOURCES_DIR "test.wav",
+		    /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR, /*headFrames=*/1024);
+
+		REQUIRE(stream != nullptr);
+		REQUIRE(stream->countFrames() == res.wave->getBuffer().countFrames());
+
+		const mcl::AudioBuffer& expected = res.wave->getBuffer();
+		const Frame             length   = stream->countFrames();
+		std::vector<float>      out(G_BUFFER_SIZE * G_CHANNELS);
+
+		auto matches = [&](Frame start, Frame count) {
+			return std::equal(out.begin(), out.begin() + count * G_CHANNELS, expected[start]);
+		};
+
+		SECTION("test playback")
+		{
+			/* Twice, to make sure the stream rewinds itself while playing the
+			head. fill() is called where the streamer thread would do it. Blocks 
+			must be shorter than the head, which hides the rewind latency. */
+
+			constexpr Frame blockSize = 512;
+
+			for (int i = 0; i < 2; i++)
+			{
+				bool ok = true;
+				for (Frame f = 0; f < length; f += blockSize)
+				{
+					const Frame count = std::min(blockSize, length - f);
+					stream->fill();
+					stream->read(f, out.data(), count);
+					stream->consume(f, count);
+					ok &= matches(f, count);
+				}
+				REQUIRE(ok);
+			}
+		}
+
+		SECTION("test seek")
+		{
+			const Frame start = length / 2;
+
+			stream->read(start, out.data(), G_BUFFER_SIZE);
+
+			REQUIRE(std::all_of(out.begin(), out.end(), [](float v) { return v == 0.0f; }));
+
+			stream->fill();
+			stream->read(start, out.data(), G_BUFFER_SIZE);
+
+			REQUIRE(matches(start, G_BUFFER_SIZE));
+		}
+	}
+
+	SECTION("test cache")
+	{
+		const std::filesystem::path dir = std::filesystem::temp_directory_path() / "giada-test-cache";
+		std::filesystem::remove_all(dir);
+
+		waveCache::init(dir.string(), /*maxSize=*/16);
+
+		waveManager::Result res1 = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+		    /*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		REQUIRE(std::distance(std::filesystem::directory_iterator(dir), {}) == 1);
+
+		waveManager::Result res2 = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+		    /*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		const mcl::AudioBuffer& b1 = res1.wave->getBuffer();
+		const mcl::AudioBuffer& b2 = res2.wave->getBuffer();
+
+		REQUIRE(res2.status == G_RES_OK);
+		REQUIRE(res2.wave->getRate() == G_SAMPLE_RATE);
+		REQUIRE(b2.countFrames() == b1.countFrames());
+		REQUIRE(b2.countChannels() == G_CHANNELS);
+		REQUIRE(std::equal(b1[0], b1[0] + b1.countSamples(), b2[0]));
+
+		/* Copies share the mapped file, but edits must not write through it. */
+
+		Wave copy(*res2.wave);
+
+		REQUIRE(copy.isShared());
+
+		copy.detach();
+		copy.getBuffer()[0][0] = 1.0f;
+
+		REQUIRE(b2[0][0] == b1[0][0]);
+
+		waveCache::init("", /*maxSize=*/0);
+		std::filesystem::remove_all(dir);
+	}
+
+	SECTION("test cache index")
+	{
+		const std::filesystem::path dir  = std::filesystem::temp_directory_path() / "giada-test-cache";
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "giada-test-index.wav";
+		std::filesystem::remove_all(dir);
+		std::filesystem::copy_file(TEST_RESOURCES_DIR "test.wav", path,
+		    std::filesystem::copy_options::overwrite_existing);
+
+		waveCache::init(dir.string(), /*maxSize=*/16);
+
+		const std::string key = waveCache::makeKey(path.string(), G_SAMPLE_RATE, SRC_LINEAR);
+
+		REQUIRE(!key.empty());
+		REQUIRE(waveCache::makeKey(path.string(), G_SAMPLE_RATE, SRC_LINEAR) == key);
+
+		/* The index survives across sessions, and the cache size limit. */
+
+		waveCache::init(dir.string(), /*maxSize=*/0);
+
+		REQUIRE(waveCache::makeKey(path.string(), G_SAMPLE_RATE, SRC_LINEAR) == key);
+
+		/* Files are not read again while size and modification time match. */
+
+		const std::filesystem::file_time_type time = std::filesystem::last_write_time(path);
+		std::fstream(path, std::ios::in | std::ios::out | std::ios::binary).write("edit", 4);
+		std::filesystem::last_write_time(path, time);
+
+		REQUIRE(waveCache::makeKey(path.string(), G_SAMPLE_RATE, SRC_LINEAR) == key);
+
+		/* Changed files are hashed again. */
+
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+
+		REQUIRE(waveCache::makeKey(path.string(), G_SAMPLE_RATE, SRC_LINEAR) != key);
+
+		/* Leave the cache disabled for the other tests. */
+
+		waveCache::init("", /*maxSize=*/0);
+
+		REQUIRE(waveCache::makeKey(path.string(), G_SAMPLE_RATE, SRC_LINEAR).empty());
+
+		std::filesystem::remove_all(dir);
+		std::filesystem::remove(path);
+	}
+
+	SECTION("test FLAC save")
+	{
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "giada-test.flac";
+
+		waveManager::Result res1 = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+		    /*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		REQUIRE(res1.wave->getBits() == 16);
+		REQUIRE(waveManager::isFlacCompatible(*res1.wave));
+		REQUIRE(waveManager::save(*res1.wave, path.string()) == G_RES_OK);
+
+		waveManager::Result res2 = waveManager::createFromFile(path.string(),
+		    /*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		const mcl::AudioBuffer& b1 = res1.wave->getBuffer();
+		const mcl::AudioBuffer& b2 = res2.wave->getBuffer();
+
+		REQUIRE(res2.status == G_RES_OK);
+		REQUIRE(res2.wave->getBits() == 16);
+		REQUIRE(b2.countFrames() == b1.countFrames());
+		REQUIRE(std::equal(b1[0], b1[0] + b1.countSamples(), b2[0]));
+
+		std::filesystem::remove(path);
+	}
+
+	SECTION("test packed save")
+	{
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "giada-test-packed.wav";
+
+		waveManager::Result res1 = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+		    /*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		/* HALF packing is lossy: the saved file must come from the source file,
+		not from the decoded data. */
+
+		Wave packed(*res1.wave);
+
+		REQUIRE(packed.pack(SampleFormat::HALF));
+		REQUIRE(packed.getSource() == TEST_RESOURCES_DIR "test.wav");
+		REQUIRE(waveManager::save(packed, path.string()) == G_RES_OK);
+
+		waveManager::Result res2 = waveManager::createFromFile(path.string(),
+		    /*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		const mcl::AudioBuffer& b1 = res1.wave->getBuffer();
+		const mcl::AudioBuffer& b2 = res2.wave->getBuffer();
+
+		REQUIRE(res2.status == G_RES_OK);
+		REQUIRE(b2.countFrames() == b1.countFrames());
+		REQUIRE(b2.countChannels() == b1.countChannels());
+		REQUIRE(std::memcmp(b1[0], b2[0], b1.countSamples() * sizeof(float)) == 0);
+
+		/* Edits go through an unpacked copy, which has no source anymore. */
+
+		packed.detach();
+
+		REQUIRE(packed.getSource().empty());
+
+		std::filesystem::remove(path);
+	}
+
+	SECTION("test incremental save")
+	{
+		const std::filesystem::path dir  = std::filesystem::temp_directory_path() / "giada-test-save";
+		const std::filesystem::path path = dir / "test.wav";
+		std::filesystem::remove_all(dir);
+		std::filesystem::create_directories(dir);
+
+		std::unique_ptr<Wave> wave = waveManager::createEmpty(G_BUFFER_SIZE,
+		    G_MAX_IO_CHANS, G_SAMPLE_RATE, path.string());
+
+		REQUIRE(wave->isDirty());
+		REQUIRE(waveManager::saveDirty({wave.get()}));
+		REQUIRE(!wave->isDirty());
+		REQUIRE(wave->getSavedHash() == waveManager::hash(*wave));
+
+		/* Empty the file behind the Wave's back: it gets rewritten only if the
+		Wave content has really changed. */
+
+		auto written = [&]() {
+			std::filesystem::resize_file(path, 0);
+			waveManager::saveDirty({wave.get()});
+			return std::filesystem::file_size(path) > 0;
+		};
+
+		REQUIRE(!written());
+
+		wave->setEdited(true);
+
+		REQUIRE(wave->isDirty());
+		REQUIRE(!written());
+
+		wave->getBuffer()[0][0] = 1.0f;
+		wave->setEdited(true);
+
+		REQUIRE(written());
+		REQUIRE(wave->getSavedHash() == waveManager::hash(*wave));
+
+		/* Saving in background: a Wave changed in the meantime is not in sync 
+		with what has been written. */
+
+		wave->getBuffer()[0][0] = 0.5f;
+		wave->setEdited(true);
+
+		std::unique_ptr<waveManager::SaveBatch> batch = waveManager::prepareSave({wave.get()});
+
+		REQUIRE(batch != nullptr);
+		REQUIRE(waveManager::isSaving());
+		REQUIRE(waveManager::prepareSave({wave.get()}) == nullptr);
+		REQUIRE(waveManager::runSave(*batch));
+
+		wave->setPath((dir / "moved.wav").string());
+		waveManager::finishSave(*batch, {wave.get()});
+
+		REQUIRE(!waveManager::isSaving());
+		REQUIRE(wave->isDirty());
+
+		std::filesystem::remove_all(dir);
+	}
 }
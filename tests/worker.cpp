@@ -0,0 +1,43 @@
+#include "../src/core/worker.h"
+#include "../src/core/notifier.h"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <thread>
+
+TEST_CASE("Worker")
+{
+	using namespace giada;
+	using namespace std::chrono;
+
+	SECTION("Test Notifier")
+	{
+		Notifier n;
+
+		/* Pending notifications are not lost, and they are coalesced. */
+
+		n.notify();
+		n.notify();
+		REQUIRE(n.wait(/*timeout=*/1000) == true);
+		REQUIRE(n.wait(/*timeout=*/10) == false);
+	}
+
+	SECTION("Test wake on notify")
+	{
+		std::atomic<int> calls = 0;
+		Worker           worker;
+
+		worker.startOnNotify([&calls]() { calls++; }, /*timeout=*/10000);
+
+		const auto start = steady_clock::now();
+		worker.notify();
+		while (calls.load() == 0)
+			std::this_thread::yield();
+
+		/* Way below the timeout. */
+
+		REQUIRE(steady_clock::now() - start < milliseconds(1000));
+
+		worker.stop();
+	}
+}